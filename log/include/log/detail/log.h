@@ -7,36 +7,50 @@
 
 #include <stddef.h>
 #include <stdint.h>
-#include <stdlib.h>
-#include <string.h>
 
 log_level_t log_get_log_level();
 log_msg_function log_get_log_msg_function();
 log_convert_to_priority_function log_get_log_convert_to_priority_function();
 
-void snprintf_xxd_buf(char* output, size_t size, const uint8_t* begin, const uint8_t* end);
+// The message is followed by the hex dump of the data, a long dump is split
+// into several messages each starting with the formatted message
+void log_xxd_message(log_level_t logLevel, const uint8_t* data, size_t size, const char* format, ...)
+    __attribute__((format(printf, 4, 5)));
+
+void log_defer_xxd(log_level_t logLevel, const char* file, int line, const char* function, const char* prefix,
+                   const uint8_t* data, size_t size);
+
+// Global level combined with every thread level ever set, it is checked inline
+// before the exact level, so a disabled message costs a relaxed load and a branch
+extern log_level_t gLogLevelsInUse;
+
+#define LOG_LEVEL_IS_ENABLED(logLevel)                                                               \
+    ((logLevel) <= LOG_MAX_LEVEL                                                                     \
+     && __builtin_expect(((logLevel) & __atomic_load_n(&gLogLevelsInUse, __ATOMIC_RELAXED)) != 0, 0) \
+     && ((logLevel) & log_get_log_level()))
 
 #define DO_LOG_MESSAGE_NOCHECK_IMPL(logLevel, format, ...) \
     log_get_log_msg_function()(log_get_log_convert_to_priority_function()(logLevel), format, __VA_ARGS__)
 
 #define DO_LOG_MESSAGE_IMPL(logLevel, format, ...)                  \
     do {                                                            \
-        if (!(logLevel & log_get_log_level())) break;               \
+        if (!LOG_LEVEL_IS_ENABLED(logLevel)) break;                 \
+        log_flush_deferred();                                       \
         DO_LOG_MESSAGE_NOCHECK_IMPL(logLevel, format, __VA_ARGS__); \
     } while (0)
 
-#define DO_LOG_XXD_MESSAGE_IMPL(logLevel, data, size, format, ...)                                 \
-    do {                                                                                           \
-        if (!(logLevel & log_get_log_level())) break;                                              \
-                                                                                                   \
-        size_t format_len = strlen(format);                                                        \
-        size_t new_format_len = format_len + size * 3 + 1;                                         \
-                                                                                                   \
-        char* new_format = (char*)malloc(new_format_len);                                          \
-        memset(new_format, 0, new_format_len);                                                     \
-        memcpy(new_format, format, format_len);                                                    \
-                                                                                                   \
-        snprintf_xxd_buf(new_format + format_len, new_format_len - format_len, data, data + size); \
-        DO_LOG_MESSAGE_NOCHECK_IMPL(logLevel, new_format, __VA_ARGS__);                            \
-        free(new_format);                                                                          \
+#define DO_LOG_XXD_MESSAGE_IMPL(logLevel, data, size, format, ...)                  \
+    do {                                                                            \
+        if (!LOG_LEVEL_IS_ENABLED(logLevel)) break;                                 \
+        log_flush_deferred();                                                       \
+        DO_LOG_XXD_MESSAGE_NOCHECK_IMPL(logLevel, data, size, format, __VA_ARGS__); \
     } while (0)
+
+#define DO_LOG_XXD_DEFERRED_IMPL(logLevel, data, size, file, line, function, prefix) \
+    do {                                                                             \
+        if (!LOG_LEVEL_IS_ENABLED(logLevel)) break;                                  \
+        log_defer_xxd(logLevel, file, line, function, prefix, data, size);           \
+    } while (0)
+
+#define DO_LOG_XXD_MESSAGE_NOCHECK_IMPL(logLevel, data, size, format, ...) \
+    log_xxd_message(logLevel, data, size, format, __VA_ARGS__)
@@ -19,6 +19,12 @@ typedef enum {
     LOG_LEVEL_PERIODIC = 0x01 << 3
 } log_level_t;
 
+// Messages of the levels above it are removed at compile time,
+// see RTUARTSCREADER_LOG_MAX_LEVEL build option
+#ifndef LOG_MAX_LEVEL
+#define LOG_MAX_LEVEL LOG_LEVEL_PERIODIC
+#endif
+
 #define LOG_CRITICAL(format, ...) \
     DO_LOG_MESSAGE(LOG_LEVEL_CRITICAL, format, __VA_ARGS__)
 
@@ -31,6 +37,11 @@ typedef enum {
 #define LOG_XXD_INFO(data, data_size, format, ...) \
     DO_LOG_XXD_MESSAGE(LOG_LEVEL_INFO, data, data_size, format, __VA_ARGS__)
 
+// Only the bytes and the pointers to the literals are stored, the message is
+// formatted by log_flush_deferred, so that the timing of the exchange is kept
+#define LOG_XXD_INFO_DEFERRED(data, data_size, prefix) \
+    DO_LOG_XXD_DEFERRED(LOG_LEVEL_INFO, data, data_size, prefix)
+
 // This is gcc magic, probably won't work with other compilers
 #define VA_ARGS(...) , ##__VA_ARGS__
 
@@ -40,6 +51,9 @@ typedef enum {
 #define DO_LOG_XXD_MESSAGE(logLevel, data, data_size, format, ...) \
     DO_LOG_XXD_MESSAGE_IMPL(logLevel, data, data_size, "%s:%d:%s() " format, __FILE__, __LINE__, __FUNCTION__ VA_ARGS(__VA_ARGS__))
 
+#define DO_LOG_XXD_DEFERRED(logLevel, data, data_size, prefix) \
+    DO_LOG_XXD_DEFERRED_IMPL(logLevel, data, data_size, __FILE__, __LINE__, __FUNCTION__, prefix)
+
 typedef void (*log_msg_function)(const int priority, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
 
 typedef int (*log_convert_to_priority_function)(log_level_t);
@@ -50,6 +64,14 @@ log_level_t log_get_log_level();
 
 void log_set_log_level(log_level_t logLevel);
 
+// Log level of the calling thread only, it takes precedence over the global one
+void log_set_thread_log_level(log_level_t logLevel);
+void log_reset_thread_log_level();
+
+// Emits the deferred messages of the calling thread. Any other message of the
+// thread emits them first, so the order of the messages is kept.
+void log_flush_deferred();
+
 #include "detail/log.h"
 
 #ifdef __cplusplus
@@ -5,20 +5,50 @@
 
 #include <log/log.h>
 
-#include <assert.h>
-#include <limits.h>
+#include <pthread.h>
+#include <stdarg.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 
 static void dummy_log_msg(const int priority, const char* fmt, ...);
 static int dummy_log_convert_to_priority(log_level_t logLevel);
 
+// Hex dumps are formatted on stack, chunk by chunk
+#define XXD_HEADER_SIZE 256
+#define XXD_CHUNK_SIZE 256
+
+// Deferred messages of a thread are stored as a record followed by the bytes
+#define DEFERRED_BUFFER_SIZE 2048
+
+typedef struct {
+    log_level_t level;
+    const char* file;
+    int line;
+    const char* function;
+    const char* prefix;
+    size_t size;
+} deferred_record_t;
+
+// Read without locks by the logging macros of any thread
+log_level_t gLogLevelsInUse = LOG_LEVEL_NONE;
+
+// The levels are changed rarely, under the mutex, so gLogLevelsInUse is never
+// combined from the stale values
+static pthread_mutex_t gLogLevelsMutex = PTHREAD_MUTEX_INITIALIZER;
 static log_level_t gLogLevel = LOG_LEVEL_NONE;
+static log_level_t gThreadLogLevels = LOG_LEVEL_NONE; // every one ever set
 static log_msg_function gLogMsgFunction = dummy_log_msg;
 static log_convert_to_priority_function gLogConvertToPriorityFunction = dummy_log_convert_to_priority;
 
+static __thread bool gThreadLogLevelIsSet = false;
+static __thread log_level_t gThreadLogLevel = LOG_LEVEL_NONE;
+
+static __thread uint8_t gDeferred[DEFERRED_BUFFER_SIZE];
+static __thread size_t gDeferredSize = 0;
+
 static void dummy_log_msg(const int priority, const char* fmt, ...) {
     (void)priority;
     (void)fmt;
@@ -31,17 +61,47 @@ static int dummy_log_convert_to_priority(log_level_t logLevel) {
 
 void log_init(log_level_t logLevel, log_msg_function msgFunction,
               log_convert_to_priority_function convertToPriorityFunction) {
-    gLogLevel = logLevel;
+    log_set_log_level(logLevel);
     gLogMsgFunction = msgFunction;
     gLogConvertToPriorityFunction = convertToPriorityFunction;
 }
 
 log_level_t log_get_log_level() {
-    return gLogLevel;
+    return gThreadLogLevelIsSet ? gThreadLogLevel : __atomic_load_n(&gLogLevel, __ATOMIC_RELAXED);
+}
+
+static void update_log_levels_in_use(void) {
+    __atomic_store_n(&gLogLevelsInUse, gLogLevel | gThreadLogLevels, __ATOMIC_RELAXED);
 }
 
 void log_set_log_level(log_level_t logLevel) {
-    gLogLevel = logLevel;
+    pthread_mutex_lock(&gLogLevelsMutex);
+
+    __atomic_store_n(&gLogLevel, logLevel, __ATOMIC_RELAXED);
+    update_log_levels_in_use();
+
+    pthread_mutex_unlock(&gLogLevelsMutex);
+}
+
+void log_set_thread_log_level(log_level_t logLevel) {
+    gThreadLogLevel = logLevel;
+    gThreadLogLevelIsSet = true;
+
+    log_level_t threadLogLevels = __atomic_load_n(&gThreadLogLevels, __ATOMIC_RELAXED);
+    if ((threadLogLevels | logLevel) == threadLogLevels) {
+        return;
+    }
+
+    pthread_mutex_lock(&gLogLevelsMutex);
+
+    __atomic_store_n(&gThreadLogLevels, gThreadLogLevels | logLevel, __ATOMIC_RELAXED);
+    update_log_levels_in_use();
+
+    pthread_mutex_unlock(&gLogLevelsMutex);
+}
+
+void log_reset_thread_log_level() {
+    gThreadLogLevelIsSet = false;
 }
 
 log_msg_function log_get_log_msg_function() {
@@ -52,16 +112,78 @@ log_convert_to_priority_function log_get_log_convert_to_priority_function() {
     return gLogConvertToPriorityFunction;
 }
 
-void snprintf_xxd_buf(char* output, size_t size, const uint8_t* begin, const uint8_t* end) {
-    memset(output, 0, size);
+static char* encode_xxd(char* output, const uint8_t* data, size_t size) {
+    static const char kHexDigits[] = "0123456789ABCDEF";
+
+    for (size_t i = 0; i != size; ++i) {
+        *output++ = kHexDigits[data[i] >> 4];
+        *output++ = kHexDigits[data[i] & 0x0f];
+        *output++ = ' ';
+    }
+
+    return output;
+}
+
+void log_xxd_message(log_level_t logLevel, const uint8_t* data, size_t size, const char* format, ...) {
+    char message[XXD_HEADER_SIZE + XXD_CHUNK_SIZE * 3 + 1];
 
-    assert(size < INT_MAX);
-    int ssize = (int)size;
+    va_list args;
+    va_start(args, format);
+    int header_len = vsnprintf(message, XXD_HEADER_SIZE, format, args);
+    va_end(args);
 
-    for (const uint8_t* it = begin; it != end; ++it) {
-        size_t n = snprintf(output, ssize, "%02X ", *it);
-        output += n;
-        ssize -= n;
-        if (ssize <= 0) return;
+    if (header_len < 0) {
+        header_len = 0;
+    } else if (header_len >= XXD_HEADER_SIZE) {
+        header_len = XXD_HEADER_SIZE - 1;
     }
+
+    size_t offset = 0;
+    do {
+        size_t chunk = size - offset < XXD_CHUNK_SIZE ? size - offset : XXD_CHUNK_SIZE;
+
+        *encode_xxd(message + header_len, data + offset, chunk) = '\0';
+        DO_LOG_MESSAGE_NOCHECK_IMPL(logLevel, "%s", message);
+
+        offset += chunk;
+    } while (offset != size);
+}
+
+static void emit_deferred_xxd(const deferred_record_t* record, const uint8_t* data) {
+    DO_LOG_XXD_MESSAGE_NOCHECK_IMPL(record->level, data, record->size, "%s:%d:%s() %s", record->file, record->line,
+                                    record->function, record->prefix);
+}
+
+void log_defer_xxd(log_level_t logLevel, const char* file, int line, const char* function, const char* prefix,
+                   const uint8_t* data, size_t size) {
+    deferred_record_t record = { logLevel, file, line, function, prefix, size };
+
+    if (sizeof(record) + size > sizeof(gDeferred) - gDeferredSize) {
+        log_flush_deferred();
+    }
+
+    // too long to be deferred
+    if (sizeof(record) + size > sizeof(gDeferred)) {
+        emit_deferred_xxd(&record, data);
+        return;
+    }
+
+    memcpy(gDeferred + gDeferredSize, &record, sizeof(record));
+    memcpy(gDeferred + gDeferredSize + sizeof(record), data, size);
+    gDeferredSize += sizeof(record) + size;
+}
+
+void log_flush_deferred() {
+    size_t offset = 0;
+
+    while (offset != gDeferredSize) {
+        deferred_record_t record;
+        memcpy(&record, gDeferred + offset, sizeof(record));
+        offset += sizeof(record);
+
+        emit_deferred_xxd(&record, gDeferred + offset);
+        offset += record.size;
+    }
+
+    gDeferredSize = 0;
 }
@@ -0,0 +1,80 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#include <rtuartscreader/hardware/detail/clock_divisor.h>
+
+#include <stdbool.h>
+
+// PI_MASH_MAX_FREQ of pigpio.c: the fractional divider is used below this frequency
+#define GPCLK_MASH_MAX_HZ 23800000
+#define GPCLK_FRACTION 4096
+#define GPCLK_MIN_DIVISOR 2
+#define GPCLK_MAX_DIVISOR 4095
+
+// Divisor of the source in 1/4096 steps as chooseBestClock of pigpio.c rounds it
+static uint64_t gpclk_divisor(uint32_t source, uint32_t request) {
+    double divisor = (double)source / request;
+    if (request < GPCLK_MASH_MAX_HZ) {
+        divisor += 0.5 / GPCLK_FRACTION;
+        uint64_t integer = (uint64_t)divisor;
+        return integer * GPCLK_FRACTION + (uint64_t)((divisor - integer) * GPCLK_FRACTION);
+    }
+
+    return (uint64_t)(divisor + 0.5) * GPCLK_FRACTION;
+}
+
+static bool gpclk_divisor_is_valid(uint64_t divisor) {
+    return divisor / GPCLK_FRACTION >= GPCLK_MIN_DIVISOR && divisor / GPCLK_FRACTION <= GPCLK_MAX_DIVISOR;
+}
+
+double hw_gpclk_generated(const uint32_t* sources, size_t count, uint32_t request) {
+    double generated = 0;
+    double best_offby = 0;
+
+    if (!request) {
+        return 0;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t divisor = gpclk_divisor(sources[i], request);
+        if (!gpclk_divisor_is_valid(divisor)) {
+            continue;
+        }
+
+        double frequency = (double)sources[i] * GPCLK_FRACTION / divisor;
+        double offby = frequency > request ? frequency - request : request - frequency;
+        if (!generated || offby <= best_offby) {
+            generated = frequency;
+            best_offby = offby;
+        }
+    }
+
+    return generated;
+}
+
+// Each source is tried with the smallest divisor that does not exceed the frequency
+uint32_t hw_gpclk_request(const uint32_t* sources, size_t count, uint32_t frequency) {
+    uint32_t best = 0;
+
+    if (!frequency) {
+        return 0;
+    }
+
+    uint64_t step = frequency < GPCLK_MASH_MAX_HZ ? 1 : GPCLK_FRACTION;
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t scaled = (uint64_t)sources[i] * GPCLK_FRACTION;
+        uint64_t divisor = (scaled / step + frequency - 1) / frequency * step;
+        if (!gpclk_divisor_is_valid(divisor)) {
+            continue;
+        }
+
+        uint32_t request = (uint32_t)(scaled / divisor);
+        if (request > best && hw_gpclk_generated(sources, count, request) <= frequency) {
+            best = request;
+        }
+    }
+
+    return best;
+}
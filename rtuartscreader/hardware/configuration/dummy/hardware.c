@@ -5,31 +5,81 @@
 
 #include <rtuartscreader/hardware/hardware.h>
 
-hw_status_t hw_initialize_impl() {
+hw_status_t hw_initialize_impl(const hw_config_t* config) {
     return hw_status_failed;
 }
 
-hw_status_t hw_start_clock_impl(uint32_t frequency) {
+uint32_t hw_clock_frequency_impl(const hw_config_t* config, uint32_t frequency) {
+    return frequency;
+}
+
+hw_status_t hw_start_clock_impl(const hw_config_t* config, uint32_t frequency) {
+    return hw_status_failed;
+}
+
+hw_status_t hw_stop_clock_impl(const hw_config_t* config) {
+    return hw_status_failed;
+}
+
+hw_status_t hw_rst_initialize_impl(const hw_config_t* config) {
+    return hw_status_failed;
+}
+
+hw_status_t hw_rst_down_impl(const hw_config_t* config) {
+    return hw_status_failed;
+}
+
+hw_status_t hw_rst_down_up_impl(const hw_config_t* config, uint32_t delay_us) {
+    return hw_status_failed;
+}
+
+hw_status_t hw_rst_deinitialize_impl(const hw_config_t* config) {
     return hw_status_failed;
 }
 
-hw_status_t hw_stop_clock_impl() {
+hw_status_t hw_detect_initialize_impl(const hw_config_t* config) {
+    return hw_status_failed;
+}
+
+hw_status_t hw_detect_read_impl(const hw_config_t* config, bool* present) {
+    return hw_status_failed;
+}
+
+hw_status_t hw_detect_wait_impl(const hw_config_t* config, bool present, uint32_t timeout_ms) {
+    return hw_status_failed;
+}
+
+hw_status_t hw_detect_cancel_impl(const hw_config_t* config) {
+    return hw_status_failed;
+}
+
+hw_status_t hw_detect_deinitialize_impl(const hw_config_t* config) {
+    return hw_status_failed;
+}
+
+uint32_t hw_serial_max_baudrate_impl(const hw_config_t* config) {
+    return 0;
+}
+
+hw_status_t hw_serial_open_impl(const hw_config_t* config, uint32_t baudrate) {
     return hw_status_failed;
 }
 
-hw_status_t hw_rst_initialize_impl() {
+hw_status_t hw_serial_write_impl(const hw_config_t* config, uint32_t baudrate, uint32_t extra_gt_us,
+                                 hw_parity_t parity, const uint8_t* bytes, size_t len) {
     return hw_status_failed;
 }
 
-hw_status_t hw_rst_down_impl() {
+hw_status_t hw_serial_read_impl(const hw_config_t* config, hw_parity_t parity, uint8_t* buf, size_t len,
+                                size_t* read) {
     return hw_status_failed;
 }
 
-hw_status_t hw_rst_down_up_impl(uint32_t delay_us) {
+hw_status_t hw_serial_flush_impl(const hw_config_t* config) {
     return hw_status_failed;
 }
 
-hw_status_t hw_rst_deinitialize_impl() {
+hw_status_t hw_serial_close_impl(const hw_config_t* config) {
     return hw_status_failed;
 }
 
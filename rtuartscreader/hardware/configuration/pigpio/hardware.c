@@ -3,17 +3,53 @@
 // BSD license. See the LICENSE file found in the top-level directory of this
 // distribution.
 
+#define _GNU_SOURCE
+
 #include <rtuartscreader/hardware/hardware.h>
 
+#include <pthread.h>
+
 #include <pigpio/pigpio.h>
 
+#include <rtuartscreader/hardware/detail/clock_divisor.h>
+#include <rtuartscreader/hardware/detail/detect_line.h>
+#include <rtuartscreader/hardware/detail/pigpio_config.h>
 #include <rtuartscreader/log/log.h>
+#include <rtuartscreader/utils/common.h>
 
-#define PIN_PWM0 18
+#define DUTY_CYCLE_50_PERCENT 500000
 
-#define PIN_SC_RST 17
+// Base clocks pigpio divides: the PWM clock, which is PLLD divided by 2, and the
+// oscillator and PLLD feeding GPCLK. pigpio does not use the HDMI clock.
+#define PWM_BASE_HZ 250000000
+#define PWM_BASE_HZ_2711 375000000
+#define GPCLK_OSC_HZ 19200000
+#define GPCLK_OSC_HZ_2711 54000000
+#define GPCLK_PLLD_HZ 500000000
+#define GPCLK_PLLD_HZ_2711 750000000
 
-#define DUTY_CYCLE_50_PERCENT 500000
+#define REVISION_NEW_STYLE (1 << 23)
+#define REVISION_PROCESSOR(rev) (((rev) >> 12) & 0xF)
+#define PROCESSOR_BCM2711 3
+
+// Contacts of the card detect switch bounce, the level is reported once it is steady
+#define DETECT_STEADY_US 5000
+
+// 8 data bits and the parity bit are the data bits of the pigpio serial functions,
+// which add the start bit themselves; 2 ETU of guard time are their stop bits
+// counted in half bits
+#define SERIAL_DATA_BITS 9
+#define SERIAL_STOP_HALF_BITS 4
+#define SERIAL_ETU_PER_CHARACTER 12
+#define SERIAL_PARITY_BIT 0x100
+
+// Characters are converted on stack and sent as one waveform in chunks of this size
+#define SERIAL_CHUNK_SIZE 64
+
+// The end of a waveform is polled with this period once its duration has passed
+#define SERIAL_WAVE_POLL_US 20
+
+#define US_IN_S 1000000
 
 #define RETURN_ON_PIGPIO_CUSTOM_ERROR(r, expected)                                          \
     do {                                                                                    \
@@ -25,79 +61,438 @@
 
 #define RETURN_ON_PIGPIO_ERROR(r) RETURN_ON_PIGPIO_CUSTOM_ERROR(r, 0)
 
-hw_status_t hw_initialize_impl() {
-    const uint32_t gpioCfgInternals = PI_CFG_NOSIGHANDLER;
-    int r = gpioCfgSetInternals(gpioCfgInternals);
+// pigpio is a process-wide library, it is initialized by the first reader
+// and terminated by the last one. Its alert thread can only be started then.
+static pthread_mutex_t gPigpioLock = PTHREAD_MUTEX_INITIALIZER;
+static unsigned gPigpioUsers = 0;
+static bool gPigpioAlerts = false;
+
+static hw_status_t pigpio_initialize(bool alerts) {
+    int r = gpioCfgSetInternals(HW_PIGPIO_INTERNALS);
     RETURN_ON_PIGPIO_ERROR(r);
 
-    r = gpioCfgInterfaces(PI_DISABLE_FIFO_IF | PI_DISABLE_SOCK_IF | PI_DISABLE_ALERT);
+    r = gpioCfgInterfaces(HW_PIGPIO_INTERFACES(alerts));
     RETURN_ON_PIGPIO_ERROR(r);
 
     r = gpioInitialise();
     RETURN_ON_PIGPIO_CUSTOM_ERROR(r, PIGPIO_VERSION);
 
+    gPigpioAlerts = alerts;
+
     return hw_status_ok;
 }
 
-hw_status_t hw_start_clock_impl(uint32_t frequency) {
-    int r = gpioSetMode(PIN_PWM0, PI_ALT5);
-    RETURN_ON_PIGPIO_ERROR(r);
+hw_status_t hw_initialize_impl(const hw_config_t* config) {
+    hw_status_t r = hw_status_ok;
+    bool alerts = HW_PIGPIO_NEEDS_ALERTS(config);
+
+    pthread_mutex_lock(&gPigpioLock);
+
+    if (!gPigpioUsers) {
+        r = pigpio_initialize(alerts);
+    } else if (alerts && !gPigpioAlerts) {
+        DO_LOG_MESSAGE(LOG_LEVEL_ERROR, "pigpio runs without alerts: readers with det=, ndet= or io= must be opened first");
+        r = hw_status_failed;
+    }
+
+    if (r == hw_status_ok) {
+        ++gPigpioUsers;
+    }
+
+    pthread_mutex_unlock(&gPigpioLock);
+
+    return r;
+}
 
-    r = gpioHardwarePWM(PIN_PWM0, frequency, DUTY_CYCLE_50_PERCENT);
+static bool is_bcm2711() {
+    unsigned rev = gpioHardwareRevision();
+    return (rev & REVISION_NEW_STYLE) && REVISION_PROCESSOR(rev) == PROCESSOR_BCM2711;
+}
+
+// PWM divides its clock by an integer range, which is rounded up so that the frequency
+// does not exceed the requested one. GPCLK mirrors the choice of the source and the
+// fractional divisor made by gpioHardwareClock.
+uint32_t hw_clock_frequency_impl(const hw_config_t* config, uint32_t frequency) {
+    if (!frequency) {
+        return 0;
+    }
+
+    if (config->clock_source == hw_clock_gpclk) {
+        const uint32_t sources[] = { GPCLK_OSC_HZ, GPCLK_PLLD_HZ };
+        const uint32_t sources_2711[] = { GPCLK_OSC_HZ_2711, GPCLK_PLLD_HZ_2711 };
+
+        return hw_gpclk_request(is_bcm2711() ? sources_2711 : sources, ARRAYSIZE(sources), frequency);
+    }
+
+    uint32_t base = is_bcm2711() ? PWM_BASE_HZ_2711 : PWM_BASE_HZ;
+    uint32_t divisor = (base - 1) / frequency + 1;
+
+    return base / divisor;
+}
+
+// gpioHardwarePWM and gpioHardwareClock switch the GPIO to the alternative function of its channel
+hw_status_t hw_start_clock_impl(const hw_config_t* config, uint32_t frequency) {
+    int r;
+    if (config->clock_source == hw_clock_gpclk) {
+        r = gpioHardwareClock(config->clock_pin, frequency);
+    } else {
+        r = gpioHardwarePWM(config->clock_pin, frequency, DUTY_CYCLE_50_PERCENT);
+    }
     RETURN_ON_PIGPIO_ERROR(r);
 
     return hw_status_ok;
 }
 
-hw_status_t hw_stop_clock_impl() {
-    int r = stopHardwarePWM();
+// Zero frequency stops the channel of this GPIO only, the other channel may clock another reader
+hw_status_t hw_stop_clock_impl(const hw_config_t* config) {
+    int r;
+    if (config->clock_source == hw_clock_gpclk) {
+        r = gpioHardwareClock(config->clock_pin, 0);
+    } else {
+        r = gpioHardwarePWM(config->clock_pin, 0, 0);
+    }
     RETURN_ON_PIGPIO_ERROR(r);
 
     return hw_status_ok;
 }
 
-hw_status_t hw_rst_initialize_impl() {
-    int r = gpioSetMode(PIN_SC_RST, PI_OUTPUT);
+hw_status_t hw_rst_initialize_impl(const hw_config_t* config) {
+    int r = gpioSetMode(config->rst_pin, PI_OUTPUT);
     RETURN_ON_PIGPIO_ERROR(r);
 
-    r = gpioWrite(PIN_SC_RST, 0);
+    r = gpioWrite(config->rst_pin, 0);
     RETURN_ON_PIGPIO_ERROR(r);
 
     return hw_status_ok;
 }
 
-hw_status_t hw_rst_down_impl() {
-    int r = gpioWrite(PIN_SC_RST, 0);
+hw_status_t hw_rst_down_impl(const hw_config_t* config) {
+    int r = gpioWrite(config->rst_pin, 0);
     RETURN_ON_PIGPIO_ERROR(r);
 
     return hw_status_ok;
 }
 
-hw_status_t hw_rst_down_up_impl(uint32_t delay_us) {
-    int r = gpioWrite(PIN_SC_RST, 0);
+hw_status_t hw_rst_down_up_impl(const hw_config_t* config, uint32_t delay_us) {
+    int r = gpioWrite(config->rst_pin, 0);
     RETURN_ON_PIGPIO_ERROR(r);
 
     r = gpioSleep(PI_TIME_RELATIVE, 0, delay_us);
     RETURN_ON_PIGPIO_ERROR(r);
 
-    r = gpioWrite(PIN_SC_RST, 1);
+    r = gpioWrite(config->rst_pin, 1);
+    RETURN_ON_PIGPIO_ERROR(r);
+
+    return hw_status_ok;
+}
+
+hw_status_t hw_rst_deinitialize_impl(const hw_config_t* config) {
+    int r = gpioWrite(config->rst_pin, 0);
     RETURN_ON_PIGPIO_ERROR(r);
 
+    r = gpioSetMode(config->rst_pin, PI_INPUT);
+    RETURN_ON_PIGPIO_ERROR(r);
+
+    return hw_status_ok;
+}
+
+// pigpio alerts come per GPIO, so are the waiters for the card detect lines
+static hw_detect_line_t gDetectLines[PI_MAX_GPIO + 1];
+static pthread_once_t gDetectLinesOnce = PTHREAD_ONCE_INIT;
+
+static void detect_lines_initialize() {
+    size_t i;
+
+    for (i = 0; i < sizeof(gDetectLines) / sizeof(gDetectLines[0]); ++i) {
+        hw_detect_line_initialize(&gDetectLines[i]);
+    }
+}
+
+static hw_detect_line_t* get_detect_line(const hw_config_t* config) {
+    if (config->detect_pin > PI_MAX_GPIO) {
+        DO_LOG_MESSAGE(LOG_LEVEL_ERROR, "Invalid card detect GPIO: %u", config->detect_pin);
+        return NULL;
+    }
+
+    pthread_once(&gDetectLinesOnce, detect_lines_initialize);
+
+    return &gDetectLines[config->detect_pin];
+}
+
+static void detect_line_alert(int gpio, int level, uint32_t tick, void* userdata) {
+    hw_detect_line_notify(userdata);
+}
+
+static hw_status_t detect_line_read(const hw_config_t* config, bool* present) {
+    int level = gpioRead(config->detect_pin);
+    if (level < 0) {
+        RETURN_ON_PIGPIO_ERROR(level);
+    }
+
+    *present = (level == PI_HIGH) != config->detect_active_low;
+
     return hw_status_ok;
 }
 
-hw_status_t hw_rst_deinitialize_impl() {
-    int r = gpioWrite(PIN_SC_RST, 0);
+hw_status_t hw_detect_initialize_impl(const hw_config_t* config) {
+    hw_detect_line_t* line = get_detect_line(config);
+    if (!line) {
+        return hw_status_failed;
+    }
+
+    hw_detect_line_reset(line);
+
+    int r = gpioSetMode(config->detect_pin, PI_INPUT);
+    RETURN_ON_PIGPIO_ERROR(r);
+
+    // Keep the line at the absent level while the switch is open
+    r = gpioSetPullUpDown(config->detect_pin, config->detect_active_low ? PI_PUD_UP : PI_PUD_DOWN);
+    RETURN_ON_PIGPIO_ERROR(r);
+
+    r = gpioGlitchFilter(config->detect_pin, DETECT_STEADY_US);
     RETURN_ON_PIGPIO_ERROR(r);
 
-    r = gpioSetMode(PIN_SC_RST, PI_INPUT);
+    r = gpioSetAlertFuncEx(config->detect_pin, detect_line_alert, line);
+    RETURN_ON_PIGPIO_ERROR(r);
+
+    return hw_status_ok;
+}
+
+hw_status_t hw_detect_read_impl(const hw_config_t* config, bool* present) {
+    return detect_line_read(config, present);
+}
+
+hw_status_t hw_detect_wait_impl(const hw_config_t* config, bool present, uint32_t timeout_ms) {
+    hw_detect_line_t* line = get_detect_line(config);
+    if (!line) {
+        return hw_status_failed;
+    }
+
+    return hw_detect_line_wait(line, config, detect_line_read, present, timeout_ms);
+}
+
+hw_status_t hw_detect_cancel_impl(const hw_config_t* config) {
+    hw_detect_line_t* line = get_detect_line(config);
+    if (!line) {
+        return hw_status_failed;
+    }
+
+    hw_detect_line_cancel(line);
+
+    return hw_status_ok;
+}
+
+hw_status_t hw_detect_deinitialize_impl(const hw_config_t* config) {
+    int r = gpioSetAlertFuncEx(config->detect_pin, NULL, NULL);
+    RETURN_ON_PIGPIO_ERROR(r);
+
+    r = gpioGlitchFilter(config->detect_pin, 0);
+    RETURN_ON_PIGPIO_ERROR(r);
+
+    return hw_detect_cancel_impl(config);
+}
+
+// pigpio builds a single waveform at a time for all the GPIOs, so the readers
+// send their characters in turn
+static pthread_mutex_t gWaveLock = PTHREAD_MUTEX_INITIALIZER;
+
+static uint16_t serial_character(uint8_t byte, hw_parity_t parity) {
+    bool odd_ones = __builtin_parity(byte);
+    return byte | (odd_ones != (parity == hw_parity_odd) ? SERIAL_PARITY_BIT : 0);
+}
+
+// The characters are scheduled from the start of the waveform, so rounding does not accumulate
+static uint32_t serial_offset_us(uint32_t baudrate, uint32_t extra_gt_us, size_t index) {
+    return (uint32_t)((uint64_t)index * SERIAL_ETU_PER_CHARACTER * US_IN_S / baudrate + (uint64_t)index * extra_gt_us);
+}
+
+// The line is sampled by software
+uint32_t hw_serial_max_baudrate_impl(const hw_config_t* config) {
+    return PI_BB_SER_MAX_BAUD;
+}
+
+hw_status_t hw_serial_open_impl(const hw_config_t* config, uint32_t baudrate) {
+    int r = gpioSetMode(config->io_pin, PI_INPUT);
+    RETURN_ON_PIGPIO_ERROR(r);
+
+    // The line is idle high, the card only pulls it low
+    r = gpioSetPullUpDown(config->io_pin, PI_PUD_UP);
+    RETURN_ON_PIGPIO_ERROR(r);
+
+    r = gpioSerialReadOpen(config->io_pin, baudrate, SERIAL_DATA_BITS);
+    RETURN_ON_PIGPIO_ERROR(r);
+
+    return hw_status_ok;
+}
+
+static hw_status_t serial_wait_wave(uint32_t duration_us) {
+    int r = gpioSleep(PI_TIME_RELATIVE, duration_us / US_IN_S, duration_us % US_IN_S);
+    RETURN_ON_PIGPIO_ERROR(r);
+
+    while (gpioWaveTxBusy()) {
+        r = gpioSleep(PI_TIME_RELATIVE, 0, SERIAL_WAVE_POLL_US);
+        RETURN_ON_PIGPIO_ERROR(r);
+    }
+
+    return hw_status_ok;
+}
+
+// The GPIO drives the line only while the waveform is sent, so that the card
+// is able to answer afterwards
+// A waveform can only switch the output level, so the GPIO drives the I/O line high
+// push-pull during the stop bits and the guard time rather than releasing it as
+// an open drain output would. A card signalling an error then pulls against the
+// GPIO: the I/O contact has to be connected through a series resistor (1 kOhm
+// limits the current to 3.3 mA) with the pull-up on the card side.
+static hw_status_t serial_send_wave(const hw_config_t* config, int wave, uint32_t duration_us) {
+    int r = gpioWrite(config->io_pin, 1);
+    RETURN_ON_PIGPIO_ERROR(r);
+
+    r = gpioSetMode(config->io_pin, PI_OUTPUT);
+    RETURN_ON_PIGPIO_ERROR(r);
+
+    hw_status_t status = hw_status_failed;
+
+    r = gpioWaveTxSend(wave, PI_WAVE_MODE_ONE_SHOT);
+    if (r >= 0) {
+        status = serial_wait_wave(duration_us);
+    } else {
+        DO_LOG_MESSAGE(LOG_LEVEL_ERROR, "PIGPIO ERROR: %x", r);
+    }
+
+    r = gpioSetMode(config->io_pin, PI_INPUT);
+    RETURN_ON_PIGPIO_ERROR(r);
+
+    return status;
+}
+
+static hw_status_t serial_write_chunk(const hw_config_t* config, uint32_t baudrate, uint32_t extra_gt_us,
+                                      hw_parity_t parity, const uint8_t* bytes, size_t len) {
+    uint16_t characters[SERIAL_CHUNK_SIZE];
+    size_t i;
+
+    for (i = 0; i != len; ++i) {
+        characters[i] = serial_character(bytes[i], parity);
+    }
+
+    int r = gpioWaveAddNew();
+    RETURN_ON_PIGPIO_ERROR(r);
+
+    if (!extra_gt_us) {
+        // Back to back characters are timed by pigpio itself
+        r = gpioWaveAddSerial(config->io_pin, baudrate, SERIAL_DATA_BITS, SERIAL_STOP_HALF_BITS, 0,
+                              len * sizeof(characters[0]), (char*)characters);
+        if (r < 0) {
+            RETURN_ON_PIGPIO_ERROR(r);
+        }
+    } else {
+        for (i = 0; i != len; ++i) {
+            r = gpioWaveAddSerial(config->io_pin, baudrate, SERIAL_DATA_BITS, SERIAL_STOP_HALF_BITS,
+                                  serial_offset_us(baudrate, extra_gt_us, i), sizeof(characters[0]),
+                                  (char*)&characters[i]);
+            if (r < 0) {
+                RETURN_ON_PIGPIO_ERROR(r);
+            }
+        }
+    }
+
+    int wave = gpioWaveCreate();
+    if (wave < 0) {
+        RETURN_ON_PIGPIO_ERROR(wave);
+    }
+
+    // Extra guard time after the last character is waited as well, so that the next chunk keeps it
+    hw_status_t status = serial_send_wave(config, wave, serial_offset_us(baudrate, extra_gt_us, len));
+
+    r = gpioWaveDelete(wave);
+    RETURN_ON_PIGPIO_ERROR(r);
+
+    return status;
+}
+
+hw_status_t hw_serial_write_impl(const hw_config_t* config, uint32_t baudrate, uint32_t extra_gt_us,
+                                 hw_parity_t parity, const uint8_t* bytes, size_t len) {
+    hw_status_t r = hw_status_ok;
+    size_t sent;
+
+    for (sent = 0; sent != len && r == hw_status_ok;) {
+        size_t chunk = len - sent < SERIAL_CHUNK_SIZE ? len - sent : SERIAL_CHUNK_SIZE;
+
+        pthread_mutex_lock(&gWaveLock);
+        r = serial_write_chunk(config, baudrate, extra_gt_us, parity, bytes + sent, chunk);
+        pthread_mutex_unlock(&gWaveLock);
+
+        sent += chunk;
+    }
+
+    return r;
+}
+
+hw_status_t hw_serial_read_impl(const hw_config_t* config, hw_parity_t parity, uint8_t* buf, size_t len,
+                                size_t* read) {
+    uint16_t characters[SERIAL_CHUNK_SIZE];
+
+    *read = 0;
+
+    while (*read != len) {
+        size_t count = len - *read < SERIAL_CHUNK_SIZE ? len - *read : SERIAL_CHUNK_SIZE;
+
+        int r = gpioSerialRead(config->io_pin, characters, count * sizeof(characters[0]));
+        if (r < 0) {
+            RETURN_ON_PIGPIO_ERROR(r);
+        }
+
+        size_t received = (size_t)r / sizeof(characters[0]);
+        size_t i;
+
+        for (i = 0; i != received; ++i) {
+            uint8_t byte = (uint8_t)characters[i];
+
+            if (parity != hw_parity_ignored && characters[i] != serial_character(byte, parity)) {
+                DO_LOG_MESSAGE(LOG_LEVEL_ERROR, "Parity error on GPIO %u: %03x", config->io_pin, characters[i]);
+                return hw_status_failed;
+            }
+
+            buf[(*read)++] = byte;
+        }
+
+        if (received != count) {
+            break;
+        }
+    }
+
+    return hw_status_ok;
+}
+
+hw_status_t hw_serial_flush_impl(const hw_config_t* config) {
+    uint16_t characters[SERIAL_CHUNK_SIZE];
+    int r;
+
+    do {
+        r = gpioSerialRead(config->io_pin, characters, sizeof(characters));
+        if (r < 0) {
+            RETURN_ON_PIGPIO_ERROR(r);
+        }
+    } while ((size_t)r == sizeof(characters));
+
+    return hw_status_ok;
+}
+
+hw_status_t hw_serial_close_impl(const hw_config_t* config) {
+    int r = gpioSerialReadClose(config->io_pin);
     RETURN_ON_PIGPIO_ERROR(r);
 
     return hw_status_ok;
 }
 
 void hw_deinitialize_impl() {
-    gpioTerminate();
+    pthread_mutex_lock(&gPigpioLock);
+
+    if (gPigpioUsers && !--gPigpioUsers) {
+        gpioTerminate();
+    }
+
+    pthread_mutex_unlock(&gPigpioLock);
 }
 
 #define PIMPL_NAME_PREFIX hw
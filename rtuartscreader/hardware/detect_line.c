@@ -0,0 +1,95 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#include <rtuartscreader/hardware/detail/detect_line.h>
+
+#include <errno.h>
+#include <time.h>
+
+#define MS_IN_S 1000
+#define NS_IN_MS 1000000
+#define NS_IN_S 1000000000
+
+void hw_detect_line_initialize(hw_detect_line_t* line) {
+    pthread_condattr_t attr;
+
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+
+    pthread_mutex_init(&line->lock, NULL);
+    pthread_cond_init(&line->changed, &attr);
+    line->cancelled = false;
+
+    pthread_condattr_destroy(&attr);
+}
+
+void hw_detect_line_reset(hw_detect_line_t* line) {
+    pthread_mutex_lock(&line->lock);
+    line->cancelled = false;
+    pthread_mutex_unlock(&line->lock);
+}
+
+void hw_detect_line_notify(hw_detect_line_t* line) {
+    pthread_mutex_lock(&line->lock);
+    pthread_cond_broadcast(&line->changed);
+    pthread_mutex_unlock(&line->lock);
+}
+
+void hw_detect_line_cancel(hw_detect_line_t* line) {
+    pthread_mutex_lock(&line->lock);
+    line->cancelled = true;
+    pthread_cond_broadcast(&line->changed);
+    pthread_mutex_unlock(&line->lock);
+}
+
+hw_status_t hw_detect_line_wait(hw_detect_line_t* line, const hw_config_t* config, hw_detect_line_read_t read,
+                                bool present, uint32_t timeout_ms) {
+    bool infinite = timeout_ms == HW_WAIT_INFINITE;
+    struct timespec deadline;
+
+    if (!infinite) {
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_sec += timeout_ms / MS_IN_S;
+        deadline.tv_nsec += (long)(timeout_ms % MS_IN_S) * NS_IN_MS;
+        if (deadline.tv_nsec >= NS_IN_S) {
+            ++deadline.tv_sec;
+            deadline.tv_nsec -= NS_IN_S;
+        }
+    }
+
+    hw_status_t r = hw_status_ok;
+    int wait_r = 0;
+
+    pthread_mutex_lock(&line->lock);
+
+    for (;;) {
+        bool current;
+
+        if (line->cancelled) {
+            r = hw_status_cancelled;
+            break;
+        }
+
+        r = read(config, &current);
+        if (r != hw_status_ok || current != present) {
+            break;
+        }
+
+        if (wait_r == ETIMEDOUT) {
+            r = hw_status_timeout;
+            break;
+        }
+
+        if (infinite) {
+            pthread_cond_wait(&line->changed, &line->lock);
+        } else {
+            wait_r = pthread_cond_timedwait(&line->changed, &line->lock, &deadline);
+        }
+    }
+
+    pthread_mutex_unlock(&line->lock);
+
+    return r;
+}
@@ -6,7 +6,10 @@
 #include <PCSC/ifdhandler.h>
 #include <PCSC/reader.h>
 
+#include <limits.h>
+#include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -15,6 +18,11 @@
 #include <rtuartscreader/log/log.h>
 #include <rtuartscreader/reader.h>
 #include <rtuartscreader/reader_list.h>
+#include <rtuartscreader/reader_script.h>
+#include <rtuartscreader/reader_stats.h>
+#include <rtuartscreader/transport/device_name.h>
+#include <rtuartscreader/transport/engine.h>
+#include <rtuartscreader/vendor_tags.h>
 
 static const char* ifd_error_to_string(int error) {
     switch (error) {
@@ -42,13 +50,15 @@ static const char* ifd_error_to_string(int error) {
 
 RESPONSECODE IFDHCreateChannelByName(DWORD Lun, LPSTR DeviceName) {
     init_log();
+    init_transport_engine();
 
     LOG_INFO("Lun: %lu, DeviceName: %s", Lun, DeviceName);
 
     Reader* reader = NULL;
 
-    reader = reader_list_get_reader(Lun);
+    reader = reader_list_acquire_reader(Lun);
     if (reader) {
+        reader_list_release_reader(reader);
         LOG_CRITICAL_RETURN_IFD(IFD_COMMUNICATION_ERROR, "Lun is already in use");
     }
 
@@ -57,9 +67,21 @@ RESPONSECODE IFDHCreateChannelByName(DWORD Lun, LPSTR DeviceName) {
         LOG_CRITICAL_RETURN_IFD(IFD_COMMUNICATION_ERROR, "Failed to alloc reader");
     }
 
+    // The GPIOs are checked before the reader drives them, a shared RST or clock line
+    // would reset or clock the card of another reader. A device name which cannot be
+    // parsed is reported by reader_open.
+    char path[PATH_MAX];
+    hw_config_t hw;
+    realtime_config_t realtime;
+    if (parse_device_name(DeviceName, path, sizeof(path), &hw, &realtime) == transport_status_ok &&
+        !reader_list_reserve_gpios(reader, &hw)) {
+        reader_list_free_reader(reader);
+        LOG_CRITICAL_RETURN_IFD(IFD_COMMUNICATION_ERROR, "GPIO of the reader is in use");
+    }
+
     reader_status_t r = reader_open(reader, DeviceName);
     if (r != reader_status_ok) {
-        reader_list_free_reader(Lun);
+        reader_list_free_reader(reader);
 
         if (r == reader_status_reader_not_found) {
             LOG_CRITICAL_RETURN_IFD(IFD_NO_SUCH_DEVICE, "reader_open failed: %d", r);
@@ -68,13 +90,70 @@ RESPONSECODE IFDHCreateChannelByName(DWORD Lun, LPSTR DeviceName) {
         }
     }
 
+    reader_list_release_reader(reader);
+
+    LOG_INFO_RETURN_IFD(IFD_SUCCESS);
+}
+
+static RESPONSECODE ControlGetStats(DWORD Lun, PUCHAR RxBuffer, DWORD RxLength, LPDWORD pdwBytesReturned) {
+    reader_stats_t stats;
+    if (RxLength < sizeof(stats)) {
+        LOG_INFO_RETURN_IFD(IFD_ERROR_INSUFFICIENT_BUFFER);
+    }
+    if (!RxBuffer) {
+        LOG_ERROR_RETURN_IFD(IFD_COMMUNICATION_ERROR, "Invalid RxBuffer ptr");
+    }
+
+    if (!reader_list_get_stats(Lun, &stats)) {
+        LOG_ERROR_RETURN_IFD(IFD_COMMUNICATION_ERROR, "Invalid Lun");
+    }
+
+    memcpy(RxBuffer, &stats, sizeof(stats));
+    *pdwBytesReturned = sizeof(stats);
+
+    LOG_INFO_RETURN_IFD(IFD_SUCCESS);
+}
+
+static RESPONSECODE ControlRunScript(DWORD Lun, PUCHAR TxBuffer, DWORD TxLength, PUCHAR RxBuffer, DWORD RxLength,
+                                     LPDWORD pdwBytesReturned) {
+    Reader* reader = reader_list_acquire_reader(Lun);
+    if (!reader) {
+        LOG_ERROR_RETURN_IFD(IFD_COMMUNICATION_ERROR, "Invalid Lun");
+    }
+
+    DWORD length = RxLength;
+    reader_status_t r = reader_run_script(reader, TxBuffer, TxLength, RxBuffer, &length);
+
+    reader_list_release_reader(reader);
+
+    if (r == reader_status_memory_error) {
+        LOG_ERROR_RETURN_IFD(IFD_ERROR_INSUFFICIENT_BUFFER, "reader_run_script failed: %d", r);
+    } else if (r != reader_status_ok) {
+        LOG_ERROR_RETURN_IFD(IFD_COMMUNICATION_ERROR, "reader_run_script failed: %d", r);
+    }
+
+    *pdwBytesReturned = length;
+
     LOG_INFO_RETURN_IFD(IFD_SUCCESS);
 }
 
 RESPONSECODE IFDHControl(DWORD Lun, DWORD dwControlCode, PUCHAR TxBuffer, DWORD TxLength, PUCHAR RxBuffer,
                          DWORD RxLength, LPDWORD pdwBytesReturned) {
     LOG_INFO("Lun: %lu, dwControlCode: %lu", Lun, dwControlCode);
-    LOG_INFO_RETURN_IFD(IFD_NOT_SUPPORTED);
+
+    if (!pdwBytesReturned) {
+        LOG_ERROR_RETURN_IFD(IFD_COMMUNICATION_ERROR, "Invalid pdwBytesReturned ptr");
+    }
+    *pdwBytesReturned = 0;
+
+    switch (dwControlCode) {
+    case IOCTL_RTUARTSCREADER_GET_STATS:
+        return ControlGetStats(Lun, RxBuffer, RxLength, pdwBytesReturned);
+    case IOCTL_RTUARTSCREADER_RUN_SCRIPT:
+        return ControlRunScript(Lun, TxBuffer, TxLength, RxBuffer, RxLength, pdwBytesReturned);
+    default:
+        LOG_INFO_RETURN_IFD(IFD_NOT_SUPPORTED);
+    }
 }
 
 RESPONSECODE IFDHCreateChannel(DWORD Lun, DWORD Channel) {
@@ -92,7 +171,7 @@ RESPONSECODE IFDHCreateChannel(DWORD Lun, DWORD Channel) {
 RESPONSECODE IFDHCloseChannel(DWORD Lun) {
     LOG_INFO("Lun: %lu", Lun);
 
-    Reader* reader = reader_list_get_reader(Lun);
+    Reader* reader = reader_list_acquire_reader(Lun);
     if (!reader) {
         LOG_ERROR_RETURN_IFD(IFD_COMMUNICATION_ERROR, "Invalid Lun");
     }
@@ -107,7 +186,7 @@ RESPONSECODE IFDHCloseChannel(DWORD Lun) {
         LOG_ERROR("reader_close failed: %d", r);
     }
 
-    reader_list_free_reader(Lun);
+    reader_list_free_reader(reader);
 
     LOG_INFO_RETURN_IFD(IFD_SUCCESS);
 }
@@ -147,17 +226,13 @@ static RESPONSECODE ZeroAtr(PUCHAR Atr, PDWORD AtrLength) {
     LOG_INFO_RETURN_IFD(IFD_SUCCESS);
 }
 
-RESPONSECODE IFDHGetCapabilities(DWORD Lun, DWORD Tag, PDWORD Length, PUCHAR Value) {
-    LOG_INFO("Lun: %lu, Tag: 0x%lx", Lun, Tag);
+static RESPONSECODE IFDHPollCardEvent(DWORD Lun, int timeout);
+static RESPONSECODE IFDHStopPolling(DWORD Lun);
 
+static RESPONSECODE doIFDHGetReaderCapabilities(Reader* reader, DWORD Tag, PDWORD Length, PUCHAR Value) {
     switch (Tag) {
     case TAG_IFD_ATR:
     case SCARD_ATTR_ATR_STRING: {
-        Reader* reader = reader_list_get_reader(Lun);
-        if (!reader) {
-            LOG_ERROR_RETURN_IFD(IFD_COMMUNICATION_ERROR, "Invalid Lun");
-        }
-
         reader_status_t r = reader_is_powered(reader);
         if (r == reader_status_reader_unpowered) {
             return ZeroAtr(Value, Length);
@@ -172,12 +247,102 @@ RESPONSECODE IFDHGetCapabilities(DWORD Lun, DWORD Tag, PDWORD Length, PUCHAR Val
 
         return GetCapability(atrLen, atr, Length, Value);
     }
+    case SCARD_ATTR_CURRENT_PROTOCOL_TYPE: {
+        DWORD protocol;
+        reader_status_t r = reader_get_protocol(reader, &protocol);
+        if (r != reader_status_ok) {
+            LOG_ERROR_RETURN_IFD(IFD_COMMUNICATION_ERROR, "reader_get_protocol failed: %d", r);
+        }
+
+        return GetCapability(sizeof(protocol), (const UCHAR*)&protocol, Length, Value);
+    }
+    case SCARD_ATTR_RTUARTSCREADER_AUTO_GET_RESPONSE: {
+        bool enabled;
+        reader_status_t r = reader_get_auto_get_response(reader, &enabled);
+        if (r != reader_status_ok) {
+            LOG_ERROR_RETURN_IFD(IFD_COMMUNICATION_ERROR, "reader_get_auto_get_response failed: %d", r);
+        }
+
+        UCHAR result = enabled;
+        return GetCapability(1, &result, Length, Value);
+    }
+    case SCARD_ATTR_RTUARTSCREADER_ATR_CACHE_STATS: {
+        uint32_t stats[2];
+        reader_status_t r = reader_get_atr_cache_stats(reader, &stats[0], &stats[1]);
+        if (r != reader_status_ok) {
+            LOG_ERROR_RETURN_IFD(IFD_COMMUNICATION_ERROR, "reader_get_atr_cache_stats failed: %d", r);
+        }
+
+        return GetCapability(sizeof(stats), (const UCHAR*)stats, Length, Value);
+    }
+    case SCARD_ATTR_RTUARTSCREADER_RECONFIG_STATS: {
+        transport_reconfig_stats_t stats;
+        reader_status_t r = reader_get_reconfig_stats(reader, &stats);
+        if (r != reader_status_ok) {
+            LOG_ERROR_RETURN_IFD(IFD_COMMUNICATION_ERROR, "reader_get_reconfig_stats failed: %d", r);
+        }
+
+        uint32_t result[] = { stats.serial_setups, stats.serial_setups_skipped, stats.clock_changes,
+                              stats.clock_changes_skipped };
+        return GetCapability(sizeof(result), (const UCHAR*)result, Length, Value);
+    }
+    // The polling thread is provided for the readers with a card detect line only,
+    // the others are polled with IFDHICCPresence
+    case TAG_IFD_POLLING_THREAD_WITH_TIMEOUT:
+    case TAG_IFD_STOP_POLLING_THREAD: {
+        reader_presence_watch_t watch;
+        reader_status_t r = reader_watch_presence(reader, &watch);
+        if (r == reader_status_not_supported) {
+            LOG_INFO_RETURN_IFD(IFD_NOT_SUPPORTED);
+        } else if (r != reader_status_ok) {
+            LOG_ERROR_RETURN_IFD(IFD_COMMUNICATION_ERROR, "reader_watch_presence failed: %d", r);
+        }
+
+        if (Tag == TAG_IFD_POLLING_THREAD_WITH_TIMEOUT) {
+            RESPONSECODE (*pollCardEvent)(DWORD, int) = IFDHPollCardEvent;
+            return GetCapability(sizeof(pollCardEvent), (const UCHAR*)&pollCardEvent, Length, Value);
+        }
+
+        RESPONSECODE (*stopPolling)(DWORD) = IFDHStopPolling;
+        return GetCapability(sizeof(stopPolling), (const UCHAR*)&stopPolling, Length, Value);
+    }
+    default:
+        LOG_INFO_RETURN_IFD(IFD_ERROR_TAG);
+    }
+}
+
+static RESPONSECODE IFDHGetReaderCapabilities(DWORD Lun, DWORD Tag, PDWORD Length, PUCHAR Value) {
+    Reader* reader = reader_list_acquire_reader(Lun);
+    if (!reader) {
+        LOG_ERROR_RETURN_IFD(IFD_COMMUNICATION_ERROR, "Invalid Lun");
+    }
+
+    RESPONSECODE r = doIFDHGetReaderCapabilities(reader, Tag, Length, Value);
+
+    reader_list_release_reader(reader);
+
+    return r;
+}
+
+RESPONSECODE IFDHGetCapabilities(DWORD Lun, DWORD Tag, PDWORD Length, PUCHAR Value) {
+    LOG_INFO("Lun: %lu, Tag: 0x%lx", Lun, Tag);
+
+    switch (Tag) {
+    case TAG_IFD_ATR:
+    case SCARD_ATTR_ATR_STRING:
+    case SCARD_ATTR_CURRENT_PROTOCOL_TYPE:
+    case SCARD_ATTR_RTUARTSCREADER_AUTO_GET_RESPONSE:
+    case SCARD_ATTR_RTUARTSCREADER_ATR_CACHE_STATS:
+    case SCARD_ATTR_RTUARTSCREADER_RECONFIG_STATS:
+    case TAG_IFD_POLLING_THREAD_WITH_TIMEOUT:
+    case TAG_IFD_STOP_POLLING_THREAD:
+        return IFDHGetReaderCapabilities(Lun, Tag, Length, Value);
     case TAG_IFD_SIMULTANEOUS_ACCESS: {
         UCHAR result = gReaderListSize;
         return GetCapability(1, &result, Length, Value);
     }
     case TAG_IFD_THREAD_SAFE: {
-        UCHAR result = 0; // No thread-safety
+        UCHAR result = 1; // Readers are locked independently
         return GetCapability(1, &result, Length, Value);
     }
     case TAG_IFD_SLOTS_NUMBER: {
@@ -185,13 +350,11 @@ RESPONSECODE IFDHGetCapabilities(DWORD Lun, DWORD Tag, PDWORD Length, PUCHAR Val
         return GetCapability(1, &result, Length, Value);
     }
     case TAG_IFD_SLOT_THREAD_SAFE: {
-        UCHAR result = 0; // No thread-safety
+        UCHAR result = 0; // Single slot, nothing to access in parallel
         return GetCapability(1, &result, Length, Value);
     }
     case TAG_IFD_POLLING_THREAD:
-    case TAG_IFD_POLLING_THREAD_WITH_TIMEOUT:
     case TAG_IFD_POLLING_THREAD_KILLABLE:
-    case TAG_IFD_STOP_POLLING_THREAD:
         LOG_INFO_RETURN_IFD(IFD_NOT_SUPPORTED);
     default:
         LOG_INFO_RETURN_IFD(IFD_ERROR_TAG);
@@ -200,22 +363,65 @@ RESPONSECODE IFDHGetCapabilities(DWORD Lun, DWORD Tag, PDWORD Length, PUCHAR Val
 
 RESPONSECODE IFDHSetCapabilities(DWORD Lun, DWORD Tag, DWORD Length, PUCHAR Value) {
     LOG_INFO("Lun: %lu, Tag: %lu", Lun, Tag);
-    LOG_INFO_RETURN_IFD(IFD_NOT_SUPPORTED);
+
+    switch (Tag) {
+    case SCARD_ATTR_RTUARTSCREADER_AUTO_GET_RESPONSE: {
+        if (Length != 1 || !Value) {
+            LOG_ERROR_RETURN_IFD(IFD_ERROR_SET_FAILURE, "Invalid value");
+        }
+
+        Reader* reader = reader_list_acquire_reader(Lun);
+        if (!reader) {
+            LOG_ERROR_RETURN_IFD(IFD_COMMUNICATION_ERROR, "Invalid Lun");
+        }
+
+        reader_status_t r = reader_set_auto_get_response(reader, Value[0] != 0);
+
+        reader_list_release_reader(reader);
+
+        if (r != reader_status_ok) {
+            LOG_ERROR_RETURN_IFD(IFD_COMMUNICATION_ERROR, "reader_set_auto_get_response failed: %d", r);
+        }
+
+        LOG_INFO_RETURN_IFD(IFD_SUCCESS);
+    }
+    default:
+        LOG_INFO_RETURN_IFD(IFD_NOT_SUPPORTED);
+    }
 }
 
-RESPONSECODE IFDHSetProtocolParameters(DWORD Lun, DWORD Protocol, UCHAR Flags, UCHAR PTS1, UCHAR PTS2, UCHAR PTS3) {
-    LOG_INFO("Lun: %lu, Protocol: %lu", Lun, Protocol);
-    LOG_INFO_RETURN_IFD(IFD_NOT_SUPPORTED);
+// The protocol and F & D are negotiated with PPS during the reset already, another PPS
+// is not sent. The requested protocol is accepted only if it is the negotiated one.
+static RESPONSECODE doIFDHSetProtocolParameters(Reader* reader, DWORD Protocol) {
+    DWORD negotiated;
+    reader_status_t r = reader_get_protocol(reader, &negotiated);
+    if (r != reader_status_ok) {
+        LOG_ERROR_RETURN_IFD(IFD_COMMUNICATION_ERROR, "reader_get_protocol failed: %d", r);
+    }
+
+    if (!(Protocol & negotiated)) {
+        LOG_ERROR_RETURN_IFD(IFD_PROTOCOL_NOT_SUPPORTED, "Protocol 0x%lx is negotiated", negotiated);
+    }
+
+    LOG_INFO_RETURN_IFD(IFD_SUCCESS);
 }
 
-RESPONSECODE IFDHPowerICC(DWORD Lun, DWORD Action, PUCHAR Atr, PDWORD AtrLength) {
-    LOG_INFO("Lun: %lu, Action: 0x%lx", Lun, Action);
+RESPONSECODE IFDHSetProtocolParameters(DWORD Lun, DWORD Protocol, UCHAR Flags, UCHAR PTS1, UCHAR PTS2, UCHAR PTS3) {
+    LOG_INFO("Lun: %lu, Protocol: %lu", Lun, Protocol);
 
-    Reader* reader = reader_list_get_reader(Lun);
+    Reader* reader = reader_list_acquire_reader(Lun);
     if (!reader) {
         LOG_ERROR_RETURN_IFD(IFD_COMMUNICATION_ERROR, "Invalid Lun");
     }
 
+    RESPONSECODE r = doIFDHSetProtocolParameters(reader, Protocol);
+
+    reader_list_release_reader(reader);
+
+    return r;
+}
+
+static RESPONSECODE doIFDHPowerICC(Reader* reader, DWORD Action, PUCHAR Atr, PDWORD AtrLength) {
     reader_status_t r;
 
     const UCHAR* atr;
@@ -250,16 +456,34 @@ RESPONSECODE IFDHPowerICC(DWORD Lun, DWORD Action, PUCHAR Atr, PDWORD AtrLength)
     }
 }
 
+RESPONSECODE IFDHPowerICC(DWORD Lun, DWORD Action, PUCHAR Atr, PDWORD AtrLength) {
+    LOG_INFO("Lun: %lu, Action: 0x%lx", Lun, Action);
+
+    Reader* reader = reader_list_acquire_reader(Lun);
+    if (!reader) {
+        LOG_ERROR_RETURN_IFD(IFD_COMMUNICATION_ERROR, "Invalid Lun");
+    }
+
+    RESPONSECODE r = doIFDHPowerICC(reader, Action, Atr, AtrLength);
+
+    reader_list_release_reader(reader);
+
+    return r;
+}
+
 RESPONSECODE IFDHTransmitToICC(DWORD Lun, SCARD_IO_HEADER SendPci, PUCHAR TxBuffer, DWORD TxLength, PUCHAR RxBuffer,
                                PDWORD RxLength, PSCARD_IO_HEADER RecvPci) {
     LOG_INFO("Lun: %lu", Lun);
 
-    Reader* reader = reader_list_get_reader(Lun);
+    Reader* reader = reader_list_acquire_reader(Lun);
     if (!reader) {
         LOG_ERROR_RETURN_IFD(IFD_COMMUNICATION_ERROR, "Invalid Lun");
     }
 
     reader_status_t r = reader_transmit(reader, TxBuffer, TxLength, RxBuffer, RxLength);
+
+    reader_list_release_reader(reader);
+
     if (r != reader_status_ok) {
         LOG_ERROR_RETURN_IFD(IFD_COMMUNICATION_ERROR, "reader_transmit failed: %d", r);
     }
@@ -270,12 +494,15 @@ RESPONSECODE IFDHTransmitToICC(DWORD Lun, SCARD_IO_HEADER SendPci, PUCHAR TxBuff
 static RESPONSECODE doIFDHICCPresence(DWORD Lun) {
     LOG_INFO("Lun: %lu", Lun);
 
-    Reader* reader = reader_list_get_reader(Lun);
+    Reader* reader = reader_list_acquire_reader(Lun);
     if (!reader) {
         LOG_ERROR_RETURN_IFD(IFD_COMMUNICATION_ERROR, "Invalid Lun");
     }
 
     reader_status_t r = reader_is_present(reader);
+
+    reader_list_release_reader(reader);
+
     if (r == reader_status_reader_not_found) {
         LOG_INFO_RETURN_IFD(IFD_ICC_NOT_PRESENT);
     } else if (r != reader_status_ok) {
@@ -286,14 +513,76 @@ static RESPONSECODE doIFDHICCPresence(DWORD Lun) {
 }
 
 RESPONSECODE IFDHICCPresence(DWORD Lun) {
-    log_level_t currentLogLevel = log_get_log_level();
-    if ((currentLogLevel & LOG_LEVEL_PERIODIC) != LOG_LEVEL_PERIODIC) {
-        log_set_log_level(LOG_LEVEL_CRITICAL);
+    // Presence is polled periodically, its log is suppressed for the polling
+    // thread only, the other Luns keep logging while it is polled
+    if ((log_get_log_level() & LOG_LEVEL_PERIODIC) != LOG_LEVEL_PERIODIC) {
+        log_set_thread_log_level(LOG_LEVEL_CRITICAL);
     }
 
     RESPONSECODE r = doIFDHICCPresence(Lun);
 
-    log_set_log_level(currentLogLevel);
+    log_reset_thread_log_level();
 
     return r;
 }
+
+static RESPONSECODE doIFDHPollCardEvent(DWORD Lun, int timeout) {
+    LOG_INFO("Lun: %lu, timeout: %d", Lun, timeout);
+
+    Reader* reader = reader_list_acquire_reader(Lun);
+    if (!reader) {
+        LOG_ERROR_RETURN_IFD(IFD_NO_SUCH_DEVICE, "Invalid Lun");
+    }
+
+    reader_presence_watch_t watch;
+    reader_status_t r = reader_watch_presence(reader, &watch);
+
+    // The reader is not held while waiting, so the other calls on the Lun are not blocked
+    reader_list_release_reader(reader);
+
+    if (r != reader_status_ok) {
+        LOG_ERROR_RETURN_IFD(IFD_COMMUNICATION_ERROR, "reader_watch_presence failed: %d", r);
+    }
+
+    // A negative timeout is an infinite wait, the polling thread is stopped by IFDHStopPolling then
+    r = reader_wait_presence_change(&watch, timeout < 0 ? HW_WAIT_INFINITE : (uint32_t)timeout);
+    if (r == reader_status_timeout) {
+        LOG_INFO_RETURN_IFD(IFD_SUCCESS);
+    } else if (r != reader_status_ok) {
+        LOG_ERROR_RETURN_IFD(IFD_COMMUNICATION_ERROR, "reader_wait_presence_change failed: %d", r);
+    }
+
+    LOG_INFO_RETURN_IFD(IFD_SUCCESS);
+}
+
+// pcscd polling thread calls it in a loop and checks the presence with IFDHICCPresence once it returns
+static RESPONSECODE IFDHPollCardEvent(DWORD Lun, int timeout) {
+    if ((log_get_log_level() & LOG_LEVEL_PERIODIC) != LOG_LEVEL_PERIODIC) {
+        log_set_thread_log_level(LOG_LEVEL_CRITICAL);
+    }
+
+    RESPONSECODE r = doIFDHPollCardEvent(Lun, timeout);
+
+    log_reset_thread_log_level();
+
+    return r;
+}
+
+static RESPONSECODE IFDHStopPolling(DWORD Lun) {
+    LOG_INFO("Lun: %lu", Lun);
+
+    Reader* reader = reader_list_acquire_reader(Lun);
+    if (!reader) {
+        LOG_ERROR_RETURN_IFD(IFD_COMMUNICATION_ERROR, "Invalid Lun");
+    }
+
+    reader_status_t r = reader_cancel_presence_wait(reader);
+
+    reader_list_release_reader(reader);
+
+    if (r != reader_status_ok) {
+        LOG_ERROR_RETURN_IFD(IFD_COMMUNICATION_ERROR, "reader_cancel_presence_wait failed: %d", r);
+    }
+
+    LOG_INFO_RETURN_IFD(IFD_SUCCESS);
+}
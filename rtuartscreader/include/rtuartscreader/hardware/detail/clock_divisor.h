@@ -0,0 +1,28 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// gpioHardwareClock of pigpio divides each of its clock sources, the oscillator and PLLD,
+// by the divisor rounded to the nearest 1/4096 (to the nearest integer from 23.8 MHz),
+// and takes the source giving the frequency closest to the requested one, the later
+// source on a tie. It returns that frequency, 0 if no source can be divided to it.
+double hw_gpclk_generated(const uint32_t* sources, size_t count, uint32_t request);
+
+// The highest frequency to request from gpioHardwareClock which makes it generate
+// no more than frequency, 0 if there is none. The generated frequency is within 1 Hz
+// of the request.
+uint32_t hw_gpclk_request(const uint32_t* sources, size_t count, uint32_t frequency);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,39 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#pragma once
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <rtuartscreader/hardware/hardware.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Waiters for a card detect line, the backend notifies them once the line changes
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    bool cancelled; // until the line is reset
+} hw_detect_line_t;
+
+typedef hw_status_t (*hw_detect_line_read_t)(const hw_config_t* config, bool* present);
+
+void hw_detect_line_initialize(hw_detect_line_t* line);
+void hw_detect_line_reset(hw_detect_line_t* line);
+void hw_detect_line_notify(hw_detect_line_t* line);
+void hw_detect_line_cancel(hw_detect_line_t* line);
+// Blocks until read reports the line differs from present (hw_status_ok), the wait is
+// cancelled (hw_status_cancelled) or timeout_ms expires (hw_status_timeout). The line
+// is read under the lock, so a notification coming after the read wakes the wait.
+hw_status_t hw_detect_line_wait(hw_detect_line_t* line, const hw_config_t* config, hw_detect_line_read_t read,
+                                bool present, uint32_t timeout_ms);
+
+#ifdef __cplusplus
+}
+#endif
@@ -3,11 +3,23 @@
 // BSD license. See the LICENSE file found in the top-level directory of this
 // distribution.
 
-DEFINE_FUNCTION(hw_status_t, hw_initialize)
-DEFINE_FUNCTION(hw_status_t, hw_start_clock, uint32_t)
-DEFINE_FUNCTION(hw_status_t, hw_stop_clock)
-DEFINE_FUNCTION(hw_status_t, hw_rst_initialize)
-DEFINE_FUNCTION(hw_status_t, hw_rst_down)
-DEFINE_FUNCTION(hw_status_t, hw_rst_down_up, uint32_t)
-DEFINE_FUNCTION(hw_status_t, hw_rst_deinitialize)
+DEFINE_FUNCTION(hw_status_t, hw_initialize, const hw_config_t*)
+DEFINE_FUNCTION(uint32_t, hw_clock_frequency, const hw_config_t*, uint32_t)
+DEFINE_FUNCTION(hw_status_t, hw_start_clock, const hw_config_t*, uint32_t)
+DEFINE_FUNCTION(hw_status_t, hw_stop_clock, const hw_config_t*)
+DEFINE_FUNCTION(hw_status_t, hw_rst_initialize, const hw_config_t*)
+DEFINE_FUNCTION(hw_status_t, hw_rst_down, const hw_config_t*)
+DEFINE_FUNCTION(hw_status_t, hw_rst_down_up, const hw_config_t*, uint32_t)
+DEFINE_FUNCTION(hw_status_t, hw_rst_deinitialize, const hw_config_t*)
+DEFINE_FUNCTION(hw_status_t, hw_detect_initialize, const hw_config_t*)
+DEFINE_FUNCTION(hw_status_t, hw_detect_read, const hw_config_t*, bool*)
+DEFINE_FUNCTION(hw_status_t, hw_detect_wait, const hw_config_t*, bool, uint32_t)
+DEFINE_FUNCTION(hw_status_t, hw_detect_cancel, const hw_config_t*)
+DEFINE_FUNCTION(hw_status_t, hw_detect_deinitialize, const hw_config_t*)
+DEFINE_FUNCTION(uint32_t, hw_serial_max_baudrate, const hw_config_t*)
+DEFINE_FUNCTION(hw_status_t, hw_serial_open, const hw_config_t*, uint32_t)
+DEFINE_FUNCTION(hw_status_t, hw_serial_write, const hw_config_t*, uint32_t, uint32_t, hw_parity_t, const uint8_t*, size_t)
+DEFINE_FUNCTION(hw_status_t, hw_serial_read, const hw_config_t*, hw_parity_t, uint8_t*, size_t, size_t*)
+DEFINE_FUNCTION(hw_status_t, hw_serial_flush, const hw_config_t*)
+DEFINE_FUNCTION(hw_status_t, hw_serial_close, const hw_config_t*)
 DEFINE_FUNCTION(void, hw_deinitialize)
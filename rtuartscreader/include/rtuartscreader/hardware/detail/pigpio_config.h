@@ -0,0 +1,19 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#pragma once
+
+#include <pigpio/pigpio.h>
+
+#define HW_PIGPIO_INTERNALS PI_CFG_NOSIGHANDLER
+
+// The pipe and the socket interfaces are always disabled. The alert thread calls
+// the card detect callbacks, applies their glitch filter and samples the I/O line
+// for gpioSerialRead; it wakes up every millisecond, so it runs only if a reader
+// needs it.
+#define HW_PIGPIO_INTERFACES(alerts) (PI_DISABLE_FIFO_IF | PI_DISABLE_SOCK_IF | ((alerts) ? 0 : PI_DISABLE_ALERT))
+
+// Readers with a card detect line or with the I/O line on a GPIO need the alert thread
+#define HW_PIGPIO_NEEDS_ALERTS(config) ((config)->has_detect_pin || (config)->has_io_pin)
@@ -5,13 +5,52 @@
 
 #pragma once
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 typedef enum {
     hw_status_ok = 0,
-    hw_status_failed
+    hw_status_failed,
+    hw_status_timeout,
+    hw_status_cancelled
 } hw_status_t;
 
+typedef enum {
+    hw_clock_pwm = 0, // 50% duty cycle of a hardware PWM channel
+    hw_clock_gpclk    // general purpose clock with an integer divider, free of the divider jitter
+} hw_clock_source_t;
+
+typedef enum {
+    hw_parity_even = 0,
+    hw_parity_odd,    // of inverse convention characters as they are on the line
+    hw_parity_ignored // the received characters are not checked, even parity is sent
+} hw_parity_t;
+
+#define HW_DEFAULT_RST_PIN 17
+#define HW_DEFAULT_CLOCK_PIN 18
+
+// GPIOs the card of a single reader is wired to
+typedef struct {
+    unsigned rst_pin;
+    unsigned clock_pin; // hardware PWM or GPCLK capable GPIO, it selects the channel as well
+    hw_clock_source_t clock_source;
+    bool has_detect_pin; // there is no card detect line if the card is soldered
+    unsigned detect_pin;
+    bool detect_active_low;
+    bool has_io_pin; // the I/O line is driven by GPIO waveforms instead of UART
+    unsigned io_pin;
+} hw_config_t;
+
+// hw_detect_wait timeout without a deadline
+#define HW_WAIT_INFINITE UINT32_MAX
+
+// The serial functions run ISO 7816-3 characters (start bit, 8 data bits, parity bit,
+// 2 ETU of guard time) over the I/O GPIO at the given baud rate. hw_serial_write sends
+// the characters extra guard time (us) apart and returns once they are over, their
+// echo is received as the I/O line is shared. hw_serial_read does not wait, it takes
+// the characters received so far, and fails on the character with wrong parity.
+// hw_serial_max_baudrate is the fastest baud rate hw_serial_open accepts.
 #define PIMPL_NAME_PREFIX hw
 #define PIMPL_FUNCTIONS_DECLARATION_PATH <rtuartscreader/hardware/detail/hardware_functions.h>
 #include <rtuartscreader/pimpl/header.h>
@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include <stddef.h>
 #include <stdint.h>
 
 #include <rtuartscreader/iso7816_3/status.h>
@@ -14,8 +15,9 @@
 extern "C" {
 #endif
 
-iso7816_3_status_t t0_transmit_apdu(const transport_t* transport, const uint8_t* tx_buf, uint16_t tx_len,
-                                    uint8_t* rx_buf, uint16_t* rx_len);
+// Extended APDUs are transmitted with ENVELOPE and GET RESPONSE commands
+iso7816_3_status_t t0_transmit_apdu(const transport_t* transport, const uint8_t* tx_buf, size_t tx_len,
+                                    uint8_t* rx_buf, size_t* rx_len);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,41 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <rtuartscreader/iso7816_3/atr_info.h>
+#include <rtuartscreader/iso7816_3/status.h>
+#include <rtuartscreader/transport/transport_t.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define T1_MAX_IFS 254
+
+// Block protocol state, valid between card resets
+typedef struct t1_context {
+    uint8_t ns; // N(S) of the next I-block to send
+    uint8_t nr; // N(S) expected in the next I-block from the card
+    uint8_t ifsc;
+    uint8_t ifsd;
+    bool use_crc;
+} t1_context_t;
+
+void t1_context_init(t1_context_t* context, const t1_params_t* params);
+
+// Informs the card that the interface device accepts blocks with up to ifsd bytes of information
+iso7816_3_status_t t1_negotiate_ifsd(const transport_t* transport, t1_context_t* context, uint8_t ifsd);
+
+iso7816_3_status_t t1_transmit_apdu(const transport_t* transport, t1_context_t* context, const uint8_t* tx_buf,
+                                    size_t tx_len, uint8_t* rx_buf, size_t* rx_len);
+
+#ifdef __cplusplus
+}
+#endif
@@ -8,10 +8,8 @@
 #include <stdbool.h>
 #include <stdint.h>
 
-#include <PCSC/ifdhandler.h>
-
+#include <rtuartscreader/iso7816_3/atr_info.h>
 #include <rtuartscreader/iso7816_3/detail/utils.h>
-#include <rtuartscreader/iso7816_3/f_d_index.h>
 #include <rtuartscreader/iso7816_3/status.h>
 #include <rtuartscreader/transport/transport_t.h>
 
@@ -19,16 +17,16 @@
 extern "C" {
 #endif
 
-#define PROTOCOL_T0 0
-#define PROTOCOL_T1 1
-#define MAX_PROTOCOL_VALUE 15
+// TS values after decoding, ATR keeps TS decoded as well
+#define ATR_TS_DIRECT 0x3B
+#define ATR_TS_INVERSE 0x3F
 
-#define MAX_INTERFACE_BYTES_COUNT (MAX_ATR_SIZE - 3) // Anything except T0 & TCK
+#define MAX_INTERFACE_BYTES_COUNT (ATR_MAX_SIZE - 3) // Anything except T0 & TCK
 
-// All offset fields have values in between 0..MAX_ATR_SIZE
+// All offset fields have values in between 0..ATR_MAX_SIZE
 // or BAD_ATR_OFFSET, if there is no such byte in ATR
 typedef struct atr {
-    uint8_t atr[MAX_ATR_SIZE];
+    uint8_t atr[ATR_MAX_SIZE];
     size_t atr_len;
     uint8_t t0_offset;
     uint8_t ta_offset[MAX_INTERFACE_BYTES_COUNT];
@@ -40,37 +38,6 @@ typedef struct atr {
     uint8_t tck_offset;
 } atr_t;
 
-typedef struct ta1 {
-    bool is_present;
-    f_d_index_t f_d;
-} ta1_t;
-
-typedef struct ta2 {
-    bool is_present;
-    bool can_change_mode;
-    bool use_implicit_f_d;
-    uint8_t enforced_protocol;
-} ta2_t;
-
-typedef struct tc1 {
-    bool is_present;
-    uint8_t n;
-} tc1_t;
-
-typedef struct tc2 {
-    bool is_present;
-    uint8_t wi;
-} tc2_t;
-
-typedef struct atr_info {
-    ta1_t ta1;
-    tc1_t tc1;
-    ta2_t ta2;
-    tc2_t tc2;
-
-    bool explicit_protocols[MAX_PROTOCOL_VALUE + 1];
-} atr_info_t;
-
 iso7816_3_status_t read_atr(const transport_t* transport, atr_t* info);
 
 iso7816_3_status_t parse_atr(const atr_t* atr, atr_info_t* info);
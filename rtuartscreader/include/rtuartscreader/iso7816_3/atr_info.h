@@ -0,0 +1,63 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <rtuartscreader/iso7816_3/f_d_index.h>
+
+#define ATR_MAX_SIZE 33 // TS and up to 32 characters, ISO 7816-3 8.2.1
+
+#define PROTOCOL_T0 0
+#define PROTOCOL_T1 1
+#define MAX_PROTOCOL_VALUE 15
+
+#define T1_DEFAULT_IFS 32
+#define T1_DEFAULT_CWI 13
+#define T1_DEFAULT_BWI 4
+
+typedef struct ta1 {
+    bool is_present;
+    f_d_index_t f_d;
+} ta1_t;
+
+typedef struct ta2 {
+    bool is_present;
+    bool can_change_mode;
+    bool use_implicit_f_d;
+    uint8_t enforced_protocol;
+} ta2_t;
+
+typedef struct tc1 {
+    bool is_present;
+    uint8_t n;
+} tc1_t;
+
+typedef struct tc2 {
+    bool is_present;
+    uint8_t wi;
+} tc2_t;
+
+// Taken from the first TA, TB and TC following the first TD_i (i > 1) indicating T=1,
+// hold default values if the bytes are absent
+typedef struct t1_params {
+    uint8_t ifsc;
+    uint8_t cwi;
+    uint8_t bwi;
+    bool use_crc;
+} t1_params_t;
+
+typedef struct atr_info {
+    bool inverse_convention;
+    ta1_t ta1;
+    tc1_t tc1;
+    ta2_t ta2;
+    tc2_t tc2;
+    t1_params_t t1;
+
+    bool explicit_protocols[MAX_PROTOCOL_VALUE + 1];
+} atr_info_t;
@@ -0,0 +1,37 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#pragma once
+
+#include <stdint.h>
+
+#define APDU_HEADER_SIZE 5
+
+#define APDU_CLA_OFFSET 0
+#define APDU_INS_OFFSET 1
+#define APDU_P3_OFFSET 4
+
+#define APDU_MAX_NC_VALUE 0xff
+#define APDU_MAX_NE_VALUE 0x100
+
+#define APDU_INS_ENVELOPE 0xc2
+#define APDU_INS_GET_RESPONSE 0xc0
+
+#define SW1_OK 0x90
+#define SW2_OK 0x00
+#define SW1_RESPONSE_BYTES_AVAILABLE 0x61
+#define SW1_WRONG_LENGTH 0x6c
+
+static inline uint16_t le_to_ne(uint8_t le) {
+    if (le == 0x00) return APDU_MAX_NE_VALUE;
+    return le;
+}
+
+// GET RESPONSE keeps the logical channel of the command only
+static inline uint8_t get_response_cla(uint8_t cla) {
+    if (cla & 0x80) return 0x00;
+    if (cla & 0x40) return cla & 0x4f;
+    return cla & 0x03;
+}
@@ -25,4 +25,8 @@ uint32_t d_by_index(uint8_t index);
 iso7816_3_status_t compute_extra_gt(uint32_t f, uint32_t d, const atr_info_t* atr_info, uint32_t freq,
                                     uint32_t* extra_gt_us);
 
-iso7816_3_status_t compute_wt(const atr_info_t* atr_info, uint32_t freq, double* wt);
\ No newline at end of file
+iso7816_3_status_t compute_wt(const atr_info_t* atr_info, uint32_t freq, double* wt);
+
+iso7816_3_status_t compute_bwt(uint32_t f, uint32_t d, const atr_info_t* atr_info, uint32_t freq, double* bwt);
+
+iso7816_3_status_t compute_cwt(uint32_t f, uint32_t d, const atr_info_t* atr_info, uint32_t freq, double* cwt);
\ No newline at end of file
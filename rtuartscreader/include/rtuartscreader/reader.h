@@ -5,8 +5,15 @@
 
 #pragma once
 
+#include <stdbool.h>
+#include <stdint.h>
+
 #include <PCSC/ifdhandler.h>
 
+#include <rtuartscreader/hardware/hardware.h>
+#include <rtuartscreader/reader_stats.h>
+#include <rtuartscreader/transport/transport_t.h>
+
 typedef struct reader_st Reader;
 
 typedef enum {
@@ -16,9 +23,22 @@ typedef enum {
     reader_status_memory_error,
     reader_status_communication_error,
     reader_status_internal_error,
-    reader_status_timeout
+    reader_status_timeout,
+    reader_status_not_supported
 } reader_status_t;
 
+// How the card is probed by reader_is_present while it is not powered, if there is no card detect line
+typedef enum {
+    reader_presence_probe_reset = 0, // full reset with PPS, the card is ready for the exchange
+    reader_presence_probe_atr        // reset and ATR only, the card is negotiated on power up
+} reader_presence_probe_t;
+
+// Snapshot of the card detect line taken under the reader lock, it is waited on without the lock
+typedef struct {
+    hw_config_t hw;
+    bool present; // line state at the last presence check
+} reader_presence_watch_t;
+
 reader_status_t reader_open(Reader* reader, const char* readerName);
 reader_status_t reader_close(Reader* reader);
 reader_status_t reader_get_atr(Reader const* reader, UCHAR const** atr, DWORD* length);
@@ -28,3 +48,17 @@ reader_status_t reader_reset(Reader* reader, UCHAR const** atr, DWORD* length);
 reader_status_t reader_transmit(Reader* reader, UCHAR const* txBuffer, DWORD txLength, UCHAR* rxBuffer, PDWORD rxLength);
 reader_status_t reader_is_present(Reader* reader);
 reader_status_t reader_is_powered(const Reader* reader);
+// SCARD_PROTOCOL_T0 or SCARD_PROTOCOL_T1 negotiated during the last reset of the powered card
+reader_status_t reader_get_protocol(const Reader* reader, DWORD* protocol);
+// ttl_ms: a successful probe result is reused for that long, 0 to probe every time
+reader_status_t reader_set_presence_probe(Reader* reader, reader_presence_probe_t probe, uint32_t ttl_ms);
+reader_status_t reader_watch_presence(const Reader* reader, reader_presence_watch_t* watch);
+// timeout_ms: HW_WAIT_INFINITE to wait until the line changes or the wait is cancelled
+reader_status_t reader_wait_presence_change(const reader_presence_watch_t* watch, uint32_t timeout_ms);
+reader_status_t reader_cancel_presence_wait(const Reader* reader);
+reader_status_t reader_set_auto_get_response(Reader* reader, bool enabled);
+reader_status_t reader_get_auto_get_response(const Reader* reader, bool* enabled);
+reader_status_t reader_get_atr_cache_stats(const Reader* reader, uint32_t* hits, uint32_t* misses);
+reader_status_t reader_get_reconfig_stats(const Reader* reader, transport_reconfig_stats_t* stats);
+// May be called without the reader lock, while the reader is in use by another thread
+reader_status_t reader_get_stats(const Reader* reader, reader_stats_t* stats);
@@ -5,8 +5,16 @@
 
 #pragma once
 
+#include <stdbool.h>
+#include <stdint.h>
+
 #include <PCSC/ifdhandler.h>
 
+#include <rtuartscreader/iso7816_3/apdu_t1.h>
+#include <rtuartscreader/iso7816_3/atr_info.h>
+#include <rtuartscreader/reader.h>
+#include <rtuartscreader/reader_stats.h>
+#include <rtuartscreader/transport/atr_cache.h>
 #include <rtuartscreader/transport/transport_t.h>
 
 typedef enum reader_power_state_enum {
@@ -22,7 +30,17 @@ typedef enum reader_card_presence_enum {
 struct reader_st {
     POWER_STATE power;
     CARD_PRESENCE presence;
+    bool cardDetected; // card detect line state at the last presence check
+    reader_presence_probe_t presenceProbe;
+    uint32_t presenceTtlMs;
+    uint64_t presenceCheckedMs; // monotonic time of the last successful probe
     UCHAR atr[MAX_ATR_SIZE];
     DWORD atrLength;
     transport_t transport;
+    atr_cache_t atrCache; // of the transport
+    atr_info_t atrInfo;   // of the transport
+    t1_context_t t1;
+    bool autoGetResponse;
+    reader_stats_t stats; // updated lock-free, see reader_get_stats
+    uint64_t latencyProbedUs; // monotonic time of the last scheduling latency probe
 };
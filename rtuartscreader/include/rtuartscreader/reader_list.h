@@ -5,12 +5,26 @@
 
 #pragma once
 
+#include <stdbool.h>
+
 #include <PCSC/wintypes.h>
 
+#include <rtuartscreader/hardware/hardware.h>
 #include <rtuartscreader/reader.h>
+#include <rtuartscreader/reader_stats.h>
 
+// Reader returned by alloc and acquire is locked for the calling thread,
+// every other thread asking for the same Lun waits until the reader is
+// released. Different Luns are served concurrently.
 Reader* reader_list_alloc_reader(DWORD lun);
-Reader* reader_list_get_reader(DWORD lun);
-void reader_list_free_reader(DWORD lun);
+Reader* reader_list_acquire_reader(DWORD lun);
+void reader_list_release_reader(Reader* reader);
+// Reserves the RST and clock GPIOs of config for the reader acquired by the calling
+// thread until it is freed, false if another reader uses any of them
+bool reader_list_reserve_gpios(Reader* reader, const hw_config_t* config);
+// Frees the reader acquired by the calling thread, the reader is released
+void reader_list_free_reader(Reader* reader);
+// Takes the statistics without waiting for the reader, false if Lun is not found
+bool reader_list_get_stats(DWORD lun, reader_stats_t* stats);
 
 enum { gReaderListSize = 32 };
@@ -0,0 +1,50 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <PCSC/ifdhandler.h>
+
+#include <rtuartscreader/reader.h>
+
+// APDU script run by a single SCardControl call. Multibyte fields are 16-bit
+// in host byte order.
+//
+// Script: policy byte followed by the steps
+//   step: APDU length, expected SW, SW mask, APDU
+//
+// Output: number of the steps run followed by their results
+//   result: step status byte, response length, response
+//
+// The step SW matches if (SW & mask) == (expected & mask), so the zero mask
+// accepts any response. The script stops on the transmit error, and on the
+// mismatch with the abort policy.
+//
+// If the output is filled up, the script stops and its last result has the
+// output truncated status with no response. The APDU of that step may have
+// been sent to the card.
+
+typedef enum {
+    reader_script_continue_on_mismatch = 0,
+    reader_script_abort_on_mismatch
+} reader_script_policy_t;
+
+typedef enum {
+    reader_script_step_ok = 0,
+    reader_script_step_sw_mismatch,
+    reader_script_step_transmit_error,
+    reader_script_step_output_truncated
+} reader_script_step_status_t;
+
+#define READER_SCRIPT_STEP_HEADER_SIZE 6
+#define READER_SCRIPT_RESULT_HEADER_SIZE 3
+#define READER_SCRIPT_MAX_STEPS UINT16_MAX
+
+// Longer scripts are rejected as malformed. reader_status_memory_error if the
+// output can not hold even the number of steps and a truncated result.
+reader_status_t reader_run_script(Reader* reader, UCHAR const* script, DWORD scriptLength, UCHAR* output,
+                                  PDWORD outputLength);
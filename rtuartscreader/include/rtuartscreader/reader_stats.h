@@ -0,0 +1,33 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#pragma once
+
+#include <stdint.h>
+
+#define READER_STATS_VERSION 2
+#define READER_STATS_BUCKETS 32
+
+// Statistics of a reader since its channel was created, 32-bit counters in
+// host byte order wrapping around on overflow. Bucket i of a histogram counts
+// operations which took [2^i, 2^(i+1)) microseconds, the first bucket also
+// counts shorter ones and the last one all longer ones.
+typedef struct {
+    uint32_t version; // READER_STATS_VERSION, the layout is only extended at the end
+    uint32_t apdus; // GET RESPONSE and 6CXX repetitions sent by the driver included
+    uint32_t bytes_sent;
+    uint32_t bytes_received;
+    uint32_t resets;   // resets followed by the negotiation, presence probes included
+    uint32_t timeouts; // characters not received within the waiting time
+    uint32_t transmit_us[READER_STATS_BUCKETS]; // whole SCardTransmit() calls
+    uint32_t reset_us[READER_STATS_BUCKETS]; // ATR and PPS included
+    uint32_t pps_us[READER_STATS_BUCKETS];   // only resets with the PPS exchange
+    // version 2
+    uint32_t sched_latency_us[READER_STATS_BUCKETS]; // wake-up latency in real-time mode, sampled once a minute
+} reader_stats_t;
+
+void reader_stats_record_us(uint32_t histogram[READER_STATS_BUCKETS], uint64_t us);
+// Copies the counters updated concurrently, each one is consistent on its own
+void reader_stats_snapshot(const reader_stats_t* stats, reader_stats_t* snapshot);
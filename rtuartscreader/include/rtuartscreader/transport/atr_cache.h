@@ -0,0 +1,48 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <rtuartscreader/iso7816_3/atr_info.h>
+#include <rtuartscreader/iso7816_3/f_d_index.h>
+#include <rtuartscreader/transport/transport_t.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Outcome of the negotiation with the card identified by its ATR
+typedef struct atr_cache_entry {
+    bool is_valid;
+    uint8_t atr[ATR_MAX_SIZE];
+    size_t atr_len;
+    atr_info_t info;
+    uint8_t protocol;
+    f_d_index_t f_d_index;     // requested with PPS
+    bool pps_use_default_f_d; // the card answered PPS without PPS1
+    transmit_params_t params; // for the F & D the card agreed to
+} atr_cache_entry_t;
+
+#define ATR_CACHE_SIZE 4
+
+typedef struct atr_cache {
+    atr_cache_entry_t entries[ATR_CACHE_SIZE];
+    size_t next; // entry replaced by the next miss
+    uint32_t hits;
+    uint32_t misses;
+} atr_cache_t;
+
+// Returns the entry of the ATR or NULL, counts a hit or a miss
+const atr_cache_entry_t* atr_cache_find(atr_cache_t* cache, const uint8_t* atr, size_t atr_len);
+// Replaces the entry of the same ATR or the oldest one
+void atr_cache_store(atr_cache_t* cache, const atr_cache_entry_t* entry);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,22 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Converts the characters between the direct convention of UART and the inverse one
+// in place: the bits of every byte are reversed and inverted. The conversion is its
+// own inverse, so it both encodes and decodes.
+void transport_convert_inverse(uint8_t* bytes, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,21 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <rtuartscreader/transport/status.h>
+#include <rtuartscreader/transport/transport_t.h>
+
+// The GPIOs of the reader are set up the same way whatever drives the I/O line
+
+// Initializes the hardware, RST, the clock at the frequency of transport->params and the card detect line
+transport_status_t transport_hw_initialize(transport_t* transport);
+
+transport_status_t transport_hw_deinitialize(const transport_t* transport);
+
+// The running clock changes its frequency in place, it is not touched if the frequency is the same
+transport_status_t transport_hw_reconfigure_clock(transport_t* transport, uint32_t freq);
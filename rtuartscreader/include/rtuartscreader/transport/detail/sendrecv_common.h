@@ -0,0 +1,33 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <rtuartscreader/transport/status.h>
+#include <rtuartscreader/transport/transport_t.h>
+
+// Primitives a sendrecv engine provides to the common send/receive logic.
+typedef struct transport_io {
+    // Receive exactly len bytes, waiting at most wt_us for every character
+    transport_status_t (*read)(const transport_t* transport, uint8_t* buf, size_t len, uint32_t wt_us);
+    // Send the bytes, NULL if they are written to the serial port handle
+    transport_status_t (*write)(const transport_t* transport, const uint8_t* bytes, size_t len);
+    // write puts extra guard time between the characters itself, so they are sent in bulk,
+    // otherwise they are sent one by one and transport_io_wait_extra_gt() is waited in between
+    bool write_applies_extra_gt;
+} transport_io_t;
+
+// Waits for the end of the character, which echo has just been received, and extra guard time after it
+void transport_io_wait_extra_gt(const transport_t* transport);
+
+// Every character is awaited for wt_us: WT, or CWT for the characters following the first one of a T=1 block
+transport_status_t transport_io_recv_bytes(const transport_io_t* io, const transport_t* transport, uint8_t* buf, size_t len,
+                                           uint32_t wt_us);
+
+transport_status_t transport_io_send_bytes(const transport_io_t* io, const transport_t* transport, const uint8_t* bytes, size_t len);
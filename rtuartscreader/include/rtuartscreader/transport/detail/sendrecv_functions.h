@@ -6,4 +6,5 @@
 DEFINE_FUNCTION(transport_status_t, transport_recv_byte, const transport_t*, uint8_t*)
 DEFINE_FUNCTION(transport_status_t, transport_send_byte, const transport_t*, uint8_t)
 DEFINE_FUNCTION(transport_status_t, transport_recv_bytes, const transport_t*, uint8_t*, size_t)
+DEFINE_FUNCTION(transport_status_t, transport_recv_block_bytes, const transport_t*, uint8_t*, size_t)
 DEFINE_FUNCTION(transport_status_t, transport_send_bytes, const transport_t*, const uint8_t*, size_t)
@@ -0,0 +1,22 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <rtuartscreader/transport/status.h>
+
+// Sets an arbitrary baud rate, not limited to the Bxxx constants of termios.
+// The other settings of the port are kept.
+transport_status_t set_serial_speed(int handle, uint32_t baudrate);
+
+// Puts the port into raw mode with 8 data bits, a parity bit and 2 stop bits, VMIN = 0
+// and VTIME = wt_ds at an arbitrary baud rate, all in one call
+transport_status_t set_serial_settings(int handle, uint32_t baudrate, bool odd_parity, uint8_t wt_ds);
+
+// Output baud rate of the port, whichever way it has been set
+transport_status_t get_serial_speed(int handle, uint32_t* baudrate);
@@ -13,6 +13,10 @@ extern "C" {
 
 const transmit_params_t* transmit_params_default();
 
+// Parameters of the answer to reset (F = 372, D = 1, WT = 9600 etu) with the clock
+// running at freq, the default ones at the default frequency or if the clock is stopped
+void transmit_params_for_atr(uint32_t freq, transmit_params_t* params);
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
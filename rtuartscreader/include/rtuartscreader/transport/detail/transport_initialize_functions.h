@@ -6,3 +6,4 @@
 DEFINE_FUNCTION(transport_status_t, transport_initialize, transport_t*, const char*)
 DEFINE_FUNCTION(transport_status_t, transport_reinitialize, transport_t*, const transmit_params_t*)
 DEFINE_FUNCTION(transport_status_t, transport_deinitialize, const transport_t*)
+DEFINE_FUNCTION(uint32_t, transport_max_baudrate, const transport_t*)
@@ -0,0 +1,23 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#pragma once
+
+#include <stddef.h>
+
+#include <rtuartscreader/hardware/hardware.h>
+#include <rtuartscreader/transport/status.h>
+#include <rtuartscreader/utils/realtime_config.h>
+
+// DEVICENAME is the serial port path optionally followed by the GPIOs of the reader:
+// /dev/ttyAMA0[:rst=<gpio>][:clk=<gpio>|:gpclk=<gpio>][:det=<gpio>|:ndet=<gpio>][:io=<gpio>][:rt=<priority>][:cpu=<cpu>]
+// The GPIOs which are not specified are set to the defaults. The card is clocked by
+// hardware PWM (clk) or by a GPCLK generator (gpclk). The card detect line is high (det)
+// or low (ndet) while the card is inserted, there is none by default.
+// The wave engine drives the I/O line of the card with GPIO io=<gpio> instead of the serial port.
+// The exchange may be run in real-time mode: rt=<SCHED_FIFO priority>, cpu=<cpu to pin to>.
+// Only the trailing segments starting with these keys are options, the path itself may contain ':'.
+transport_status_t parse_device_name(const char* device_name, char* path, size_t path_size, hw_config_t* config,
+                                     realtime_config_t* realtime);
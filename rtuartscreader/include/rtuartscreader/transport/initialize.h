@@ -8,6 +8,9 @@
 #include <rtuartscreader/transport/status.h>
 #include <rtuartscreader/transport/transport_t.h>
 
+// PL011 UART of Raspberry Pi clocked at 48 MHz divides its clock by 16 at least
+#define TRANSPORT_TTY_MAX_BAUDRATE 3000000
+
 #define PIMPL_NAME_PREFIX transport_initialize
 #define PIMPL_FUNCTIONS_DECLARATION_PATH <rtuartscreader/transport/detail/transport_initialize_functions.h>
 #include <rtuartscreader/pimpl/header.h>
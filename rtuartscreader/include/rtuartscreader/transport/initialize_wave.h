@@ -0,0 +1,21 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#pragma once
+
+#include <rtuartscreader/transport/initialize.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Alternative initialization for transport_sendrecv_wave_impl(): the serial port
+// is not opened, the I/O line is the GPIO set with io=<gpio> in the device name.
+// Install it with transport_initialize_impl_set().
+const transport_initialize_impl_t* transport_initialize_wave_impl();
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,29 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <rtuartscreader/hardware/hardware.h>
+#include <rtuartscreader/transport/status.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Card detect line is available if its GPIO is set in DEVICENAME. The functions
+// take the hardware config only, so they may be called without the transport.
+bool transport_has_card_detect(const hw_config_t* hw);
+transport_status_t transport_detect_card(const hw_config_t* hw, bool* present);
+// Blocks until the detect line differs from present, the wait is cancelled
+// (transport_status_ok in both cases) or timeout_ms expires, HW_WAIT_INFINITE waits without a deadline
+transport_status_t transport_wait_card_change(const hw_config_t* hw, bool present, uint32_t timeout_ms);
+transport_status_t transport_cancel_card_wait(const hw_config_t* hw);
+
+#ifdef __cplusplus
+}
+#endif
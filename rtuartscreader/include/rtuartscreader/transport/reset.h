@@ -16,6 +16,12 @@ extern "C" {
 #endif
 
 transport_status_t transport_reset(transport_t* transport, uint8_t atr_buffer[], size_t* atr_len);
+// Toggles RST only: the clock keeps running and the serial port is not set up
+// again unless its settings change, so the card must be already powered
+transport_status_t transport_warm_reset(transport_t* transport, uint8_t atr_buffer[], size_t* atr_len);
+// Resets the card and reads its ATR only, the card is left at the default
+// transmission parameters and needs transport_reset before the exchange
+transport_status_t transport_probe_atr(transport_t* transport, uint8_t atr_buffer[], size_t* atr_len);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,21 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#pragma once
+
+#include <rtuartscreader/transport/sendrecv.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Alternative sendrecv implementation, which waits for the card with ppoll()
+// and so applies WT with microsecond precision instead of VTIME deciseconds.
+// Install it with transport_sendrecv_impl_set().
+const transport_sendrecv_impl_t* transport_sendrecv_poll_impl();
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,21 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#pragma once
+
+#include <rtuartscreader/transport/sendrecv.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Alternative sendrecv implementation, which drives the I/O GPIO of the card with
+// DMA-timed waveforms and samples it instead of the serial port, so ETU and extra
+// guard time are exact at any baud rate. It goes with transport_initialize_wave_impl().
+const transport_sendrecv_impl_t* transport_sendrecv_wave_impl();
+
+#ifdef __cplusplus
+}
+#endif
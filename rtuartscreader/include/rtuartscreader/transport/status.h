@@ -14,7 +14,8 @@ typedef enum {
     transport_status_iso7816_3_error,
     transport_status_invalid_atr,
     transport_status_mode_not_supported,
-    transport_status_need_reset
+    transport_status_need_reset,
+    transport_status_invalid_device_name
 } transport_status_t;
 
 const char* transport_status_to_string(transport_status_t status);
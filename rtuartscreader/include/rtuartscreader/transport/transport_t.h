@@ -5,24 +5,60 @@
 
 #pragma once
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
-#include <termios.h>
+#include <rtuartscreader/hardware/hardware.h>
+#include <rtuartscreader/utils/realtime_config.h>
+
+// Defined by the layers above: ATR parsing and its negotiation outcomes
+struct atr_info;
+struct atr_cache;
 
 typedef struct transmit_speed {
     uint32_t freq;
-    speed_t baudrate;
+    uint32_t baudrate; // bit/s, not limited to the Bxxx constants of termios
 } transmit_speed_t;
 
+// Inverse convention characters are sent and received with bits reversed and inverted,
+// so they keep odd parity on the line
+typedef enum {
+    transport_convention_unknown = 0, // until TS: characters are passed as is, their parity is not checked
+    transport_convention_direct,
+    transport_convention_inverse
+} transport_convention_t;
+
 typedef struct transmit_params {
     transmit_speed_t transmit_speed;
     uint32_t etu;
     uint32_t extra_gt_us; // excess over 12 etu
-    uint8_t wt_ds;        // d for deci-
+    uint8_t wt_ds;        // d for deci-, VTIME between characters, saturated at 255 for longer WT
+    uint32_t wt_us;       // BWT for T=1
+    uint32_t cwt_us;      // between the characters of a T=1 block, WT for T=0
+    transport_convention_t convention;
 } transmit_params_t;
 
+// Reconfigurations applied and skipped by transport_reinitialize as the
+// settings have not changed
+typedef struct {
+    uint32_t serial_setups;
+    uint32_t serial_setups_skipped;
+    uint32_t clock_changes;
+    uint32_t clock_changes_skipped;
+} transport_reconfig_stats_t;
+
 typedef struct {
     int handle;
+    hw_config_t hw;
+    realtime_config_t realtime; // applied by the reader to the exchange and the reset
     transmit_params_t params;
+    uint32_t clock_freq; // 0 while the clock is stopped
+    uint8_t protocol;    // negotiated during the last reset
+    struct atr_cache* atr_cache; // outcomes of the negotiation by ATR, owned by the caller, required by the reset
+    struct atr_info* atr_info;   // parsed ATR of the card, owned by the caller, filled during the last reset
+    transport_reconfig_stats_t reconfig_stats;
+    bool pps_exchanged; // during the last reset
+    uint32_t pps_us;    // duration of that exchange
+    uint32_t* timeouts; // receive timeouts are counted there if set
 } transport_t;
@@ -0,0 +1,19 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#pragma once
+
+#include <stdint.h>
+
+// Counters updated by the thread owning the reader and read by any other one
+// without locks. Only the values themselves are atomic, no ordering is implied.
+
+static inline void counter_add(uint32_t* counter, uint32_t value) {
+    __atomic_fetch_add(counter, value, __ATOMIC_RELAXED);
+}
+
+static inline uint32_t counter_load(const uint32_t* counter) {
+    return __atomic_load_n(counter, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,37 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#pragma once
+
+// cpu_set_t requires _GNU_SOURCE defined before any system header is included
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <rtuartscreader/utils/realtime_config.h>
+
+// Scheduling of the calling thread to be restored by realtime_leave
+typedef struct {
+    bool scheduled;
+    int policy;
+    struct sched_param param;
+    bool pinned;
+    cpu_set_t affinity;
+} realtime_context_t;
+
+// Locks the current and future memory of the process, it is never unlocked
+// as the other readers of the process may rely on it
+bool realtime_lock_memory(void);
+
+// Applies the mode to the calling thread as far as it is permitted,
+// false if nothing has been applied
+bool realtime_enter(const realtime_config_t* config, realtime_context_t* context);
+void realtime_leave(const realtime_context_t* context);
+
+// Overshoot of a short sleep of the calling thread, the time it takes
+// the scheduler to resume it
+uint32_t realtime_measure_latency_us(void);
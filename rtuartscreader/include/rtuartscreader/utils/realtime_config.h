@@ -0,0 +1,22 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#pragma once
+
+#include <stdbool.h>
+
+#define REALTIME_MIN_PRIORITY 1
+#define REALTIME_MAX_PRIORITY 99
+
+// Real-time mode of the thread exchanging with the card, off by default
+typedef struct {
+    int priority; // SCHED_FIFO priority, 0 if the scheduling is kept
+    bool pin_cpu;
+    unsigned cpu;
+} realtime_config_t;
+
+static inline bool realtime_config_enabled(const realtime_config_t* config) {
+    return config->priority || config->pin_cpu;
+}
@@ -0,0 +1,34 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#pragma once
+
+#include <PCSC/reader.h>
+
+// Reader attributes available through SCardGetAttrib/SCardSetAttrib
+
+// 1 byte: when non-zero, 61XX and 6CXX status words are handled by the reader,
+// so the whole response is returned by a single transmit. Disabled by default.
+#define SCARD_ATTR_RTUARTSCREADER_AUTO_GET_RESPONSE SCARD_ATTR_VALUE(SCARD_CLASS_VENDOR_DEFINED, 0x0100)
+
+// 8 bytes, read only: hits and misses of the ATR negotiation cache,
+// 32-bit counters in host byte order
+#define SCARD_ATTR_RTUARTSCREADER_ATR_CACHE_STATS SCARD_ATTR_VALUE(SCARD_CLASS_VENDOR_DEFINED, 0x0101)
+
+// 16 bytes, read only: serial port setups applied and skipped, clock frequency
+// changes applied and skipped by the transport reconfigurations,
+// 32-bit counters in host byte order
+#define SCARD_ATTR_RTUARTSCREADER_RECONFIG_STATS SCARD_ATTR_VALUE(SCARD_CLASS_VENDOR_DEFINED, 0x0102)
+
+// Control codes available through SCardControl
+
+// Output only: reader_stats_t of rtuartscreader/reader_stats.h, APDU and
+// reset counters with latency histograms. Served without waiting for
+// the operation in progress on the reader.
+#define IOCTL_RTUARTSCREADER_GET_STATS SCARD_CTL_CODE(3600)
+
+// Input: APDU script of rtuartscreader/reader_script.h, output: the responses.
+// The APDUs are sent back to back under a single lock of the reader.
+#define IOCTL_RTUARTSCREADER_RUN_SCRIPT SCARD_CTL_CODE(3601)
@@ -5,24 +5,24 @@
 
 #include <rtuartscreader/iso7816_3/apdu_t0.h>
 
+#include <rtuartscreader/iso7816_3/detail/apdu.h>
 #include <rtuartscreader/iso7816_3/detail/error.h>
 #include <rtuartscreader/log/log.h>
 #include <rtuartscreader/transport/sendrecv.h>
 #include <rtuartscreader/transport/transport_t.h>
 #include <rtuartscreader/utils/buffer_view.h>
 
-#define APDU_HEADER_SIZE 5
-
-#define APDU_INS_OFFSET 1
-#define APDU_P3_OFFSET 4
-
-#define APDU_MAX_NE_VALUE 0x100
+#define APDU_EXTENDED_LC_OFFSET 5
+#define APDU_EXTENDED_HEADER_SIZE 7
+#define APDU_EXTENDED_LE_SIZE 2
+#define APDU_EXTENDED_MAX_NE_VALUE 0x10000
 
 #define PROCEDURE_BYTE_NULL 0x60
 
-static inline uint16_t le_to_ne(uint8_t le) {
-    if (le == 0x00) return APDU_MAX_NE_VALUE;
-    return le;
+static inline size_t ext_le_to_ne(const uint8_t* le) {
+    size_t ne = (le[0] << 8) | le[1];
+    if (ne == 0x0000) return APDU_EXTENDED_MAX_NE_VALUE;
+    return ne;
 }
 
 static transport_status_t send_apdu_header(const transport_t* transport, const uint8_t* tx_buf, uint8_t p3) {
@@ -110,13 +110,133 @@ static iso7816_3_status_t t0_transceive_data(const transport_t* transport, const
     return iso7816_3_status_ok;
 }
 
-// TODO: add logging for transport IO functions
-iso7816_3_status_t t0_transmit_apdu(const transport_t* transport, const uint8_t* tx_buf, uint16_t tx_len,
-                                    uint8_t* rx_buf, uint16_t* rx_len) {
-    transport_status_t r;
+static iso7816_3_status_t t0_transmit_tpdu(const transport_t* transport, const uint8_t* header, uint8_t p3,
+                                           const uint8_t* data, size_t nc, size_t ne, uint8_t* rx_buf, size_t* rx_len) {
+    if (*rx_len < ne + 2) {
+        LOG_RETURN_ISO7816_3_ERROR_MSG(iso7816_3_status_insufficient_buffer, "Response buffer too short");
+    }
+
+    transport_status_t r = send_apdu_header(transport, header, p3);
+    RETURN_ON_TRANSPORT_ERROR(r);
+
+    pop_front_buffer_view send_data;
+    pop_front_buffer_view_init(&send_data, data, nc);
+
+    push_back_buffer_view recv_data;
+    push_back_buffer_view_init(&recv_data, rx_buf, ne + 2);
+
+    const uint8_t ack = header[APDU_INS_OFFSET];
 
-    uint16_t ne = 0; // expected data size to receive
-    uint8_t nc = 0;  // expected data size to send
+    iso7816_3_status_t transceive_data_result = t0_transceive_data(transport, ack, &send_data, &recv_data);
+    POPULATE_ERROR(transceive_data_result, iso7816_3_status_ok, transceive_data_result);
+
+    *rx_len = push_back_buffer_view_size(&recv_data);
+
+    return iso7816_3_status_ok;
+}
+
+// Replaces 61XX at the end of the response with the data retrieved by GET RESPONSE,
+// at most ne bytes of data are requested
+static iso7816_3_status_t t0_get_response_chain(const transport_t* transport, uint8_t cla, size_t ne, uint8_t* rx_buf,
+                                                size_t rx_capacity, size_t* rx_len) {
+    const uint8_t header[APDU_HEADER_SIZE - 1] = { get_response_cla(cla), APDU_INS_GET_RESPONSE, 0x00, 0x00 };
+
+    while (ne && rx_buf[*rx_len - 2] == SW1_RESPONSE_BYTES_AVAILABLE) {
+        size_t available = le_to_ne(rx_buf[*rx_len - 1]);
+        size_t chunk = available < ne ? available : ne;
+
+        *rx_len -= 2;
+
+        size_t len = rx_capacity - *rx_len;
+        iso7816_3_status_t r = t0_transmit_tpdu(transport, header, (uint8_t)chunk, NULL, 0, chunk, rx_buf + *rx_len, &len);
+        POPULATE_ERROR(r, iso7816_3_status_ok, r);
+
+        *rx_len += len;
+        ne -= len - 2 < ne ? len - 2 : ne;
+    }
+
+    return iso7816_3_status_ok;
+}
+
+// ISO/IEC 7816-3 12.2: extended command which does not fit a short TPDU is sent in ENVELOPE
+// commands, the response longer than 256 bytes is retrieved with GET RESPONSE commands
+static iso7816_3_status_t t0_transmit_extended_apdu(const transport_t* transport, const uint8_t* tx_buf, size_t tx_len,
+                                                    uint8_t* rx_buf, size_t* rx_len) {
+    size_t nc = 0; // data size to send
+    size_t ne = 0; // expected data size to receive
+
+    if (tx_len == APDU_EXTENDED_HEADER_SIZE) {
+        ne = ext_le_to_ne(tx_buf + APDU_EXTENDED_LC_OFFSET);
+    } else {
+        nc = (tx_buf[APDU_EXTENDED_LC_OFFSET] << 8) | tx_buf[APDU_EXTENDED_LC_OFFSET + 1];
+
+        if (!nc) {
+            LOG_RETURN_ISO7816_3_ERROR_MSG(iso7816_3_status_invalid_params, "APDU has invalid Lc");
+        } else if (tx_len < APDU_EXTENDED_HEADER_SIZE + nc) {
+            LOG_RETURN_ISO7816_3_ERROR_MSG(iso7816_3_status_invalid_params, "APDU is not complete");
+        } else if (tx_len == APDU_EXTENDED_HEADER_SIZE + nc) {
+            ne = 0;
+        } else if (tx_len == APDU_EXTENDED_HEADER_SIZE + nc + APDU_EXTENDED_LE_SIZE) {
+            ne = ext_le_to_ne(tx_buf + tx_len - APDU_EXTENDED_LE_SIZE);
+        } else {
+            LOG_RETURN_ISO7816_3_ERROR_MSG(iso7816_3_status_invalid_params, "APDU buffer has excess data");
+        }
+    }
+
+    size_t rx_capacity = *rx_len;
+    if (rx_capacity < ne + 2) {
+        LOG_RETURN_ISO7816_3_ERROR_MSG(iso7816_3_status_insufficient_buffer, "Response buffer too short");
+    }
+
+    iso7816_3_status_t r;
+
+    if (!nc) {
+        // case 2E: first part of the response is received in a short TPDU
+        size_t tpdu_ne = ne < APDU_MAX_NE_VALUE ? ne : APDU_MAX_NE_VALUE;
+
+        r = t0_transmit_tpdu(transport, tx_buf, (uint8_t)tpdu_ne, NULL, 0, tpdu_ne, rx_buf, rx_len);
+        POPULATE_ERROR(r, iso7816_3_status_ok, r);
+
+        if (*rx_len == 2 && rx_buf[0] == SW1_WRONG_LENGTH) {
+            tpdu_ne = le_to_ne(rx_buf[1]);
+            *rx_len = rx_capacity;
+
+            r = t0_transmit_tpdu(transport, tx_buf, (uint8_t)tpdu_ne, NULL, 0, tpdu_ne, rx_buf, rx_len);
+            POPULATE_ERROR(r, iso7816_3_status_ok, r);
+        }
+
+        ne = *rx_len - 2 < ne ? ne - (*rx_len - 2) : 0;
+    } else if (nc <= APDU_MAX_NC_VALUE) {
+        // case 3E & 4E: command fits a short TPDU
+        r = t0_transmit_tpdu(transport, tx_buf, (uint8_t)nc, tx_buf + APDU_EXTENDED_HEADER_SIZE, nc, 0, rx_buf, rx_len);
+        POPULATE_ERROR(r, iso7816_3_status_ok, r);
+    } else {
+        const uint8_t header[APDU_HEADER_SIZE - 1] = { tx_buf[APDU_CLA_OFFSET], APDU_INS_ENVELOPE, 0x00, 0x00 };
+
+        for (size_t sent = 0; sent != tx_len;) {
+            size_t chunk = tx_len - sent < APDU_MAX_NC_VALUE ? tx_len - sent : APDU_MAX_NC_VALUE;
+
+            *rx_len = rx_capacity;
+            r = t0_transmit_tpdu(transport, header, (uint8_t)chunk, tx_buf + sent, chunk, 0, rx_buf, rx_len);
+            POPULATE_ERROR(r, iso7816_3_status_ok, r);
+
+            sent += chunk;
+
+            // the card refused the command
+            if (sent != tx_len && (rx_buf[0] != SW1_OK || rx_buf[1] != SW2_OK)) {
+                return iso7816_3_status_ok;
+            }
+        }
+    }
+
+    return t0_get_response_chain(transport, tx_buf[APDU_CLA_OFFSET], ne, rx_buf, rx_capacity, rx_len);
+}
+
+// TODO: add logging for transport IO functions
+iso7816_3_status_t t0_transmit_apdu(const transport_t* transport, const uint8_t* tx_buf, size_t tx_len,
+                                    uint8_t* rx_buf, size_t* rx_len) {
+    size_t ne = 0; // expected data size to receive
+    size_t nc = 0; // expected data size to send
 
     uint8_t p3;
 
@@ -127,7 +247,9 @@ iso7816_3_status_t t0_transmit_apdu(const transport_t* transport, const uint8_t*
     } else if (tx_len == APDU_HEADER_SIZE) {
         p3 = tx_buf[APDU_P3_OFFSET];
         ne = le_to_ne(p3);
-    } else if (tx_len > APDU_HEADER_SIZE) {
+    } else if (tx_buf[APDU_P3_OFFSET] == 0x00 && tx_len >= APDU_EXTENDED_HEADER_SIZE) {
+        return t0_transmit_extended_apdu(transport, tx_buf, tx_len, rx_buf, rx_len);
+    } else {
         p3 = tx_buf[APDU_P3_OFFSET];
         nc = p3;
 
@@ -142,25 +264,5 @@ iso7816_3_status_t t0_transmit_apdu(const transport_t* transport, const uint8_t*
         }
     }
 
-    if (*rx_len < ne + 2) {
-        LOG_RETURN_ISO7816_3_ERROR_MSG(iso7816_3_status_insufficient_buffer, "Response buffer too short");
-    }
-
-    r = send_apdu_header(transport, tx_buf, p3);
-    RETURN_ON_TRANSPORT_ERROR(r);
-
-    pop_front_buffer_view send_data;
-    pop_front_buffer_view_init(&send_data, tx_buf + APDU_HEADER_SIZE, nc);
-
-    push_back_buffer_view recv_data;
-    push_back_buffer_view_init(&recv_data, rx_buf, ne + 2);
-
-    const uint8_t ack = tx_buf[APDU_INS_OFFSET];
-
-    iso7816_3_status_t transceive_data_result = t0_transceive_data(transport, ack, &send_data, &recv_data);
-    POPULATE_ERROR(transceive_data_result, iso7816_3_status_ok, transceive_data_result);
-
-    *rx_len = push_back_buffer_view_size(&recv_data);
-
-    return iso7816_3_status_ok;
+    return t0_transmit_tpdu(transport, tx_buf, p3, tx_buf + APDU_HEADER_SIZE, nc, ne, rx_buf, rx_len);
 }
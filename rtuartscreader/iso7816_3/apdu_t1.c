@@ -0,0 +1,402 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#include <rtuartscreader/iso7816_3/apdu_t1.h>
+
+#include <string.h>
+
+#include <rtuartscreader/iso7816_3/detail/apdu.h>
+#include <rtuartscreader/iso7816_3/detail/error.h>
+#include <rtuartscreader/log/log.h>
+#include <rtuartscreader/transport/sendrecv.h>
+#include <rtuartscreader/utils/buffer_view.h>
+
+#define T1_NAD 0x00
+
+#define T1_NAD_OFFSET 0
+#define T1_PCB_OFFSET 1
+#define T1_LEN_OFFSET 2
+#define T1_PROLOGUE_SIZE 3
+
+#define T1_LRC_SIZE 1
+#define T1_CRC_SIZE 2
+
+#define T1_MAX_BLOCK_SIZE (T1_PROLOGUE_SIZE + T1_MAX_IFS + T1_CRC_SIZE)
+
+#define T1_BLOCK_TYPE_MASK 0xC0
+#define T1_R_BLOCK 0x80
+#define T1_S_BLOCK 0xC0
+
+#define T1_IS_I_BLOCK(pcb) (!((pcb)&0x80))
+#define T1_IS_R_BLOCK(pcb) (((pcb)&T1_BLOCK_TYPE_MASK) == T1_R_BLOCK)
+#define T1_IS_S_BLOCK(pcb) (((pcb)&T1_BLOCK_TYPE_MASK) == T1_S_BLOCK)
+
+#define T1_I_BLOCK_NS 0x40
+#define T1_I_BLOCK_MORE 0x20
+
+#define T1_R_BLOCK_NR 0x10
+#define T1_R_BLOCK_EDC_ERROR 0x01
+#define T1_R_BLOCK_OTHER_ERROR 0x02
+
+#define T1_S_BLOCK_RESPONSE 0x20
+#define T1_S_BLOCK_TYPE_MASK 0x1F
+#define T1_S_RESYNCH 0x00
+#define T1_S_IFS 0x01
+#define T1_S_ABORT 0x02
+#define T1_S_WTX 0x03
+
+// Number of times an erroneous exchange is repeated before resynchronization
+#define T1_MAX_RETRIES 3
+
+#define CRC_INITIAL_VALUE 0xFFFF
+#define CRC_POLYNOMIAL_REVERSED 0x8408
+
+typedef struct t1_block {
+    uint8_t pcb;
+    uint8_t len;
+    uint8_t inf[T1_MAX_IFS];
+} t1_block_t;
+
+static inline uint8_t t1_i_block_pcb(uint8_t ns, bool more) {
+    return (ns ? T1_I_BLOCK_NS : 0) | (more ? T1_I_BLOCK_MORE : 0);
+}
+
+static inline uint8_t t1_r_block_pcb(uint8_t nr, uint8_t error) {
+    return T1_R_BLOCK | (nr ? T1_R_BLOCK_NR : 0) | error;
+}
+
+static inline uint8_t t1_i_block_ns(uint8_t pcb) {
+    return !!(pcb & T1_I_BLOCK_NS);
+}
+
+static inline uint8_t t1_r_block_nr(uint8_t pcb) {
+    return !!(pcb & T1_R_BLOCK_NR);
+}
+
+static size_t t1_edc_size(const t1_context_t* context) {
+    return context->use_crc ? T1_CRC_SIZE : T1_LRC_SIZE;
+}
+
+static void t1_compute_edc(const t1_context_t* context, const uint8_t* data, size_t len, uint8_t* edc) {
+    if (context->use_crc) {
+        uint16_t crc = CRC_INITIAL_VALUE;
+        for (size_t i = 0; i < len; ++i) {
+            crc ^= data[i];
+            for (size_t bit = 0; bit < 8; ++bit) {
+                crc = (crc & 1) ? (crc >> 1) ^ CRC_POLYNOMIAL_REVERSED : crc >> 1;
+            }
+        }
+
+        edc[0] = crc >> 8;
+        edc[1] = crc & 0xFF;
+    } else {
+        uint8_t lrc = 0;
+        for (size_t i = 0; i < len; ++i) {
+            lrc ^= data[i];
+        }
+
+        edc[0] = lrc;
+    }
+}
+
+static iso7816_3_status_t t1_send_block(const transport_t* transport, const t1_context_t* context, uint8_t pcb,
+                                        const uint8_t* inf, uint8_t len) {
+    uint8_t block[T1_MAX_BLOCK_SIZE];
+
+    block[T1_NAD_OFFSET] = T1_NAD;
+    block[T1_PCB_OFFSET] = pcb;
+    block[T1_LEN_OFFSET] = len;
+    if (len) {
+        memcpy(block + T1_PROLOGUE_SIZE, inf, len);
+    }
+
+    t1_compute_edc(context, block, T1_PROLOGUE_SIZE + len, block + T1_PROLOGUE_SIZE + len);
+
+    transport_status_t r = transport_send_bytes(transport, block, T1_PROLOGUE_SIZE + len + t1_edc_size(context));
+    RETURN_ON_TRANSPORT_ERROR(r);
+
+    return iso7816_3_status_ok;
+}
+
+// The beginning of the block is awaited wtx times longer than BWT, its other characters CWT each.
+// Returns iso7816_3_status_edc_error if the block is corrupted.
+static iso7816_3_status_t t1_recv_block(const transport_t* transport, const t1_context_t* context, uint8_t wtx,
+                                        t1_block_t* block) {
+    uint8_t data[T1_MAX_BLOCK_SIZE];
+
+    transport_status_t r;
+    do {
+        r = transport_recv_byte(transport, data + T1_NAD_OFFSET);
+    } while (r == transport_status_timeout && wtx-- > 1);
+    RETURN_ON_TRANSPORT_ERROR(r);
+
+    // The rest of the block follows within CWT
+    r = transport_recv_block_bytes(transport, data + T1_PCB_OFFSET, T1_PROLOGUE_SIZE - T1_PCB_OFFSET);
+    RETURN_ON_TRANSPORT_ERROR(r);
+
+    uint8_t len = data[T1_LEN_OFFSET];
+    if (len > T1_MAX_IFS) {
+        LOG_RETURN_ISO7816_3_ERROR_MSG(iso7816_3_status_unexpected_card_response, "Invalid block length");
+    }
+
+    size_t edc_size = t1_edc_size(context);
+    r = transport_recv_block_bytes(transport, data + T1_PROLOGUE_SIZE, len + edc_size);
+    RETURN_ON_TRANSPORT_ERROR(r);
+
+    uint8_t edc[T1_CRC_SIZE];
+    t1_compute_edc(context, data, T1_PROLOGUE_SIZE + len, edc);
+    if (memcmp(edc, data + T1_PROLOGUE_SIZE + len, edc_size)) {
+        LOG_RETURN_ISO7816_3_ERROR_MSG(iso7816_3_status_edc_error, "Block EDC does not match");
+    }
+
+    if (len > context->ifsd) {
+        LOG_RETURN_ISO7816_3_ERROR_MSG(iso7816_3_status_unexpected_card_response, "The card exceeded IFSD");
+    }
+
+    block->pcb = data[T1_PCB_OFFSET];
+    block->len = len;
+    memcpy(block->inf, data + T1_PROLOGUE_SIZE, len);
+
+    return iso7816_3_status_ok;
+}
+
+// Sends S-block request and awaits the matching response with the same INF field
+static iso7816_3_status_t t1_s_block_exchange(const transport_t* transport, const t1_context_t* context, uint8_t type,
+                                              const uint8_t* inf, uint8_t len) {
+    iso7816_3_status_t r = iso7816_3_status_communication_error;
+
+    for (size_t i = 0; i < T1_MAX_RETRIES; ++i) {
+        r = t1_send_block(transport, context, T1_S_BLOCK | type, inf, len);
+        POPULATE_ERROR(r, iso7816_3_status_ok, r);
+
+        t1_block_t block;
+        r = t1_recv_block(transport, context, 1, &block);
+        if (r != iso7816_3_status_ok) {
+            continue;
+        }
+
+        if (block.pcb != (T1_S_BLOCK | T1_S_BLOCK_RESPONSE | type) || block.len != len
+            || (len && memcmp(block.inf, inf, len))) {
+            r = iso7816_3_status_unexpected_card_response;
+            continue;
+        }
+
+        return iso7816_3_status_ok;
+    }
+
+    return r;
+}
+
+static iso7816_3_status_t t1_resynchronize(const transport_t* transport, t1_context_t* context) {
+    iso7816_3_status_t r = t1_s_block_exchange(transport, context, T1_S_RESYNCH, NULL, 0);
+    if (r != iso7816_3_status_ok) {
+        LOG_RETURN_ISO7816_3_ERROR_MSG(iso7816_3_status_communication_error, "Resynchronization failed");
+    }
+
+    context->ns = 0;
+    context->nr = 0;
+
+    return iso7816_3_status_ok;
+}
+
+// Answers a request of the card, returns iso7816_3_status_unexpected_card_response if the block is not a valid request
+static iso7816_3_status_t t1_handle_s_block_request(const transport_t* transport, t1_context_t* context,
+                                                    const t1_block_t* block, uint8_t* wtx) {
+    if (block->pcb & T1_S_BLOCK_RESPONSE) {
+        return iso7816_3_status_unexpected_card_response;
+    }
+
+    switch (block->pcb & T1_S_BLOCK_TYPE_MASK) {
+    case T1_S_WTX:
+        if (block->len != 1) {
+            return iso7816_3_status_unexpected_card_response;
+        }
+        *wtx = block->inf[0] ? block->inf[0] : 1;
+        break;
+    case T1_S_IFS:
+        if (block->len != 1 || block->inf[0] == 0x00 || block->inf[0] > T1_MAX_IFS) {
+            return iso7816_3_status_unexpected_card_response;
+        }
+        context->ifsc = block->inf[0];
+        break;
+    case T1_S_ABORT:
+        t1_send_block(transport, context, block->pcb | T1_S_BLOCK_RESPONSE, block->inf, block->len);
+        LOG_RETURN_ISO7816_3_ERROR_MSG(iso7816_3_status_communication_error, "The card aborted the chain");
+    default:
+        return iso7816_3_status_unexpected_card_response;
+    }
+
+    return t1_send_block(transport, context, block->pcb | T1_S_BLOCK_RESPONSE, block->inf, block->len);
+}
+
+// Sends the command in I-blocks of at most IFSC bytes, collects the response chain. Sets
+// is_resynchronized if the exchange has been broken and the card has been resynchronized.
+static iso7816_3_status_t t1_transceive(const transport_t* transport, t1_context_t* context,
+                                        pop_front_buffer_view* send_data, push_back_buffer_view* recv_data,
+                                        bool* is_resynchronized) {
+    // The last block sent, the card may request to repeat it
+    uint8_t pcb;
+    const uint8_t* inf;
+    uint8_t len;
+
+    // Until the card responds with I-block, the last I-block of the command is not acknowledged
+    bool is_sending = true;
+    bool more;
+
+    size_t errors = 0;
+    uint8_t wtx = 1;
+
+    size_t rest = pop_front_buffer_view_size(send_data);
+    len = rest < context->ifsc ? rest : context->ifsc;
+    inf = pop_front_buffer_view_pop_n(send_data, len);
+    more = !pop_front_buffer_view_empty(send_data);
+    pcb = t1_i_block_pcb(context->ns, more);
+
+    iso7816_3_status_t r = t1_send_block(transport, context, pcb, inf, len);
+    POPULATE_ERROR(r, iso7816_3_status_ok, r);
+
+    while (1) {
+        t1_block_t block;
+
+        r = t1_recv_block(transport, context, wtx, &block);
+        wtx = 1;
+
+        if (r == iso7816_3_status_ok) {
+            if (T1_IS_I_BLOCK(block.pcb) && !(is_sending && more) && t1_i_block_ns(block.pcb) == context->nr) {
+                if (is_sending) {
+                    context->ns ^= 1;
+                    is_sending = false;
+                }
+                context->nr ^= 1;
+                errors = 0;
+
+                if (push_back_buffer_view_free_space(recv_data) < block.len) {
+                    LOG_RETURN_ISO7816_3_ERROR_MSG(iso7816_3_status_insufficient_buffer, "Response buffer too short");
+                }
+                memcpy(push_back_buffer_view_reserve_n(recv_data, block.len), block.inf, block.len);
+
+                if (!(block.pcb & T1_I_BLOCK_MORE)) {
+                    return iso7816_3_status_ok;
+                }
+
+                // acknowledge the chained block
+                pcb = t1_r_block_pcb(context->nr, 0);
+                inf = NULL;
+                len = 0;
+
+                r = t1_send_block(transport, context, pcb, inf, len);
+                POPULATE_ERROR(r, iso7816_3_status_ok, r);
+
+                continue;
+            }
+
+            if (T1_IS_R_BLOCK(block.pcb)) {
+                if (is_sending && more && t1_r_block_nr(block.pcb) != context->ns) {
+                    // the chained block is acknowledged, send the next one
+                    context->ns ^= 1;
+                    errors = 0;
+
+                    rest = pop_front_buffer_view_size(send_data);
+                    len = rest < context->ifsc ? rest : context->ifsc;
+                    inf = pop_front_buffer_view_pop_n(send_data, len);
+                    more = !pop_front_buffer_view_empty(send_data);
+                    pcb = t1_i_block_pcb(context->ns, more);
+                } else if (++errors > T1_MAX_RETRIES) {
+                    break;
+                }
+
+                // otherwise the card requests to repeat the last block
+                r = t1_send_block(transport, context, pcb, inf, len);
+                POPULATE_ERROR(r, iso7816_3_status_ok, r);
+
+                continue;
+            }
+
+            if (T1_IS_S_BLOCK(block.pcb)) {
+                r = t1_handle_s_block_request(transport, context, &block, &wtx);
+                if (r == iso7816_3_status_ok) {
+                    continue;
+                }
+                POPULATE_ERROR(r, iso7816_3_status_unexpected_card_response, r);
+            }
+
+            r = iso7816_3_status_unexpected_card_response;
+        }
+
+        if (++errors > T1_MAX_RETRIES) {
+            break;
+        }
+
+        if (T1_IS_R_BLOCK(pcb)) {
+            r = t1_send_block(transport, context, pcb, inf, len);
+        } else {
+            uint8_t error = r == iso7816_3_status_edc_error ? T1_R_BLOCK_EDC_ERROR : T1_R_BLOCK_OTHER_ERROR;
+            r = t1_send_block(transport, context, t1_r_block_pcb(context->nr, error), NULL, 0);
+        }
+        POPULATE_ERROR(r, iso7816_3_status_ok, r);
+    }
+
+    r = t1_resynchronize(transport, context);
+    POPULATE_ERROR(r, iso7816_3_status_ok, r);
+
+    *is_resynchronized = true;
+
+    LOG_RETURN_ISO7816_3_ERROR_MSG(iso7816_3_status_communication_error, "Block exchange failed");
+}
+
+void t1_context_init(t1_context_t* context, const t1_params_t* params) {
+    context->ns = 0;
+    context->nr = 0;
+    context->ifsc = params->ifsc;
+    context->ifsd = T1_DEFAULT_IFS;
+    context->use_crc = params->use_crc;
+}
+
+iso7816_3_status_t t1_negotiate_ifsd(const transport_t* transport, t1_context_t* context, uint8_t ifsd) {
+    if (ifsd == 0x00 || ifsd > T1_MAX_IFS) {
+        LOG_RETURN_ISO7816_3_ERROR_MSG(iso7816_3_status_invalid_params, "Invalid IFSD");
+    }
+
+    iso7816_3_status_t r = t1_s_block_exchange(transport, context, T1_S_IFS, &ifsd, 1);
+    if (r != iso7816_3_status_ok) {
+        LOG_RETURN_ISO7816_3_ERROR_MSG(iso7816_3_status_communication_error, "IFSD negotiation failed");
+    }
+
+    context->ifsd = ifsd;
+
+    return iso7816_3_status_ok;
+}
+
+iso7816_3_status_t t1_transmit_apdu(const transport_t* transport, t1_context_t* context, const uint8_t* tx_buf,
+                                    size_t tx_len, uint8_t* rx_buf, size_t* rx_len) {
+    if (tx_len < APDU_HEADER_SIZE - 1) {
+        LOG_RETURN_ISO7816_3_ERROR_MSG(iso7816_3_status_invalid_params, "APDU buffer too short");
+    }
+
+    iso7816_3_status_t r = iso7816_3_status_ok;
+    bool is_resynchronized = false;
+
+    // After resynchronization the command is sent once again
+    for (size_t attempt = 0; attempt != 2; ++attempt) {
+        pop_front_buffer_view send_data;
+        pop_front_buffer_view_init(&send_data, tx_buf, tx_len);
+
+        push_back_buffer_view recv_data;
+        push_back_buffer_view_init(&recv_data, rx_buf, *rx_len);
+
+        is_resynchronized = false;
+        r = t1_transceive(transport, context, &send_data, &recv_data, &is_resynchronized);
+        if (r == iso7816_3_status_ok) {
+            *rx_len = push_back_buffer_view_size(&recv_data);
+            return iso7816_3_status_ok;
+        }
+
+        if (!is_resynchronized) {
+            break;
+        }
+    }
+
+    return r;
+}
@@ -12,6 +12,7 @@
 #include <rtuartscreader/iso7816_3/detail/error.h>
 #include <rtuartscreader/iso7816_3/detail/utils.h>
 #include <rtuartscreader/log/log.h>
+#include <rtuartscreader/transport/convention.h>
 #include <rtuartscreader/transport/sendrecv.h>
 #include <rtuartscreader/utils/common.h>
 
@@ -69,6 +70,22 @@ static bool is_tck_correct(const uint8_t* atr, size_t atr_len) {
     return convolution == 0;
 }
 
+static transport_status_t recv_atr_byte(const transport_t* transport, bool inverse, uint8_t* byte) {
+    transport_status_t r = transport_recv_byte(transport, byte);
+    if (r == transport_status_ok && inverse)
+        transport_convert_inverse(byte, 1);
+
+    return r;
+}
+
+static transport_status_t recv_atr_bytes(const transport_t* transport, bool inverse, uint8_t* buf, size_t len) {
+    transport_status_t r = transport_recv_bytes(transport, buf, len);
+    if (r == transport_status_ok && inverse)
+        transport_convert_inverse(buf, len);
+
+    return r;
+}
+
 static void init_atr(atr_t* atr) {
     memset(atr, BAD_ATR_OFFSET, sizeof(*atr));
     atr->atr_len = 0;
@@ -80,19 +97,24 @@ iso7816_3_status_t read_atr(const transport_t* transport, atr_t* atr) {
 
     size_t i = 0;
 
+    // TS is received before the convention is known, so it is decoded here
+    // along with the rest of ATR
     uint8_t ts;
     transport_status_t r = transport_recv_byte(transport, &ts);
     RETURN_ON_TRANSPORT_ERROR(r);
-    atr->atr[i] = ts;
 
-    if (ts != 0x3B)
-        LOG_RETURN_ISO7816_3_ERROR_MSG(iso7816_3_status_unexpected_card_response,
-                                       "Inverse convention is not supported");
+    bool inverse = ts != ATR_TS_DIRECT;
+    if (inverse)
+        transport_convert_inverse(&ts, 1);
+
+    if (ts != ATR_TS_DIRECT && ts != ATR_TS_INVERSE)
+        LOG_RETURN_ISO7816_3_ERROR_MSG(iso7816_3_status_unexpected_card_response, "Invalid TS");
+    atr->atr[i] = ts;
 
     uint8_t t0;
-    r = transport_recv_byte(transport, &t0);
+    r = recv_atr_byte(transport, inverse, &t0);
     RETURN_ON_TRANSPORT_ERROR(r);
-    SAFE_INCREMENT(i, MAX_ATR_SIZE, iso7816_3_status_unexpected_card_response);
+    SAFE_INCREMENT(i, ATR_MAX_SIZE, iso7816_3_status_unexpected_card_response);
     atr->t0_offset = i;
     atr->atr[i] = t0;
 
@@ -102,9 +124,9 @@ iso7816_3_status_t read_atr(const transport_t* transport, atr_t* atr) {
     for (size_t level = 0;; ++level) {
         if (level_mask.ta) {
             uint8_t ta;
-            r = transport_recv_byte(transport, &ta);
+            r = recv_atr_byte(transport, inverse, &ta);
             RETURN_ON_TRANSPORT_ERROR(r);
-            SAFE_INCREMENT(i, MAX_ATR_SIZE, iso7816_3_status_unexpected_card_response);
+            SAFE_INCREMENT(i, ATR_MAX_SIZE, iso7816_3_status_unexpected_card_response);
             atr->ta_offset[level] = i;
             atr->atr[i] = ta;
         }
@@ -112,27 +134,27 @@ iso7816_3_status_t read_atr(const transport_t* transport, atr_t* atr) {
         if (level_mask.tb) {
             //TB is recommended to ingnore
             uint8_t tb;
-            r = transport_recv_byte(transport, &tb);
+            r = recv_atr_byte(transport, inverse, &tb);
             RETURN_ON_TRANSPORT_ERROR(r);
-            SAFE_INCREMENT(i, MAX_ATR_SIZE, iso7816_3_status_unexpected_card_response);
+            SAFE_INCREMENT(i, ATR_MAX_SIZE, iso7816_3_status_unexpected_card_response);
             atr->tb_offset[level] = i;
             atr->atr[i] = tb;
         }
 
         if (level_mask.tc) {
             uint8_t tc;
-            r = transport_recv_byte(transport, &tc);
+            r = recv_atr_byte(transport, inverse, &tc);
             RETURN_ON_TRANSPORT_ERROR(r);
-            SAFE_INCREMENT(i, MAX_ATR_SIZE, iso7816_3_status_unexpected_card_response);
+            SAFE_INCREMENT(i, ATR_MAX_SIZE, iso7816_3_status_unexpected_card_response);
             atr->tc_offset[level] = i;
             atr->atr[i] = tc;
         }
 
         if (level_mask.td) {
             uint8_t td;
-            r = transport_recv_byte(transport, &td);
+            r = recv_atr_byte(transport, inverse, &td);
             RETURN_ON_TRANSPORT_ERROR(r);
-            SAFE_INCREMENT(i, MAX_ATR_SIZE, iso7816_3_status_unexpected_card_response);
+            SAFE_INCREMENT(i, ATR_MAX_SIZE, iso7816_3_status_unexpected_card_response);
             atr->td_offset[level] = i;
             atr->atr[i] = td;
 
@@ -145,19 +167,19 @@ iso7816_3_status_t read_atr(const transport_t* transport, atr_t* atr) {
     atr->historical_bytes_len = LOWOCT(atr->atr[atr->t0_offset]);
 
     if (atr->historical_bytes_len) {
-        SAFE_INCREMENT(i, MAX_ATR_SIZE, iso7816_3_status_unexpected_card_response);
+        SAFE_INCREMENT(i, ATR_MAX_SIZE, iso7816_3_status_unexpected_card_response);
         atr->historical_bytes_offset = i;
 
-        SAFE_INCREMENT_N(i, atr->historical_bytes_len - 1, MAX_ATR_SIZE, iso7816_3_status_unexpected_card_response);
-        r = transport_recv_bytes(transport, atr->atr + atr->historical_bytes_offset, atr->historical_bytes_len);
+        SAFE_INCREMENT_N(i, atr->historical_bytes_len - 1, ATR_MAX_SIZE, iso7816_3_status_unexpected_card_response);
+        r = recv_atr_bytes(transport, inverse, atr->atr + atr->historical_bytes_offset, atr->historical_bytes_len);
         RETURN_ON_TRANSPORT_ERROR(r);
     }
 
     if (is_tck_present(atr)) {
         uint8_t tck;
-        r = transport_recv_byte(transport, &tck);
+        r = recv_atr_byte(transport, inverse, &tck);
         RETURN_ON_TRANSPORT_ERROR(r);
-        SAFE_INCREMENT(i, MAX_ATR_SIZE, iso7816_3_status_unexpected_card_response);
+        SAFE_INCREMENT(i, ATR_MAX_SIZE, iso7816_3_status_unexpected_card_response);
         atr->tck_offset = i;
         atr->atr[i] = tck;
 
@@ -174,11 +196,49 @@ iso7816_3_status_t read_atr(const transport_t* transport, atr_t* atr) {
 
 static void init_atr_info(atr_info_t* info) {
     memset(info, 0, sizeof(*info));
+
+    info->t1.ifsc = T1_DEFAULT_IFS;
+    info->t1.cwi = T1_DEFAULT_CWI;
+    info->t1.bwi = T1_DEFAULT_BWI;
+}
+
+static void parse_t1_params(const atr_t* atr, t1_params_t* t1) {
+    bool ta_is_parsed = false;
+    bool tb_is_parsed = false;
+    bool tc_is_parsed = false;
+
+    // TA_i, TB_i and TC_i (i > 2) are specific to the protocol indicated in TD_(i-1)
+    for (size_t i = 2; i < MAX_INTERFACE_BYTES_COUNT && atr->td_offset[i - 1] != BAD_ATR_OFFSET; ++i) {
+        if (LOWOCT(atr->atr[atr->td_offset[i - 1]]) != PROTOCOL_T1)
+            continue;
+
+        if (!ta_is_parsed && atr->ta_offset[i] != BAD_ATR_OFFSET) {
+            uint8_t ifsc = atr->atr[atr->ta_offset[i]];
+            // 0x00 and 0xFF are reserved
+            if (ifsc != 0x00 && ifsc != 0xFF)
+                t1->ifsc = ifsc;
+            ta_is_parsed = true;
+        }
+
+        if (!tb_is_parsed && atr->tb_offset[i] != BAD_ATR_OFFSET) {
+            uint8_t tb = atr->atr[atr->tb_offset[i]];
+            t1->cwi = LOWOCT(tb);
+            t1->bwi = HIOCT(tb);
+            tb_is_parsed = true;
+        }
+
+        if (!tc_is_parsed && atr->tc_offset[i] != BAD_ATR_OFFSET) {
+            t1->use_crc = !!NTH_BIT_ONLY(atr->atr[atr->tc_offset[i]], 1);
+            tc_is_parsed = true;
+        }
+    }
 }
 
 iso7816_3_status_t parse_atr(const atr_t* atr, atr_info_t* info) {
     init_atr_info(info);
 
+    info->inverse_convention = atr->atr[0] == ATR_TS_INVERSE;
+
     if (atr->ta_offset[0] != BAD_ATR_OFFSET) {
         uint8_t ta1 = atr->atr[atr->ta_offset[0]];
 
@@ -217,5 +277,7 @@ iso7816_3_status_t parse_atr(const atr_t* atr, atr_info_t* info) {
         info->explicit_protocols[protocol] = true;
     }
 
+    parse_t1_params(atr, &info->t1);
+
     return iso7816_3_status_ok;
 }
@@ -70,8 +70,9 @@ iso7816_3_status_t compute_extra_gt(uint32_t f, uint32_t d, const atr_info_t* at
         r = ((double)fi) / di;
     }
 
-    // calculating in double to avoid integer overflows during calculation
-    *extra_gt_us = (uint32_t)(S_TO_US_MULTIPLIER_LF * r * atr_info->tc1.n / freq);
+    // calculating in double to avoid integer overflows during calculation,
+    // rounded up as the guard time is the least delay the card accepts
+    *extra_gt_us = (uint32_t)ceil(S_TO_US_MULTIPLIER_LF * r * atr_info->tc1.n / freq);
 
     return iso7816_3_status_ok;
 }
@@ -92,4 +93,25 @@ iso7816_3_status_t compute_wt(const atr_info_t* atr_info, uint32_t freq, double*
     *wt = wi * 960 * fi / freq;
 
     return iso7816_3_status_ok;
-}
\ No newline at end of file
+}
+
+iso7816_3_status_t compute_bwt(uint32_t f, uint32_t d, const atr_info_t* atr_info, uint32_t freq, double* bwt) {
+    // BWI values above 9 are reserved
+    if (atr_info->t1.bwi > 9) {
+        LOG_RETURN_ISO7816_3_ERROR_MSG(iso7816_3_status_invalid_params, "Card block waiting time is invalid");
+    }
+
+    uint32_t fd = f_freq_max_by_index(f_d_index_default.f_index)->f;
+
+    // BWT = 11 etu + 2^BWI * 960 * Fd / f
+    *bwt = (11. * f / d + (double)(1u << atr_info->t1.bwi) * 960 * fd) / freq;
+
+    return iso7816_3_status_ok;
+}
+
+iso7816_3_status_t compute_cwt(uint32_t f, uint32_t d, const atr_info_t* atr_info, uint32_t freq, double* cwt) {
+    // CWT = (11 + 2^CWI) etu
+    *cwt = (11. + (double)(1u << atr_info->t1.cwi)) * f / d / freq;
+
+    return iso7816_3_status_ok;
+}
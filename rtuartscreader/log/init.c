@@ -5,7 +5,7 @@
 
 #include <rtuartscreader/log/init.h>
 
-#include <stdbool.h>
+#include <pthread.h>
 #include <stdlib.h>
 
 #include <dlfcn.h>
@@ -30,12 +30,9 @@ static const log_level_t kLogLevelAll = (LOG_LEVEL_CRITICAL //
                                          | LOG_LEVEL_INFO   //
                                          | LOG_LEVEL_PERIODIC);
 
-static bool gLogIsInitialized = false;
-
-void init_log() {
-    if (gLogIsInitialized) return;
-    gLogIsInitialized = true;
+static pthread_once_t gLogIsInitialized = PTHREAD_ONCE_INIT;
 
+static void do_init_log() {
     log_level_t logLevel = LOG_LEVEL_CRITICAL | LOG_LEVEL_ERROR;
 
     void* logFunction = dlsym((void*)0, "log_msg");
@@ -53,4 +50,8 @@ void init_log() {
     }
 
     log_init(logLevel, logFunction, log_convert_to_priority);
-}
\ No newline at end of file
+}
+
+void init_log() {
+    pthread_once(&gLogIsInitialized, do_init_log);
+}
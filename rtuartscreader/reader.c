@@ -3,25 +3,86 @@
 // BSD license. See the LICENSE file found in the top-level directory of this
 // distribution.
 
+#define _GNU_SOURCE
+
 #include <rtuartscreader/reader.h>
 
+#include <ctype.h>
+#include <errno.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include <log/log.h>
 
 #include <rtuartscreader/iso7816_3/apdu_t0.h>
+#include <rtuartscreader/iso7816_3/apdu_t1.h>
+#include <rtuartscreader/iso7816_3/detail/apdu.h>
 #include <rtuartscreader/reader_detail.h>
 #include <rtuartscreader/transport/initialize.h>
+#include <rtuartscreader/transport/presence.h>
 #include <rtuartscreader/transport/reset.h>
 #include <rtuartscreader/transport/sendrecv.h>
 #include <rtuartscreader/utils/common.h>
+#include <rtuartscreader/utils/counter.h>
 #include <rtuartscreader/utils/error.h>
+#include <rtuartscreader/utils/monotonic.h>
+#include <rtuartscreader/utils/realtime.h>
+
+#define US_IN_MS 1000
+#define LATENCY_PROBE_PERIOD_US (60 * 1000 * US_IN_MS)
+
+// Milliseconds as decimal digits only, strtoul alone would take a sign, spaces and garbage after the number
+static bool parse_presence_ttl(const char* ttl, uint32_t* ttlMs) {
+    char* end;
+
+    if (!isdigit((unsigned char)ttl[0])) {
+        return false;
+    }
+
+    errno = 0;
+    unsigned long r = strtoul(ttl, &end, 10);
+    if (*end || errno == ERANGE || r > UINT32_MAX) {
+        return false;
+    }
+
+    *ttlMs = (uint32_t)r;
+
+    return true;
+}
+
+static void init_presence_probe(Reader* reader) {
+    const char* probe = getenv("LIBRTUARTSCREADER_presenceProbe");
+    const char* ttl = getenv("LIBRTUARTSCREADER_presenceTtl");
+
+    reader->presenceProbe = reader_presence_probe_reset;
+    if (probe && !strcmp(probe, "atr")) {
+        reader->presenceProbe = reader_presence_probe_atr;
+    } else if (probe && strcmp(probe, "reset")) {
+        LOG_ERROR("Unknown presence probe: %s, reset is used", probe);
+    }
+
+    reader->presenceTtlMs = 0;
+    if (ttl && !parse_presence_ttl(ttl, &reader->presenceTtlMs)) {
+        LOG_ERROR("Invalid presence TTL: %s, the card is probed on every check", ttl);
+    }
+}
 
 reader_status_t reader_open(Reader* reader, const char* readerName) {
+    reader->transport.atr_cache = &reader->atrCache;
+    reader->transport.atr_info = &reader->atrInfo;
+
     transport_status_t r = transport_initialize(&reader->transport, readerName);
     POPULATE_ERROR(r, transport_status_ok, reader_status_internal_error);
 
+    init_presence_probe(reader);
+    reader->transport.timeouts = &reader->stats.timeouts;
+
+    // Page faults during the exchange may delay the echo or the answer beyond WT
+    if (realtime_config_enabled(&reader->transport.realtime)) {
+        realtime_lock_memory();
+    }
+
     return reader_status_ok;
 }
 
@@ -39,15 +100,69 @@ reader_status_t reader_get_atr(Reader const* reader, UCHAR const** atr, DWORD* l
     return reader_status_ok;
 }
 
-static reader_status_t reader_reset_impl(Reader* reader) {
+static void enter_realtime(Reader* reader, realtime_context_t* context) {
+    if (!realtime_config_enabled(&reader->transport.realtime)) {
+        context->scheduled = context->pinned = false;
+        return;
+    }
+
+    if (!realtime_enter(&reader->transport.realtime, context)) {
+        return;
+    }
+
+    // The probe sleeps itself, so it is not repeated on every exchange
+    uint64_t now_us = monotonic_us();
+    if (!reader->latencyProbedUs || now_us - reader->latencyProbedUs >= LATENCY_PROBE_PERIOD_US) {
+        reader->latencyProbedUs = now_us;
+        reader_stats_record_us(reader->stats.sched_latency_us, realtime_measure_latency_us());
+    }
+}
+
+static void record_reset(Reader* reader, uint64_t start_us) {
+    counter_add(&reader->stats.resets, 1);
+    reader_stats_record_us(reader->stats.reset_us, monotonic_us() - start_us);
+    if (reader->transport.pps_exchanged) {
+        reader_stats_record_us(reader->stats.pps_us, reader->transport.pps_us);
+    }
+}
+
+static reader_status_t reset_and_negotiate(Reader* reader, bool warm) {
     size_t atrLength;
-    transport_status_t r = transport_reset(&reader->transport, reader->atr, &atrLength);
+    uint64_t start_us = monotonic_us();
+    transport_status_t r = warm ? transport_warm_reset(&reader->transport, reader->atr, &atrLength)
+                                : transport_reset(&reader->transport, reader->atr, &atrLength);
+    record_reset(reader, start_us);
     POPULATE_ERROR(r, transport_status_ok, reader_status_internal_error);
     reader->atrLength = atrLength;
 
+    if (reader->transport.protocol == PROTOCOL_T1) {
+        t1_context_init(&reader->t1, &reader->atrInfo.t1);
+
+        // The card keeps sending blocks of default size if it does not accept IFSD
+        iso7816_3_status_t iso_r = t1_negotiate_ifsd(&reader->transport, &reader->t1, T1_MAX_IFS);
+        if (iso_r != iso7816_3_status_ok) {
+            LOG_ERROR("IFSD negotiation failed, default IFSD is used");
+        }
+    }
+
     return reader_status_ok;
 }
 
+static reader_status_t do_reader_reset(Reader* reader, bool warm) {
+    realtime_context_t realtime;
+    enter_realtime(reader, &realtime);
+
+    reader_status_t r = reset_and_negotiate(reader, warm);
+
+    realtime_leave(&realtime);
+
+    return r;
+}
+
+static reader_status_t reader_reset_impl(Reader* reader) {
+    return do_reader_reset(reader, false);
+}
+
 reader_status_t reader_power_off(Reader* reader) {
     if (reader->power == POWERED_OFF) {
         return reader_status_ok;
@@ -63,12 +178,8 @@ reader_status_t reader_power_off(Reader* reader) {
     return reader_status_ok;
 }
 
-reader_status_t reader_power_on(Reader* reader, UCHAR const** atr, DWORD* length) {
-    return reader_reset(reader, atr, length);
-}
-
-reader_status_t reader_reset(Reader* reader, UCHAR const** atr, DWORD* length) {
-    reader_status_t r = reader_reset_impl(reader);
+static reader_status_t reader_power_up(Reader* reader, bool warm, UCHAR const** atr, DWORD* length) {
+    reader_status_t r = do_reader_reset(reader, warm);
     if (r != reader_status_ok) {
         reader->power = POWERED_OFF;
         return r;
@@ -79,6 +190,87 @@ reader_status_t reader_reset(Reader* reader, UCHAR const** atr, DWORD* length) {
     return reader_get_atr(reader, atr, length);
 }
 
+reader_status_t reader_power_on(Reader* reader, UCHAR const** atr, DWORD* length) {
+    return reader_power_up(reader, false, atr, length);
+}
+
+// The warm reset is possible only if the card is powered and clocked already
+reader_status_t reader_reset(Reader* reader, UCHAR const** atr, DWORD* length) {
+    return reader_power_up(reader, reader->power == POWERED_ON, atr, length);
+}
+
+// Every command exchanged with the card is counted, the ones sent by the driver itself included
+static iso7816_3_status_t transmit_apdu(Reader* reader, UCHAR const* txBuffer, size_t txLength, UCHAR* rxBuffer,
+                                        size_t* rxLength) {
+    iso7816_3_status_t r;
+    if (reader->transport.protocol == PROTOCOL_T1) {
+        r = t1_transmit_apdu(&reader->transport, &reader->t1, txBuffer, txLength, rxBuffer, rxLength);
+    } else {
+        r = t0_transmit_apdu(&reader->transport, txBuffer, txLength, rxBuffer, rxLength);
+    }
+
+    counter_add(&reader->stats.apdus, 1);
+    counter_add(&reader->stats.bytes_sent, (uint32_t)txLength);
+    if (r == iso7816_3_status_ok) {
+        counter_add(&reader->stats.bytes_received, (uint32_t)*rxLength);
+    }
+
+    return r;
+}
+
+// Repeats the short APDU with the exact Le on 6CXX and retrieves the data announced by 61XX
+// with GET RESPONSE, as long as it fits the response buffer. Only a 5-byte case 2 command
+// (header and Le) is repeated: 6CXX answers a wrong Le, which the other cases do not carry
+// or carry after the data.
+static iso7816_3_status_t transmit_apdu_with_response(Reader* reader, UCHAR const* txBuffer, size_t txLength,
+                                                      UCHAR* rxBuffer, size_t* rxLength) {
+    size_t rxCapacity = *rxLength;
+
+    iso7816_3_status_t r = transmit_apdu(reader, txBuffer, txLength, rxBuffer, rxLength);
+    POPULATE_ERROR(r, iso7816_3_status_ok, r);
+
+    if (txLength == APDU_HEADER_SIZE && *rxLength == 2 && rxBuffer[0] == SW1_WRONG_LENGTH) {
+        UCHAR apdu[APDU_HEADER_SIZE];
+        memcpy(apdu, txBuffer, APDU_HEADER_SIZE - 1);
+        apdu[APDU_P3_OFFSET] = rxBuffer[1];
+
+        *rxLength = rxCapacity;
+        r = transmit_apdu(reader, apdu, sizeof(apdu), rxBuffer, rxLength);
+        POPULATE_ERROR(r, iso7816_3_status_ok, r);
+    }
+
+    while (*rxLength >= 2 && rxBuffer[*rxLength - 2] == SW1_RESPONSE_BYTES_AVAILABLE) {
+        size_t dataLength = *rxLength - 2;
+        size_t freeSpace = rxCapacity - *rxLength;
+        size_t ne = le_to_ne(rxBuffer[*rxLength - 1]);
+        if (ne > freeSpace) {
+            ne = freeSpace;
+        }
+
+        if (!ne) {
+            break;
+        }
+
+        UCHAR getResponse[APDU_HEADER_SIZE] = {
+            get_response_cla(txBuffer[APDU_CLA_OFFSET]), APDU_INS_GET_RESPONSE, 0x00, 0x00, (UCHAR)ne
+        };
+
+        size_t length = rxCapacity - dataLength;
+        r = transmit_apdu(reader, getResponse, sizeof(getResponse), rxBuffer + dataLength, &length);
+        POPULATE_ERROR(r, iso7816_3_status_ok, r);
+
+        *rxLength = dataLength + length;
+
+        // the card has not sent any data, avoid looping forever
+        if (length == 2) {
+            break;
+        }
+    }
+
+    return iso7816_3_status_ok;
+}
+
+
 reader_status_t reader_transmit(Reader* reader, UCHAR const* txBuffer, DWORD txLength, UCHAR* rxBuffer, PDWORD rxLength) {
     iso7816_3_status_t r = iso7816_3_status_ok;
 
@@ -86,32 +278,33 @@ reader_status_t reader_transmit(Reader* reader, UCHAR const* txBuffer, DWORD txL
         return reader_status_reader_unpowered;
     }
 
-    uint16_t sendLength;
-    uint16_t recvLength;
-
     if ((txBuffer == NULL && txLength != 0) || rxLength == NULL) {
         LOG_ERROR("reader_transmit failed: wrong args");
 
         return reader_status_internal_error;
     }
 
-    if (txLength > UINT16_MAX)
-        return reader_status_internal_error;
-    else
-        sendLength = txLength;
+    size_t recvLength = *rxLength;
+    realtime_context_t realtime;
+    enter_realtime(reader, &realtime);
 
-    if (*rxLength > UINT16_MAX)
-        recvLength = UINT16_MAX;
-    else
-        recvLength = *rxLength;
+    uint64_t start_us = monotonic_us();
 
-    r = t0_transmit_apdu(&reader->transport, txBuffer, sendLength, rxBuffer, &recvLength);
+    if (reader->autoGetResponse) {
+        r = transmit_apdu_with_response(reader, txBuffer, txLength, rxBuffer, &recvLength);
+    } else {
+        r = transmit_apdu(reader, txBuffer, txLength, rxBuffer, &recvLength);
+    }
+
+    realtime_leave(&realtime);
 
     if (r == iso7816_3_status_ok)
         *rxLength = recvLength;
     else
         *rxLength = 0;
 
+    reader_stats_record_us(reader->stats.transmit_us, monotonic_us() - start_us);
+
     // TODO: figure out whether to reset the card in case of communication error
     if (r == iso7816_3_status_communication_error) {
         return reader_status_communication_error;
@@ -124,21 +317,165 @@ reader_status_t reader_transmit(Reader* reader, UCHAR const* txBuffer, DWORD txL
     return reader_status_ok;
 }
 
-reader_status_t reader_is_present(Reader* reader) {
-    if (reader->presence == PRESENT_FALSE || reader->power == POWERED_OFF) {
+typedef reader_status_t (*presence_probe_fn)(Reader* reader);
+
+static uint64_t monotonic_ms() {
+    return monotonic_us() / US_IN_MS;
+}
+
+// The card is left negotiated, so it is ready for the exchange once it is powered up
+static reader_status_t probe_by_reset(Reader* reader) {
+    return reader_reset_impl(reader);
+}
+
+// No PPS and IFSD exchange, the card is negotiated by the reset on power up
+static reader_status_t probe_by_atr(Reader* reader) {
+    size_t atrLength;
+    transport_status_t r = transport_probe_atr(&reader->transport, reader->atr, &atrLength);
+    POPULATE_ERROR(r, transport_status_ok, reader_status_internal_error);
+    reader->atrLength = atrLength;
+
+    return reader_status_ok;
+}
+
+static const presence_probe_fn kPresenceProbes[] = {
+    [reader_presence_probe_reset] = probe_by_reset,
+    [reader_presence_probe_atr] = probe_by_atr
+};
+
+static reader_status_t probe_detect_line(Reader* reader) {
+    transport_status_t r = transport_detect_card(&reader->transport.hw, &reader->cardDetected);
+    POPULATE_ERROR(r, transport_status_ok, reader_status_internal_error);
+
+    // The card is not touched while it is out, it is reset once it is back
+    if (!reader->cardDetected) {
         reader->presence = PRESENT_FALSE;
-        reader_status_t r = reader_reset_impl(reader);
-        POPULATE_ERROR(r, reader_status_ok, reader_status_reader_not_found);
-    } else {
+        reader->power = POWERED_OFF;
+        return reader_status_reader_not_found;
+    }
+
+    reader->presence = PRESENT_TRUE;
+    return reader_status_ok;
+}
+
+static bool is_presence_cached(const Reader* reader) {
+    return reader->presence == PRESENT_TRUE && reader->presenceTtlMs &&
+           monotonic_ms() - reader->presenceCheckedMs < reader->presenceTtlMs;
+}
+
+reader_status_t reader_is_present(Reader* reader) {
+    // The detect line is cheap and reliable, the card is not touched at all
+    if (transport_has_card_detect(&reader->transport.hw)) {
+        return probe_detect_line(reader);
+    }
+
+    if (reader->presence == PRESENT_TRUE && reader->power == POWERED_ON) {
         // TODO: FIX ME: Can not transmit APDU to check card presence, because it may break
         // communication performed by upstack application with the card, if the presence
         // check call occures when card expects GET DATA APDU in response to 61XX SW.
+        return reader_status_ok;
     }
 
+    if (is_presence_cached(reader)) {
+        return reader_status_ok;
+    }
+
+    // A powered card is probed with the full reset to keep it ready for the exchange
+    presence_probe_fn probe = reader->power == POWERED_ON ? probe_by_reset : kPresenceProbes[reader->presenceProbe];
+
+    reader->presence = PRESENT_FALSE;
+    reader_status_t r = probe(reader);
+    POPULATE_ERROR(r, reader_status_ok, reader_status_reader_not_found);
+
     reader->presence = PRESENT_TRUE;
+    reader->presenceCheckedMs = monotonic_ms();
+    return reader_status_ok;
+}
+
+reader_status_t reader_set_presence_probe(Reader* reader, reader_presence_probe_t probe, uint32_t ttl_ms) {
+    if ((size_t)probe >= ARRAYSIZE(kPresenceProbes)) {
+        return reader_status_internal_error;
+    }
+
+    reader->presenceProbe = probe;
+    reader->presenceTtlMs = ttl_ms;
+
     return reader_status_ok;
 }
 
 reader_status_t reader_is_powered(const Reader* reader) {
     return reader->power == POWERED_ON ? reader_status_ok : reader_status_reader_unpowered;
 }
+
+reader_status_t reader_get_protocol(const Reader* reader, DWORD* protocol) {
+    if (reader->power != POWERED_ON) {
+        return reader_status_reader_unpowered;
+    }
+
+    *protocol = reader->transport.protocol == PROTOCOL_T1 ? SCARD_PROTOCOL_T1 : SCARD_PROTOCOL_T0;
+
+    return reader_status_ok;
+}
+
+reader_status_t reader_watch_presence(const Reader* reader, reader_presence_watch_t* watch) {
+    if (!transport_has_card_detect(&reader->transport.hw)) {
+        return reader_status_not_supported;
+    }
+
+    watch->hw = reader->transport.hw;
+    watch->present = reader->cardDetected;
+
+    return reader_status_ok;
+}
+
+reader_status_t reader_wait_presence_change(const reader_presence_watch_t* watch, uint32_t timeout_ms) {
+    transport_status_t r = transport_wait_card_change(&watch->hw, watch->present, timeout_ms);
+    if (r == transport_status_timeout) {
+        return reader_status_timeout;
+    }
+    POPULATE_ERROR(r, transport_status_ok, reader_status_internal_error);
+
+    return reader_status_ok;
+}
+
+reader_status_t reader_cancel_presence_wait(const Reader* reader) {
+    if (!transport_has_card_detect(&reader->transport.hw)) {
+        return reader_status_not_supported;
+    }
+
+    transport_status_t r = transport_cancel_card_wait(&reader->transport.hw);
+    POPULATE_ERROR(r, transport_status_ok, reader_status_internal_error);
+
+    return reader_status_ok;
+}
+
+reader_status_t reader_set_auto_get_response(Reader* reader, bool enabled) {
+    reader->autoGetResponse = enabled;
+
+    return reader_status_ok;
+}
+
+reader_status_t reader_get_auto_get_response(const Reader* reader, bool* enabled) {
+    *enabled = reader->autoGetResponse;
+
+    return reader_status_ok;
+}
+
+reader_status_t reader_get_atr_cache_stats(const Reader* reader, uint32_t* hits, uint32_t* misses) {
+    *hits = reader->atrCache.hits;
+    *misses = reader->atrCache.misses;
+
+    return reader_status_ok;
+}
+
+reader_status_t reader_get_reconfig_stats(const Reader* reader, transport_reconfig_stats_t* stats) {
+    *stats = reader->transport.reconfig_stats;
+
+    return reader_status_ok;
+}
+
+reader_status_t reader_get_stats(const Reader* reader, reader_stats_t* stats) {
+    reader_stats_snapshot(&reader->stats, stats);
+
+    return reader_status_ok;
+}
@@ -5,56 +5,174 @@
 
 #include <rtuartscreader/reader_list.h>
 
+#include <pthread.h>
 #include <stdbool.h>
 #include <stddef.h>
 
+#include <log/log.h>
+
 #include <rtuartscreader/reader_detail.h>
 
 #define arraysize(array) (sizeof(array) / sizeof(array[0]))
 
+// List lock guards initialized and lun fields of all entries and is held only
+// while the list is scanned. Entry lock guards the reader and is held for the
+// whole operation on it. Entry fields are changed under both locks, so they may
+// be checked under any of them. The entry lock is never waited for with the
+// list lock held, except for a free entry in alloc, which is held only
+// for a moment by a thread which lost the race for it.
 typedef struct {
+    pthread_mutex_t lock;
     bool initialized;
     DWORD lun;
+    bool has_gpios;
+    hw_config_t gpios; // RST and clock GPIOs reserved by the reader
     Reader reader;
 } ReaderEntry;
 
-static const ReaderEntry kEmptyReaderEntry;
+static const Reader kEmptyReader;
+
+static pthread_rwlock_t gReaderListLock = PTHREAD_RWLOCK_INITIALIZER;
 
 static ReaderEntry gReaderList[gReaderListSize];
 
-Reader* reader_list_alloc_reader(DWORD lun) {
+// Entry locks are initialized before the first entry is allocated, the other
+// functions reach only the allocated ones
+static pthread_once_t gReaderListOnce = PTHREAD_ONCE_INIT;
+
+static void init_reader_list(void) {
     size_t i;
 
     for (i = 0; i < arraysize(gReaderList); ++i) {
-        if (!gReaderList[i].initialized) {
-            gReaderList[i].lun = lun;
-            gReaderList[i].initialized = true;
-            return &(gReaderList[i].reader);
-        }
+        pthread_mutex_init(&gReaderList[i].lock, NULL);
     }
-
-    return NULL;
 }
 
-Reader* reader_list_get_reader(DWORD lun) {
+static ReaderEntry* find_entry(DWORD lun) {
     size_t i;
 
     for (i = 0; i < arraysize(gReaderList); ++i) {
         if (gReaderList[i].initialized && gReaderList[i].lun == lun) {
-            return &(gReaderList[i].reader);
+            return &gReaderList[i];
         }
     }
 
     return NULL;
 }
 
-void reader_list_free_reader(DWORD lun) {
+static ReaderEntry* reader_to_entry(Reader* reader) {
+    return (ReaderEntry*)((char*)reader - offsetof(ReaderEntry, reader));
+}
+
+Reader* reader_list_alloc_reader(DWORD lun) {
+    ReaderEntry* entry = NULL;
     size_t i;
 
+    pthread_once(&gReaderListOnce, init_reader_list);
+
+    pthread_rwlock_wrlock(&gReaderListLock);
+
+    if (!find_entry(lun)) {
+        for (i = 0; i < arraysize(gReaderList); ++i) {
+            if (!gReaderList[i].initialized) {
+                entry = &gReaderList[i];
+                pthread_mutex_lock(&entry->lock);
+                entry->lun = lun;
+                entry->initialized = true;
+                break;
+            }
+        }
+    }
+
+    pthread_rwlock_unlock(&gReaderListLock);
+
+    return entry ? &entry->reader : NULL;
+}
+
+Reader* reader_list_acquire_reader(DWORD lun) {
+    pthread_rwlock_rdlock(&gReaderListLock);
+    ReaderEntry* entry = find_entry(lun);
+    pthread_rwlock_unlock(&gReaderListLock);
+
+    if (!entry) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&entry->lock);
+
+    // the reader might have been freed while waiting for it
+    if (!entry->initialized || entry->lun != lun) {
+        pthread_mutex_unlock(&entry->lock);
+        return NULL;
+    }
+
+    return &entry->reader;
+}
+
+// The exchange is logged once the operation on the reader is complete
+void reader_list_release_reader(Reader* reader) {
+    log_flush_deferred();
+    pthread_mutex_unlock(&reader_to_entry(reader)->lock);
+}
+
+static bool gpio_is_used(const hw_config_t* config, unsigned gpio) {
+    return config->rst_pin == gpio || config->clock_pin == gpio;
+}
+
+bool reader_list_reserve_gpios(Reader* reader, const hw_config_t* config) {
+    ReaderEntry* entry = reader_to_entry(reader);
+    bool reserved = true;
+    size_t i;
+
+    pthread_rwlock_wrlock(&gReaderListLock);
+
     for (i = 0; i < arraysize(gReaderList); ++i) {
-        if (gReaderList[i].initialized && gReaderList[i].lun == lun) {
-            gReaderList[i] = kEmptyReaderEntry;
-            return;
+        const ReaderEntry* other = &gReaderList[i];
+        if (other == entry || !other->initialized || !other->has_gpios) {
+            continue;
         }
+
+        if (gpio_is_used(&other->gpios, config->rst_pin) || gpio_is_used(&other->gpios, config->clock_pin)) {
+            LOG_ERROR("RST GPIO %u or clock GPIO %u is used by reader with Lun %lu", config->rst_pin,
+                      config->clock_pin, other->lun);
+            reserved = false;
+            break;
+        }
+    }
+
+    if (reserved) {
+        entry->gpios = *config;
+        entry->has_gpios = true;
+    }
+
+    pthread_rwlock_unlock(&gReaderListLock);
+
+    return reserved;
+}
+
+void reader_list_free_reader(Reader* reader) {
+    ReaderEntry* entry = reader_to_entry(reader);
+
+    log_flush_deferred();
+
+    pthread_rwlock_wrlock(&gReaderListLock);
+    entry->initialized = false;
+    entry->lun = 0;
+    entry->has_gpios = false;
+    entry->reader = kEmptyReader;
+    pthread_rwlock_unlock(&gReaderListLock);
+
+    pthread_mutex_unlock(&entry->lock);
+}
+
+bool reader_list_get_stats(DWORD lun, reader_stats_t* stats) {
+    // the list lock keeps the entry from being freed while it is read
+    pthread_rwlock_rdlock(&gReaderListLock);
+    ReaderEntry* entry = find_entry(lun);
+    if (entry) {
+        reader_get_stats(&entry->reader, stats);
     }
+    pthread_rwlock_unlock(&gReaderListLock);
+
+    return entry != NULL;
 }
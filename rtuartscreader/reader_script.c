@@ -0,0 +1,170 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#include <rtuartscreader/reader_script.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <rtuartscreader/log/log.h>
+#include <rtuartscreader/utils/buffer_view.h>
+
+#define MAX_RESPONSE_LENGTH UINT16_MAX
+
+typedef struct {
+    uint16_t apdu_length;
+    uint16_t sw;
+    uint16_t sw_mask;
+    const uint8_t* apdu;
+} script_step_t;
+
+static uint16_t pop_u16(pop_front_buffer_view* buffer) {
+    uint16_t value;
+    memcpy(&value, pop_front_buffer_view_pop_n(buffer, sizeof(value)), sizeof(value));
+    return value;
+}
+
+static void put_u16(uint8_t* output, uint16_t value) {
+    memcpy(output, &value, sizeof(value));
+}
+
+static bool pop_step(pop_front_buffer_view* script, script_step_t* step) {
+    if (pop_front_buffer_view_size(script) < READER_SCRIPT_STEP_HEADER_SIZE) {
+        return false;
+    }
+
+    step->apdu_length = pop_u16(script);
+    step->sw = pop_u16(script);
+    step->sw_mask = pop_u16(script);
+    if (pop_front_buffer_view_size(script) < step->apdu_length) {
+        return false;
+    }
+
+    step->apdu = pop_front_buffer_view_pop_n(script, step->apdu_length);
+    return true;
+}
+
+static bool validate_script(const UCHAR* script, DWORD scriptLength) {
+    if (!script || scriptLength < 1 || script[0] > reader_script_abort_on_mismatch) {
+        return false;
+    }
+
+    pop_front_buffer_view view;
+    pop_front_buffer_view_init(&view, script + 1, scriptLength - 1);
+
+    // the number of the steps run is reported as 16-bit
+    size_t steps = 0;
+    script_step_t step;
+    while (!pop_front_buffer_view_empty(&view)) {
+        if (!pop_step(&view, &step) || ++steps > READER_SCRIPT_MAX_STEPS) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool sw_matches(const script_step_t* step, const uint8_t* response, size_t length) {
+    if (length < 2) {
+        return false;
+    }
+
+    uint16_t sw = (uint16_t)(response[length - 2] << 8 | response[length - 1]);
+    return (sw & step->sw_mask) == (step->sw & step->sw_mask);
+}
+
+static void put_result(uint8_t* header, reader_script_step_status_t status, uint16_t length) {
+    header[0] = (uint8_t)status;
+    put_u16(header + 1, length);
+}
+
+// reader_script_step_output_truncated if the result does not fit, nothing is added then
+static reader_script_step_status_t run_step(Reader* reader, const script_step_t* step, push_back_buffer_view* output) {
+    size_t space = push_back_buffer_view_free_space(output);
+    if (space < READER_SCRIPT_RESULT_HEADER_SIZE) {
+        return reader_script_step_output_truncated;
+    }
+    space -= READER_SCRIPT_RESULT_HEADER_SIZE;
+
+    uint8_t* header = output->data + output->size;
+    uint8_t* response = header + READER_SCRIPT_RESULT_HEADER_SIZE;
+    DWORD length = space < MAX_RESPONSE_LENGTH ? space : MAX_RESPONSE_LENGTH;
+
+    reader_script_step_status_t status;
+    reader_status_t r = reader_transmit(reader, step->apdu, step->apdu_length, response, &length);
+    if (r == reader_status_memory_error) {
+        return reader_script_step_output_truncated;
+    }
+
+    if (r != reader_status_ok) {
+        LOG_ERROR("reader_transmit failed: %d", r);
+        status = reader_script_step_transmit_error;
+        length = 0;
+    } else if (!sw_matches(step, response, length)) {
+        status = reader_script_step_sw_mismatch;
+    } else {
+        status = reader_script_step_ok;
+    }
+
+    put_result(header, status, (uint16_t)length);
+    push_back_buffer_view_reserve_n(output, READER_SCRIPT_RESULT_HEADER_SIZE + length);
+
+    return status;
+}
+
+reader_status_t reader_run_script(Reader* reader, UCHAR const* script, DWORD scriptLength, UCHAR* output,
+                                  PDWORD outputLength) {
+    // nothing is sent to the card if the script is malformed
+    if (!validate_script(script, scriptLength) || !output || !outputLength) {
+        LOG_ERROR("reader_run_script failed: wrong args");
+
+        return reader_status_internal_error;
+    }
+
+    if (reader_is_powered(reader) != reader_status_ok) {
+        return reader_status_reader_unpowered;
+    }
+
+    // the result of the truncated step is put past the results of the steps
+    if (*outputLength < sizeof(uint16_t) + READER_SCRIPT_RESULT_HEADER_SIZE) {
+        return reader_status_memory_error;
+    }
+
+    push_back_buffer_view out;
+    push_back_buffer_view_init(&out, output, *outputLength - READER_SCRIPT_RESULT_HEADER_SIZE);
+    uint8_t* executed = push_back_buffer_view_reserve_n(&out, sizeof(uint16_t));
+
+    reader_script_policy_t policy = (reader_script_policy_t)script[0];
+    pop_front_buffer_view view;
+    pop_front_buffer_view_init(&view, script + 1, scriptLength - 1);
+
+    uint16_t steps = 0;
+    bool truncated = false;
+    script_step_t step;
+    while (!truncated && pop_step(&view, &step)) {
+        reader_script_step_status_t status = run_step(reader, &step, &out);
+
+        ++steps;
+
+        if (status == reader_script_step_output_truncated) {
+            truncated = true;
+        } else if (status == reader_script_step_transmit_error ||
+                   (status == reader_script_step_sw_mismatch && policy == reader_script_abort_on_mismatch)) {
+            break;
+        }
+    }
+
+    size_t length = push_back_buffer_view_size(&out);
+    if (truncated) {
+        put_result(output + length, reader_script_step_output_truncated, 0);
+        length += READER_SCRIPT_RESULT_HEADER_SIZE;
+    }
+
+    put_u16(executed, steps);
+    *outputLength = length;
+
+    return reader_status_ok;
+}
@@ -0,0 +1,43 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#include <rtuartscreader/reader_stats.h>
+
+#include <stddef.h>
+
+#include <rtuartscreader/utils/counter.h>
+
+static uint32_t bucket_of(uint64_t us) {
+    if (!us) {
+        return 0;
+    }
+
+    uint32_t bucket = 63 - __builtin_clzll(us);
+    return bucket < READER_STATS_BUCKETS ? bucket : READER_STATS_BUCKETS - 1;
+}
+
+static void snapshot_histogram(const uint32_t histogram[READER_STATS_BUCKETS],
+                               uint32_t snapshot[READER_STATS_BUCKETS]) {
+    for (size_t i = 0; i < READER_STATS_BUCKETS; ++i) {
+        snapshot[i] = counter_load(&histogram[i]);
+    }
+}
+
+void reader_stats_record_us(uint32_t histogram[READER_STATS_BUCKETS], uint64_t us) {
+    counter_add(&histogram[bucket_of(us)], 1);
+}
+
+void reader_stats_snapshot(const reader_stats_t* stats, reader_stats_t* snapshot) {
+    snapshot->version = READER_STATS_VERSION;
+    snapshot->apdus = counter_load(&stats->apdus);
+    snapshot->bytes_sent = counter_load(&stats->bytes_sent);
+    snapshot->bytes_received = counter_load(&stats->bytes_received);
+    snapshot->resets = counter_load(&stats->resets);
+    snapshot->timeouts = counter_load(&stats->timeouts);
+    snapshot_histogram(stats->transmit_us, snapshot->transmit_us);
+    snapshot_histogram(stats->reset_us, snapshot->reset_us);
+    snapshot_histogram(stats->pps_us, snapshot->pps_us);
+    snapshot_histogram(stats->sched_latency_us, snapshot->sched_latency_us);
+}
@@ -0,0 +1,47 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#include <rtuartscreader/transport/atr_cache.h>
+
+#include <string.h>
+
+#include <rtuartscreader/utils/common.h>
+
+static atr_cache_entry_t* find_entry(atr_cache_t* cache, const uint8_t* atr, size_t atr_len) {
+    size_t i;
+
+    for (i = 0; i < ARRAYSIZE(cache->entries); ++i) {
+        atr_cache_entry_t* entry = &cache->entries[i];
+        if (entry->is_valid && entry->atr_len == atr_len && !memcmp(entry->atr, atr, atr_len)) {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+const atr_cache_entry_t* atr_cache_find(atr_cache_t* cache, const uint8_t* atr, size_t atr_len) {
+    const atr_cache_entry_t* entry = find_entry(cache, atr, atr_len);
+
+    if (entry) {
+        ++cache->hits;
+    } else {
+        ++cache->misses;
+    }
+
+    return entry;
+}
+
+void atr_cache_store(atr_cache_t* cache, const atr_cache_entry_t* entry) {
+    atr_cache_entry_t* target = find_entry(cache, entry->atr, entry->atr_len);
+
+    if (!target) {
+        target = &cache->entries[cache->next];
+        cache->next = (cache->next + 1) % ARRAYSIZE(cache->entries);
+    }
+
+    *target = *entry;
+    target->is_valid = true;
+}
@@ -0,0 +1,48 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#include <rtuartscreader/transport/convention.h>
+
+#include <string.h>
+
+// Reversed and inverted bytes, the table is built by pairs of bits from the most significant ones
+#define R2(n) 0xff - (n), 0xff - ((n) + 2 * 64), 0xff - ((n) + 1 * 64), 0xff - ((n) + 3 * 64)
+#define R4(n) R2(n), R2((n) + 2 * 16), R2((n) + 1 * 16), R2((n) + 3 * 16)
+#define R6(n) R4(n), R4((n) + 2 * 4), R4((n) + 1 * 4), R4((n) + 3 * 4)
+
+static const uint8_t g_inverse_table[256] = { R6(0), R6(2), R6(1), R6(3) };
+
+#undef R2
+#undef R4
+#undef R6
+
+#define MASK_1 0x5555555555555555ULL
+#define MASK_2 0x3333333333333333ULL
+#define MASK_4 0x0f0f0f0f0f0f0f0fULL
+
+// Eight bytes are converted at once: the halves, the quarters and the single bits of
+// every byte are swapped, which keeps the bytes in place whatever the byte order is
+static uint64_t convert_word(uint64_t x) {
+    x = ((x >> 4) & MASK_4) | ((x & MASK_4) << 4);
+    x = ((x >> 2) & MASK_2) | ((x & MASK_2) << 2);
+    x = ((x >> 1) & MASK_1) | ((x & MASK_1) << 1);
+
+    return ~x;
+}
+
+void transport_convert_inverse(uint8_t* bytes, size_t len) {
+    size_t i = 0;
+
+    for (; len - i >= sizeof(uint64_t); i += sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, bytes + i, sizeof(word));
+        word = convert_word(word);
+        memcpy(bytes + i, &word, sizeof(word));
+    }
+
+    for (; i != len; ++i) {
+        bytes[i] = g_inverse_table[bytes[i]];
+    }
+}
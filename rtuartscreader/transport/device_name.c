@@ -0,0 +1,161 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#include <rtuartscreader/transport/device_name.h>
+
+#include <ctype.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <rtuartscreader/transport/detail/error.h>
+
+#define DEVICE_NAME_SEPARATOR ':'
+
+#define RST_PIN_KEY "rst="
+#define CLOCK_PIN_KEY "clk="
+#define GPCLK_PIN_KEY "gpclk="
+#define DETECT_PIN_KEY "det="
+#define DETECT_LOW_PIN_KEY "ndet="
+#define IO_PIN_KEY "io="
+#define REALTIME_PRIORITY_KEY "rt="
+#define CPU_KEY "cpu="
+
+static const char* const gOptionKeys[] = { RST_PIN_KEY,        CLOCK_PIN_KEY, GPCLK_PIN_KEY,         DETECT_PIN_KEY,
+                                           DETECT_LOW_PIN_KEY, IO_PIN_KEY,    REALTIME_PRIORITY_KEY, CPU_KEY };
+
+static transport_status_t parse_number(const char* value, size_t length, unsigned* number) {
+    char* end;
+
+    if (!length || !isdigit((unsigned char)value[0])) {
+        LOG_RETURN_TRANSPORT_ERROR(transport_status_invalid_device_name);
+    }
+
+    errno = 0;
+    unsigned long r = strtoul(value, &end, 10);
+    if ((size_t)(end - value) != length || errno == ERANGE || r != (unsigned)r) {
+        LOG_RETURN_TRANSPORT_ERROR(transport_status_invalid_device_name);
+    }
+
+    *number = (unsigned)r;
+
+    return transport_status_ok;
+}
+
+static bool match_key(const char* option, size_t length, const char* key, size_t* key_length) {
+    *key_length = strlen(key);
+
+    return length >= *key_length && !strncmp(option, key, *key_length);
+}
+
+static bool is_option(const char* segment, size_t length) {
+    size_t keyLength;
+
+    for (size_t i = 0; i < sizeof(gOptionKeys) / sizeof(gOptionKeys[0]); ++i) {
+        if (match_key(segment, length, gOptionKeys[i], &keyLength)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Paths may contain the separator themselves (/dev/serial/by-path/...-usb-0:1.2:1.0-port0),
+// so only the trailing segments starting with a known key are options
+static size_t find_path_length(const char* device_name) {
+    size_t pathLength = strlen(device_name);
+
+    for (size_t i = pathLength; i > 0; --i) {
+        if (device_name[i - 1] != DEVICE_NAME_SEPARATOR) {
+            continue;
+        }
+
+        if (!is_option(device_name + i, pathLength - i)) {
+            break;
+        }
+
+        pathLength = i - 1;
+    }
+
+    return pathLength;
+}
+
+static transport_status_t parse_priority(const char* value, size_t length, int* priority) {
+    unsigned number;
+    transport_status_t r = parse_number(value, length, &number);
+    POPULATE_ERROR(r, transport_status_ok, r);
+
+    if (number < REALTIME_MIN_PRIORITY || number > REALTIME_MAX_PRIORITY) {
+        LOG_RETURN_TRANSPORT_ERROR_MSG(transport_status_invalid_device_name, "priority is out of range: %u", number);
+    }
+
+    *priority = (int)number;
+
+    return transport_status_ok;
+}
+
+static transport_status_t parse_option(const char* option, size_t length, hw_config_t* config,
+                                       realtime_config_t* realtime) {
+    size_t keyLength;
+
+    if (match_key(option, length, RST_PIN_KEY, &keyLength)) {
+        return parse_number(option + keyLength, length - keyLength, &config->rst_pin);
+    } else if (match_key(option, length, CLOCK_PIN_KEY, &keyLength)) {
+        config->clock_source = hw_clock_pwm;
+        return parse_number(option + keyLength, length - keyLength, &config->clock_pin);
+    } else if (match_key(option, length, GPCLK_PIN_KEY, &keyLength)) {
+        config->clock_source = hw_clock_gpclk;
+        return parse_number(option + keyLength, length - keyLength, &config->clock_pin);
+    } else if (match_key(option, length, DETECT_PIN_KEY, &keyLength)) {
+        config->has_detect_pin = true;
+        config->detect_active_low = false;
+        return parse_number(option + keyLength, length - keyLength, &config->detect_pin);
+    } else if (match_key(option, length, DETECT_LOW_PIN_KEY, &keyLength)) {
+        config->has_detect_pin = true;
+        config->detect_active_low = true;
+        return parse_number(option + keyLength, length - keyLength, &config->detect_pin);
+    } else if (match_key(option, length, IO_PIN_KEY, &keyLength)) {
+        config->has_io_pin = true;
+        return parse_number(option + keyLength, length - keyLength, &config->io_pin);
+    } else if (match_key(option, length, REALTIME_PRIORITY_KEY, &keyLength)) {
+        return parse_priority(option + keyLength, length - keyLength, &realtime->priority);
+    } else if (match_key(option, length, CPU_KEY, &keyLength)) {
+        realtime->pin_cpu = true;
+        return parse_number(option + keyLength, length - keyLength, &realtime->cpu);
+    }
+
+    LOG_RETURN_TRANSPORT_ERROR_MSG(transport_status_invalid_device_name, "unknown option: %.*s", (int)length, option);
+}
+
+transport_status_t parse_device_name(const char* device_name, char* path, size_t path_size, hw_config_t* config,
+                                     realtime_config_t* realtime) {
+    *config = (hw_config_t){ .rst_pin = HW_DEFAULT_RST_PIN, .clock_pin = HW_DEFAULT_CLOCK_PIN };
+    *realtime = (realtime_config_t){ 0 };
+
+    size_t pathLength = find_path_length(device_name);
+    const char* option = device_name[pathLength] ? device_name + pathLength : NULL;
+
+    if (!pathLength || pathLength >= path_size) {
+        LOG_RETURN_TRANSPORT_ERROR(transport_status_invalid_device_name);
+    }
+
+    memcpy(path, device_name, pathLength);
+    path[pathLength] = '\0';
+
+    while (option) {
+        ++option;
+
+        const char* next = strchr(option, DEVICE_NAME_SEPARATOR);
+        size_t length = next ? (size_t)(next - option) : strlen(option);
+
+        transport_status_t r = parse_option(option, length, config, realtime);
+        POPULATE_ERROR(r, transport_status_ok, r);
+
+        option = next;
+    }
+
+    return transport_status_ok;
+}
@@ -0,0 +1,44 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#include <rtuartscreader/transport/engine.h>
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <rtuartscreader/log/log.h>
+#include <rtuartscreader/transport/initialize_wave.h>
+#include <rtuartscreader/transport/sendrecv.h>
+#include <rtuartscreader/transport/sendrecv_poll.h>
+#include <rtuartscreader/transport/sendrecv_wave.h>
+
+static pthread_once_t gTransportEngineIsInitialized = PTHREAD_ONCE_INIT;
+
+static void do_init_transport_engine() {
+    const char* engine = getenv("LIBRTUARTSCREADER_transportEngine");
+    if (!engine || !strcmp(engine, "tty")) {
+        return; // default sendrecv implementation
+    }
+
+    if (!strcmp(engine, "poll")) {
+        transport_sendrecv_impl_set(transport_sendrecv_poll_impl());
+        LOG_INFO("Transport engine: %s", engine);
+        return;
+    }
+
+    if (!strcmp(engine, "wave")) {
+        transport_initialize_impl_set(transport_initialize_wave_impl());
+        transport_sendrecv_impl_set(transport_sendrecv_wave_impl());
+        LOG_INFO("Transport engine: %s", engine);
+        return;
+    }
+
+    LOG_ERROR("Unknown transport engine: %s, tty is used", engine);
+}
+
+void init_transport_engine() {
+    pthread_once(&gTransportEngineIsInitialized, do_init_transport_engine);
+}
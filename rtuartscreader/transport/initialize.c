@@ -6,52 +6,45 @@
 #include <rtuartscreader/transport/initialize.h>
 
 #include <fcntl.h>
+#include <limits.h>
 #include <termios.h>
 #include <unistd.h>
 
-#include <rtuartscreader/hardware/hardware.h>
 #include <rtuartscreader/transport/detail/error.h>
+#include <rtuartscreader/transport/detail/initialize_common.h>
+#include <rtuartscreader/transport/detail/serial_speed.h>
 #include <rtuartscreader/transport/detail/transmit_params.h>
+#include <rtuartscreader/transport/device_name.h>
 
 
-static transport_status_t transport_setup_serial_settings(const transport_t* transport) {
-    struct termios options = { 0 };
-
-    int ret = tcgetattr(transport->handle, &options);
-    LOG_RETURN_ON_OS_ERROR(ret);
-
-    ret = cfsetispeed(&options, transport->params.transmit_speed.baudrate);
-    LOG_RETURN_ON_OS_ERROR(ret);
-
-    ret = cfsetospeed(&options, transport->params.transmit_speed.baudrate);
-    LOG_RETURN_ON_OS_ERROR(ret);
-
-    cfmakeraw(&options);
-
-    options.c_cflag |= CSTOPB | PARENB;
-    options.c_cflag &= ~PARODD;
-
-    options.c_cc[VMIN] = 0;
-
-    options.c_cc[VTIME] = transport->params.wt_ds;
+// Inverse convention characters have odd parity as UART sees them
+static bool is_odd_parity(const transmit_params_t* params) {
+    return params->convention == transport_convention_inverse;
+}
 
-    ret = tcsetattr(transport->handle, TCSANOW, &options);
-    LOG_RETURN_ON_OS_ERROR(ret);
+static transport_status_t transport_setup_serial_settings(const transport_t* transport) {
+    transport_status_t r = set_serial_settings(transport->handle, transport->params.transmit_speed.baudrate,
+                                               is_odd_parity(&transport->params), transport->params.wt_ds);
+    POPULATE_ERROR(r, transport_status_ok, r);
 
-    ret = tcflush(transport->handle, TCIOFLUSH);
+    int ret = tcflush(transport->handle, TCIOFLUSH);
     LOG_RETURN_ON_OS_ERROR(ret);
 
     return transport_status_ok;
 }
 
 transport_status_t transport_initialize_impl(transport_t* transport, const char* reader_name) {
-    hw_status_t hw_r;
     transport_status_t r;
     int os_r;
+    char path[PATH_MAX];
+
+    r = parse_device_name(reader_name, path, sizeof(path), &transport->hw, &transport->realtime);
+    if (r != transport_status_ok)
+        goto err_label;
 
     transport->params = *transmit_params_default();
 
-    transport->handle = open(reader_name, O_RDWR | O_NOCTTY);
+    transport->handle = open(path, O_RDWR | O_NOCTTY);
     if (transport->handle == -1) {
         LOG_OS_ERROR(transport->handle);
         r = transport_status_os_error;
@@ -62,31 +55,12 @@ transport_status_t transport_initialize_impl(transport_t* transport, const char*
     if (r != transport_status_ok)
         goto close_handle_label;
 
-    hw_r = hw_initialize();
-    if (hw_r != hw_status_ok) {
-        r = transport_status_hardware_error;
+    r = transport_hw_initialize(transport);
+    if (r != transport_status_ok)
         goto close_handle_label;
-    }
-
-    hw_r = hw_rst_initialize();
-    if (hw_r != hw_status_ok) {
-        r = transport_status_hardware_error;
-        goto deinit_library_label;
-    }
-
-    hw_r = hw_start_clock(transport->params.transmit_speed.freq);
-    if (hw_r != hw_status_ok) {
-        r = transport_status_hardware_error;
-        goto deinit_rst_pin_label;
-    }
 
     return transport_status_ok;
 
-deinit_rst_pin_label:
-    hw_r = hw_rst_deinitialize();
-    RETURN_ON_HW_ERROR(hw_r);
-deinit_library_label:
-    hw_deinitialize();
 close_handle_label:
     os_r = close(transport->handle);
     LOG_RETURN_ON_OS_ERROR(os_r);
@@ -94,29 +68,31 @@ err_label:
     return r;
 }
 
+// Only the settings which differ are applied: termios setup costs several syscalls
 transport_status_t transport_reinitialize_impl(transport_t* transport, const transmit_params_t* params) {
+    transmit_params_t old_params = transport->params;
     transport->params = *params;
 
-    transport_status_t r = transport_setup_serial_settings(transport);
-    POPULATE_ERROR(r, transport_status_ok, r);
+    if (old_params.transmit_speed.baudrate != params->transmit_speed.baudrate || old_params.wt_ds != params->wt_ds ||
+        is_odd_parity(&old_params) != is_odd_parity(params)) {
+        transport_status_t r = transport_setup_serial_settings(transport);
+        POPULATE_ERROR(r, transport_status_ok, r);
 
-    hw_status_t hw_r = hw_stop_clock();
-    RETURN_ON_HW_ERROR(hw_r);
+        ++transport->reconfig_stats.serial_setups;
+    } else {
+        // Drop the noise the card may have sent while RST was low
+        int os_r = tcflush(transport->handle, TCIOFLUSH);
+        LOG_RETURN_ON_OS_ERROR(os_r);
 
-    hw_r = hw_start_clock(transport->params.transmit_speed.freq);
-    RETURN_ON_HW_ERROR(hw_r);
+        ++transport->reconfig_stats.serial_setups_skipped;
+    }
 
-    return transport_status_ok;
+    return transport_hw_reconfigure_clock(transport, params->transmit_speed.freq);
 }
 
 transport_status_t transport_deinitialize_impl(const transport_t* transport) {
-    hw_status_t r = hw_stop_clock();
-    RETURN_ON_HW_ERROR(r);
-
-    r = hw_rst_deinitialize();
-    RETURN_ON_HW_ERROR(r);
-
-    hw_deinitialize();
+    transport_status_t r = transport_hw_deinitialize(transport);
+    POPULATE_ERROR(r, transport_status_ok, r);
 
     int os_r = close(transport->handle);
     LOG_RETURN_ON_OS_ERROR(os_r);
@@ -124,6 +100,10 @@ transport_status_t transport_deinitialize_impl(const transport_t* transport) {
     return transport_status_ok;
 }
 
+uint32_t transport_max_baudrate_impl(const transport_t* transport) {
+    return TRANSPORT_TTY_MAX_BAUDRATE;
+}
+
 #define PIMPL_NAME_PREFIX transport_initialize
 #define PIMPL_FUNCTIONS_DECLARATION_PATH <rtuartscreader/transport/detail/transport_initialize_functions.h>
 #include <rtuartscreader/pimpl/source.h>
\ No newline at end of file
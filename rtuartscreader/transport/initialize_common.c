@@ -0,0 +1,82 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#include <rtuartscreader/transport/detail/initialize_common.h>
+
+#include <rtuartscreader/hardware/hardware.h>
+#include <rtuartscreader/transport/detail/error.h>
+#include <rtuartscreader/transport/presence.h>
+
+transport_status_t transport_hw_initialize(transport_t* transport) {
+    hw_status_t hw_r;
+    transport_status_t r = transport_status_hardware_error;
+
+    hw_r = hw_initialize(&transport->hw);
+    if (hw_r != hw_status_ok)
+        goto err_label;
+
+    hw_r = hw_rst_initialize(&transport->hw);
+    if (hw_r != hw_status_ok)
+        goto deinit_library_label;
+
+    hw_r = hw_start_clock(&transport->hw, transport->params.transmit_speed.freq);
+    if (hw_r != hw_status_ok)
+        goto deinit_rst_pin_label;
+    transport->clock_freq = transport->params.transmit_speed.freq;
+
+    if (transport_has_card_detect(&transport->hw)) {
+        hw_r = hw_detect_initialize(&transport->hw);
+        if (hw_r != hw_status_ok)
+            goto stop_clock_label;
+    }
+
+    return transport_status_ok;
+
+stop_clock_label:
+    hw_r = hw_stop_clock(&transport->hw);
+    RETURN_ON_HW_ERROR(hw_r);
+deinit_rst_pin_label:
+    hw_r = hw_rst_deinitialize(&transport->hw);
+    RETURN_ON_HW_ERROR(hw_r);
+deinit_library_label:
+    hw_deinitialize();
+err_label:
+    return r;
+}
+
+transport_status_t transport_hw_deinitialize(const transport_t* transport) {
+    hw_status_t r;
+
+    if (transport_has_card_detect(&transport->hw)) {
+        r = hw_detect_deinitialize(&transport->hw);
+        RETURN_ON_HW_ERROR(r);
+    }
+
+    r = hw_stop_clock(&transport->hw);
+    RETURN_ON_HW_ERROR(r);
+
+    r = hw_rst_deinitialize(&transport->hw);
+    RETURN_ON_HW_ERROR(r);
+
+    hw_deinitialize();
+
+    return transport_status_ok;
+}
+
+// Restart of the PWM clock glitches the card clock
+transport_status_t transport_hw_reconfigure_clock(transport_t* transport, uint32_t freq) {
+    if (transport->clock_freq == freq) {
+        ++transport->reconfig_stats.clock_changes_skipped;
+        return transport_status_ok;
+    }
+
+    hw_status_t hw_r = hw_start_clock(&transport->hw, freq);
+    RETURN_ON_HW_ERROR(hw_r);
+
+    transport->clock_freq = freq;
+    ++transport->reconfig_stats.clock_changes;
+
+    return transport_status_ok;
+}
@@ -0,0 +1,92 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#include <rtuartscreader/transport/initialize_wave.h>
+
+#include <limits.h>
+
+#include <rtuartscreader/hardware/hardware.h>
+#include <rtuartscreader/transport/detail/error.h>
+#include <rtuartscreader/transport/detail/initialize_common.h>
+#include <rtuartscreader/transport/detail/transmit_params.h>
+#include <rtuartscreader/transport/device_name.h>
+
+static transport_status_t transport_wave_initialize(transport_t* transport, const char* reader_name) {
+    transport_status_t r;
+    hw_status_t hw_r;
+    char path[PATH_MAX];
+
+    // The path of the serial port is required by the device name, but it is not used
+    r = parse_device_name(reader_name, path, sizeof(path), &transport->hw, &transport->realtime);
+    POPULATE_ERROR(r, transport_status_ok, r);
+
+    if (!transport->hw.has_io_pin) {
+        LOG_RETURN_TRANSPORT_ERROR_MSG(transport_status_invalid_device_name, "io=<gpio> is required by the wave engine");
+    }
+
+    transport->params = *transmit_params_default();
+    transport->handle = -1;
+
+    r = transport_hw_initialize(transport);
+    POPULATE_ERROR(r, transport_status_ok, r);
+
+    hw_r = hw_serial_open(&transport->hw, transport->params.transmit_speed.baudrate);
+    if (hw_r != hw_status_ok) {
+        r = transport_hw_deinitialize(transport);
+        POPULATE_ERROR(r, transport_status_ok, r);
+
+        return transport_status_hardware_error;
+    }
+
+    return transport_status_ok;
+}
+
+// WT is applied by the sendrecv engine itself, so the serial line is reopened for another baud rate only
+static transport_status_t transport_wave_reinitialize(transport_t* transport, const transmit_params_t* params) {
+    uint32_t old_baudrate = transport->params.transmit_speed.baudrate;
+    hw_status_t hw_r;
+
+    transport->params = *params;
+
+    if (old_baudrate != params->transmit_speed.baudrate) {
+        hw_r = hw_serial_close(&transport->hw);
+        RETURN_ON_HW_ERROR(hw_r);
+
+        hw_r = hw_serial_open(&transport->hw, params->transmit_speed.baudrate);
+        RETURN_ON_HW_ERROR(hw_r);
+
+        ++transport->reconfig_stats.serial_setups;
+    } else {
+        // Drop the noise the card may have sent while RST was low
+        hw_r = hw_serial_flush(&transport->hw);
+        RETURN_ON_HW_ERROR(hw_r);
+
+        ++transport->reconfig_stats.serial_setups_skipped;
+    }
+
+    return transport_hw_reconfigure_clock(transport, params->transmit_speed.freq);
+}
+
+static transport_status_t transport_wave_deinitialize(const transport_t* transport) {
+    hw_status_t hw_r = hw_serial_close(&transport->hw);
+    RETURN_ON_HW_ERROR(hw_r);
+
+    return transport_hw_deinitialize(transport);
+}
+
+static uint32_t transport_wave_max_baudrate(const transport_t* transport) {
+    return hw_serial_max_baudrate(&transport->hw);
+}
+
+const transport_initialize_impl_t* transport_initialize_wave_impl() {
+    static const transport_initialize_impl_t impl = {
+        .transport_initialize = transport_wave_initialize,
+        .transport_reinitialize = transport_wave_reinitialize,
+        .transport_deinitialize = transport_wave_deinitialize,
+        .transport_max_baudrate = transport_wave_max_baudrate
+    };
+
+    return &impl;
+}
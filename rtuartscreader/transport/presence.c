@@ -0,0 +1,37 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#include <rtuartscreader/transport/presence.h>
+
+#include <rtuartscreader/transport/detail/error.h>
+
+bool transport_has_card_detect(const hw_config_t* hw) {
+    return hw->has_detect_pin;
+}
+
+transport_status_t transport_detect_card(const hw_config_t* hw, bool* present) {
+    hw_status_t r = hw_detect_read(hw, present);
+    RETURN_ON_HW_ERROR(r);
+
+    return transport_status_ok;
+}
+
+transport_status_t transport_wait_card_change(const hw_config_t* hw, bool present, uint32_t timeout_ms) {
+    hw_status_t r = hw_detect_wait(hw, present, timeout_ms);
+
+    switch (r) {
+    case hw_status_ok:
+    case hw_status_cancelled: return transport_status_ok;
+    case hw_status_timeout: return transport_status_timeout;
+    default: return transport_status_hardware_error;
+    }
+}
+
+transport_status_t transport_cancel_card_wait(const hw_config_t* hw) {
+    hw_status_t r = hw_detect_cancel(hw);
+    RETURN_ON_HW_ERROR(r);
+
+    return transport_status_ok;
+}
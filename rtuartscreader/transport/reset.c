@@ -13,59 +13,36 @@
 #include <rtuartscreader/iso7816_3/atr.h>
 #include <rtuartscreader/iso7816_3/pps.h>
 #include <rtuartscreader/iso7816_3/utils.h>
+#include <rtuartscreader/transport/atr_cache.h>
 #include <rtuartscreader/transport/detail/error.h>
 #include <rtuartscreader/transport/detail/transmit_params.h>
 #include <rtuartscreader/transport/initialize.h>
 #include <rtuartscreader/utils/common.h>
-
-typedef struct {
-    speed_t baudrate;
-    double symbol_time_us;
-} transport_params_entry_t;
-
-#define BAUDRATE_AND_SYMBOL_TIME_US_PAIR(n) \
-    { B##n, (S_TO_US_MULTIPLIER_LF / n) }
-
-static int transmit_speed_from_f_d(uint32_t f, uint32_t d, uint32_t max_freq, transmit_speed_t* transmit_speed) {
-    static const transport_params_entry_t default_values[16] = {
-        BAUDRATE_AND_SYMBOL_TIME_US_PAIR(75),
-        BAUDRATE_AND_SYMBOL_TIME_US_PAIR(110),
-        BAUDRATE_AND_SYMBOL_TIME_US_PAIR(134),
-        BAUDRATE_AND_SYMBOL_TIME_US_PAIR(150),
-        BAUDRATE_AND_SYMBOL_TIME_US_PAIR(300),
-        BAUDRATE_AND_SYMBOL_TIME_US_PAIR(600),
-        BAUDRATE_AND_SYMBOL_TIME_US_PAIR(1200),
-        BAUDRATE_AND_SYMBOL_TIME_US_PAIR(1800),
-        BAUDRATE_AND_SYMBOL_TIME_US_PAIR(2400),
-        BAUDRATE_AND_SYMBOL_TIME_US_PAIR(4800),
-        BAUDRATE_AND_SYMBOL_TIME_US_PAIR(9600),
-        BAUDRATE_AND_SYMBOL_TIME_US_PAIR(19200),
-        BAUDRATE_AND_SYMBOL_TIME_US_PAIR(38400),
-        BAUDRATE_AND_SYMBOL_TIME_US_PAIR(57600),
-        BAUDRATE_AND_SYMBOL_TIME_US_PAIR(115200),
-        BAUDRATE_AND_SYMBOL_TIME_US_PAIR(230400),
-    };
-
+#include <rtuartscreader/utils/monotonic.h>
+
+// The baud rate is not limited to the Bxxx constants of termios, so the fastest
+// clock up to the maximum frequency of F is chosen and the baud rate follows
+// the frequency the clock actually achieves. The fastest baud rate depends on
+// the transport engine.
+static int transmit_speed_from_f_d(const transport_t* transport, uint32_t f, uint32_t d, uint32_t max_freq,
+                                   transmit_speed_t* transmit_speed) {
     static const uint32_t min_freq = 1e6;
 
-    uint32_t etu_periods = f / d;
-
-    for (size_t i = ARRAYSIZE(default_values); i != 0; --i) {
-        // f = 1 / T; T = symbol_time / etu_periods; symbol_time = symbol_time_us / S_TO_US_MULTIPLIER_LF
-        double freq = S_TO_US_MULTIPLIER_LF * etu_periods / (default_values[i - 1].symbol_time_us);
-        if (freq >= min_freq && freq < max_freq) {
-            transmit_speed->baudrate = default_values[i - 1].baudrate;
-            transmit_speed->freq = (uint32_t)freq;
-            return 1;
-        }
+    // ETU lasts F / D clock periods, which is not integer for many pairs
+    uint64_t freq_limit = (uint64_t)transport_max_baudrate(transport) * f / d;
+    uint32_t freq = hw_clock_frequency(&transport->hw, freq_limit < max_freq ? (uint32_t)freq_limit : max_freq);
+    if (freq < min_freq) {
+        return 0;
     }
 
-    return 0;
-}
+    transmit_speed->baudrate = (uint32_t)((uint64_t)freq * d / f);
+    transmit_speed->freq = freq;
 
-#undef BAUDRATE_AND_SYMBOL_TIME_US_PAIR
+    return 1;
+}
 
-static int transmit_speed_from_f_d_indices(const f_d_index_t* f_d_index, transmit_speed_t* transmit_speed) {
+static int transmit_speed_from_f_d_indices(const transport_t* transport, const f_d_index_t* f_d_index,
+                                           transmit_speed_t* transmit_speed) {
     const f_freq_max_t* f_freq_max = f_freq_max_by_index(f_d_index->f_index);
     uint32_t d = d_by_index(f_d_index->d_index);
 
@@ -73,7 +50,7 @@ static int transmit_speed_from_f_d_indices(const f_d_index_t* f_d_index, transmi
         return 0;
     }
 
-    return transmit_speed_from_f_d(f_freq_max->f, d, f_freq_max->freq_max_hz, transmit_speed);
+    return transmit_speed_from_f_d(transport, f_freq_max->f, d, f_freq_max->freq_max_hz, transmit_speed);
 }
 
 // left is worse than right
@@ -82,7 +59,8 @@ static inline bool transmit_speed_is_worse_than(const transmit_speed_t* left, co
            || (left->baudrate == right->baudrate && left->freq > right->freq);
 }
 
-static int choose_best_f_d_indices(const f_d_index_t* f_d_index_max, f_d_index_t* f_d_index_result) {
+static int choose_best_f_d_indices(const transport_t* transport, const f_d_index_t* f_d_index_max,
+                                   f_d_index_t* f_d_index_result) {
     bool found_first = false;
     transmit_speed_t transmit_speed_best;
 
@@ -91,7 +69,7 @@ static int choose_best_f_d_indices(const f_d_index_t* f_d_index_max, f_d_index_t
             f_d_index_t f_d_index_tested = { .f_index = f_index, .d_index = d_index };
             transmit_speed_t transmit_speed_tested;
 
-            if (!transmit_speed_from_f_d_indices(&f_d_index_tested, &transmit_speed_tested)) continue;
+            if (!transmit_speed_from_f_d_indices(transport, &f_d_index_tested, &transmit_speed_tested)) continue;
 
             if (!found_first) {
                 transmit_speed_best = transmit_speed_tested;
@@ -112,33 +90,53 @@ static int choose_best_f_d_indices(const f_d_index_t* f_d_index_max, f_d_index_t
     return found_first;
 }
 
-static transport_status_t compute_wt_ds(const atr_info_t* atr_info, uint32_t freq, uint8_t* wt_ds) {
+// For T=1 the block waiting time is used as WT: it bounds the delay before a block,
+// and the characters of the block are then awaited for the character waiting time.
+static transport_status_t compute_wt_params(uint32_t f, uint32_t d, const atr_info_t* atr_info, uint8_t protocol,
+                                            uint32_t freq, transmit_params_t* params) {
     double wt;
-    iso7816_3_status_t r = compute_wt(atr_info, freq, &wt);
+    double cwt;
+    iso7816_3_status_t r;
+    if (protocol == PROTOCOL_T1) {
+        r = compute_bwt(f, d, atr_info, freq, &wt);
+        POPULATE_ERROR(r, iso7816_3_status_ok, transport_status_invalid_atr);
+
+        r = compute_cwt(f, d, atr_info, freq, &cwt);
+    } else {
+        r = compute_wt(atr_info, freq, &wt);
+        cwt = wt;
+    }
     POPULATE_ERROR(r, iso7816_3_status_ok, transport_status_invalid_atr);
 
-    double s_to_ds_multiplier = 10;
-    double wt_ds_claimed = s_to_ds_multiplier * wt;
-    if (wt_ds_claimed > 255) {
-        // TODO: log the problem
-        // TODO: support insanely long wait time
+    double wt_us_claimed = S_TO_US_MULTIPLIER_LF * wt;
+    if (wt_us_claimed > UINT32_MAX) {
         LOG_RETURN_TRANSPORT_ERROR_MSG(transport_status_mode_not_supported,
                                        "Card transmission parameters (too long WT) is not supported");
     }
 
-    *wt_ds = (uint8_t)(ceil(wt_ds_claimed));
+    params->wt_us = (uint32_t)(ceil(wt_us_claimed));
+    // CWT is shorter than BWT, so it fits once WT does
+    params->cwt_us = (uint32_t)(ceil(S_TO_US_MULTIPLIER_LF * cwt));
+
+    // VTIME follows the gap between the characters. It can not hold WT longer than 25.5 s,
+    // so such WT, as well as BWT longer than CWT, is waited in several turns.
+    double s_to_ds_multiplier = 10;
+    double wt_ds_claimed = ceil(s_to_ds_multiplier * cwt);
+    params->wt_ds = wt_ds_claimed > UINT8_MAX ? UINT8_MAX : (uint8_t)wt_ds_claimed;
 
     return transport_status_ok;
 }
 
-static transport_status_t transmit_params_init(const f_d_index_t* f_d_index, const atr_info_t* atr_info,
+static transport_status_t transmit_params_init(const transport_t* transport, const f_d_index_t* f_d_index,
+                                               const atr_info_t* atr_info, uint8_t protocol,
                                                transmit_params_t* params) {
     uint32_t f = f_freq_max_by_index(f_d_index->f_index)->f;
     uint32_t d = d_by_index(f_d_index->d_index);
 
     params->etu = f / d;
+    params->convention = atr_info->inverse_convention ? transport_convention_inverse : transport_convention_direct;
 
-    if (!transmit_speed_from_f_d_indices(f_d_index, &params->transmit_speed)) {
+    if (!transmit_speed_from_f_d_indices(transport, f_d_index, &params->transmit_speed)) {
         LOG_RETURN_TRANSPORT_ERROR_MSG(transport_status_mode_not_supported,
                                        "Card transmission parameters (F, D) are not supported");
     };
@@ -146,7 +144,7 @@ static transport_status_t transmit_params_init(const f_d_index_t* f_d_index, con
     iso7816_3_status_t iso_r = compute_extra_gt(f, d, atr_info, params->transmit_speed.freq, &params->extra_gt_us);
     POPULATE_ERROR(iso_r, iso7816_3_status_ok, transport_status_invalid_atr);
 
-    transport_status_t r = compute_wt_ds(atr_info, params->transmit_speed.freq, &params->wt_ds);
+    transport_status_t r = compute_wt_params(f, d, atr_info, protocol, params->transmit_speed.freq, params);
     POPULATE_ERROR(r, transport_status_ok, r);
 
     return transport_status_ok;
@@ -160,7 +158,7 @@ static uint32_t calculate_reset_us_delay(uint32_t freq) {
     return us_delay > us_delay_default ? us_delay : us_delay_default;
 }
 
-static bool is_explicit_protocol_defined(bool* explicit_protocols, size_t length) {
+static bool is_explicit_protocol_defined(const bool* explicit_protocols, size_t length) {
     for (size_t i = 0; i < length; ++i) {
         if (explicit_protocols[i]) return true;
     }
@@ -168,80 +166,210 @@ static bool is_explicit_protocol_defined(bool* explicit_protocols, size_t length
     return false;
 }
 
-static transport_status_t do_transport_reset(transport_t* transport, uint8_t atr_buffer[], size_t* atr_len) {
+static transport_status_t choose_protocol(const atr_info_t* info, uint8_t* protocol) {
+    if (info->ta2.is_present) {
+        *protocol = info->ta2.enforced_protocol;
+        if (*protocol != PROTOCOL_T0 && *protocol != PROTOCOL_T1) {
+            if (info->ta2.can_change_mode) {
+                LOG_RETURN_TRANSPORT_ERROR_MSG(transport_status_need_reset, "T0 and T1 only are supported, may try again");
+            } else {
+                LOG_RETURN_TRANSPORT_ERROR_MSG(transport_status_mode_not_supported, "T0 and T1 only are supported");
+            }
+        }
+
+        return transport_status_ok;
+    }
+
+    if (!is_explicit_protocol_defined(info->explicit_protocols, ARRAYSIZE(info->explicit_protocols))) {
+        *protocol = PROTOCOL_T0;
+    } else if (info->explicit_protocols[PROTOCOL_T1]) {
+        // T1 is preferred as it has no procedure bytes and GET RESPONSE round trips, though
+        // ISO 7816-3 makes the protocol of TD1 the default one. It is proposed with PPS,
+        // which is_pps_redundant() never skips for a card offering several protocols.
+        *protocol = PROTOCOL_T1;
+    } else if (info->explicit_protocols[PROTOCOL_T0]) {
+        *protocol = PROTOCOL_T0;
+    } else {
+        LOG_RETURN_TRANSPORT_ERROR_MSG(transport_status_mode_not_supported, "T0 and T1 only are supported");
+    }
+
+    return transport_status_ok;
+}
+
+static transport_status_t reset_and_read_atr(transport_t* transport, bool warm, atr_t* atr) {
     uint32_t delay_us = calculate_reset_us_delay(transport->params.transmit_speed.freq);
 
-    hw_status_t hw_r = hw_rst_down();
+    hw_status_t hw_r = hw_rst_down(&transport->hw);
     RETURN_ON_HW_ERROR(hw_r);
 
-    transport_status_t r = transport_reinitialize(transport, transmit_params_default());
+    // The cold reset restarts the clock at the default frequency. The warm one keeps it
+    // running at its frequency, and the card answers at F = 372 and D = 1 of it.
+    if (!warm) {
+        hw_r = hw_stop_clock(&transport->hw);
+        RETURN_ON_HW_ERROR(hw_r);
+
+        transport->clock_freq = 0;
+    }
+
+    transmit_params_t atr_params;
+    transmit_params_for_atr(transport->clock_freq, &atr_params);
+
+    transport_status_t r = transport_reinitialize(transport, &atr_params);
     POPULATE_ERROR(r, transport_status_ok, r);
 
-    hw_r = hw_rst_down_up(delay_us);
+    hw_r = hw_rst_down_up(&transport->hw, delay_us);
     RETURN_ON_HW_ERROR(hw_r);
 
-    atr_t atr;
-    iso7816_3_status_t iso_r = read_atr(transport, &atr);
+    iso7816_3_status_t iso_r = read_atr(transport, atr);
     RETURN_ON_IS07816_3_ERROR(iso_r);
 
-    atr_info_t info;
-    iso_r = parse_atr(&atr, &info);
-    RETURN_ON_IS07816_3_ERROR(iso_r);
-
-    memcpy(atr_buffer, atr.atr, atr.atr_len);
-    *atr_len = atr.atr_len;
+    // PPS is exchanged in the card convention already. The direct one needs no
+    // switch: the characters are passed as is until the final parameters are set.
+    if (atr->atr[0] == ATR_TS_INVERSE) {
+        transmit_params_t params = transport->params;
+        params.convention = transport_convention_inverse;
 
-    // Choose protocol: T0 only is supported
-    uint8_t protocol = PROTOCOL_T0;
-    if (info.ta2.is_present) {
-        if (info.ta2.enforced_protocol != PROTOCOL_T0) {
-            if (info.ta2.can_change_mode) {
-                LOG_RETURN_TRANSPORT_ERROR_MSG(transport_status_need_reset, "T0 only is supported, may try again");
-            } else {
-                LOG_RETURN_TRANSPORT_ERROR_MSG(transport_status_mode_not_supported, "T0 only is supported");
-            }
-        }
-    } else {
-        if (is_explicit_protocol_defined(info.explicit_protocols, ARRAYSIZE(info.explicit_protocols)) //
-            && !info.explicit_protocols[PROTOCOL_T0]) {
-            LOG_RETURN_TRANSPORT_ERROR_MSG(transport_status_mode_not_supported, "T0 only is supported");
-        }
+        r = transport_reinitialize(transport, &params);
+        POPULATE_ERROR(r, transport_status_ok, r);
     }
 
+    return transport_status_ok;
+}
+
+// Everything the card offers in its ATR, before PPS
+static transport_status_t negotiate_atr(const transport_t* transport, const atr_t* atr, atr_cache_entry_t* entry) {
+    iso7816_3_status_t iso_r = parse_atr(atr, &entry->info);
+    RETURN_ON_IS07816_3_ERROR(iso_r);
+
+    transport_status_t r = choose_protocol(&entry->info, &entry->protocol);
+    POPULATE_ERROR(r, transport_status_ok, r);
+
     // Choose F & D
-    f_d_index_t f_d_index = f_d_index_default;
+    entry->f_d_index = f_d_index_default;
 
-    if (info.ta1.is_present && !choose_best_f_d_indices(&info.ta1.f_d, &f_d_index)) {
+    if (entry->info.ta1.is_present && !choose_best_f_d_indices(transport, &entry->info.ta1.f_d, &entry->f_d_index)) {
         LOG_RETURN_TRANSPORT_ERROR_MSG(transport_status_mode_not_supported,
                                        "Card transmission parameters (F, D) are not supported");
     }
 
-    iso_r = do_pps_exchange(transport, &f_d_index, protocol);
-    if (iso_r != iso7816_3_status_ok)
-    {
-        if (iso_r == iso7816_3_status_pps_exchange_use_default_f_d)
-            f_d_index = f_d_index_default;
-        else
-            RETURN_ON_IS07816_3_ERROR(iso_r);
+    memcpy(entry->atr, atr->atr, atr->atr_len);
+    entry->atr_len = atr->atr_len;
+
+    return transport_status_ok;
+}
+
+static size_t count_explicit_protocols(const atr_info_t* info) {
+    size_t count = 0;
+
+    for (size_t i = 0; i < ARRAYSIZE(info->explicit_protocols); ++i) {
+        if (info->explicit_protocols[i]) ++count;
     }
 
-    // Assert F & D are OK
-    transmit_params_t params;
-    r = transmit_params_init(&f_d_index, &info, &params);
+    return count;
+}
+
+// The card keeps default F & D and its only protocol after the reset anyway,
+// if it has already refused to change F & D
+static bool is_pps_redundant(const atr_cache_entry_t* entry) {
+    return entry->pps_use_default_f_d && count_explicit_protocols(&entry->info) <= 1;
+}
+
+// TC1 applies from the ATR on, so PPS is sent with its extra guard time at the default F & D
+static transport_status_t set_pps_extra_gt(transport_t* transport, const atr_info_t* atr_info) {
+    uint32_t f = f_freq_max_by_index(f_d_index_default.f_index)->f;
+    uint32_t d = d_by_index(f_d_index_default.d_index);
+
+    iso7816_3_status_t iso_r =
+        compute_extra_gt(f, d, atr_info, transport->params.transmit_speed.freq, &transport->params.extra_gt_us);
+    POPULATE_ERROR(iso_r, iso7816_3_status_ok, transport_status_invalid_atr);
+
+    return transport_status_ok;
+}
+
+static transport_status_t do_transport_reset(transport_t* transport, bool warm, uint8_t atr_buffer[],
+                                             size_t* atr_len) {
+    transport->pps_exchanged = false;
+
+    atr_t atr;
+    transport_status_t r = reset_and_read_atr(transport, warm, &atr);
     POPULATE_ERROR(r, transport_status_ok, r);
 
-    r = transport_reinitialize(transport, &params);
+    memcpy(atr_buffer, atr.atr, atr.atr_len);
+    *atr_len = atr.atr_len;
+
+    atr_cache_entry_t entry;
+    const atr_cache_entry_t* cached = atr_cache_find(transport->atr_cache, atr.atr, atr.atr_len);
+    if (cached) {
+        entry = *cached;
+    } else {
+        r = negotiate_atr(transport, &atr, &entry);
+        POPULATE_ERROR(r, transport_status_ok, r);
+    }
+
+    transport->pps_exchanged = !cached || !is_pps_redundant(&entry);
+    if (transport->pps_exchanged) {
+        r = set_pps_extra_gt(transport, &entry.info);
+        POPULATE_ERROR(r, transport_status_ok, r);
+
+        uint64_t pps_start_us = monotonic_us();
+        iso7816_3_status_t iso_r = do_pps_exchange(transport, &entry.f_d_index, entry.protocol);
+        transport->pps_us = (uint32_t)(monotonic_us() - pps_start_us);
+        if (iso_r != iso7816_3_status_ok && iso_r != iso7816_3_status_pps_exchange_use_default_f_d) {
+            RETURN_ON_IS07816_3_ERROR(iso_r);
+        }
+
+        bool use_default_f_d = iso_r == iso7816_3_status_pps_exchange_use_default_f_d;
+        if (!cached || use_default_f_d != entry.pps_use_default_f_d) {
+            entry.pps_use_default_f_d = use_default_f_d;
+
+            // Assert F & D are OK
+            r = transmit_params_init(transport, use_default_f_d ? &f_d_index_default : &entry.f_d_index,
+                                     &entry.info, entry.protocol, &entry.params);
+            POPULATE_ERROR(r, transport_status_ok, r);
+
+            atr_cache_store(transport->atr_cache, &entry);
+        }
+    }
+
+    r = transport_reinitialize(transport, &entry.params);
     POPULATE_ERROR(r, transport_status_ok, r);
 
+    transport->protocol = entry.protocol;
+    *transport->atr_info = entry.info;
+
     return transport_status_ok;
 }
 
-transport_status_t transport_reset(transport_t* transport, uint8_t atr_buffer[], size_t* atr_len) {
-    transport_status_t r = do_transport_reset(transport, atr_buffer, atr_len);
+static transport_status_t transport_reset_impl(transport_t* transport, bool warm, uint8_t atr_buffer[],
+                                               size_t* atr_len) {
+    transport_status_t r = do_transport_reset(transport, warm, atr_buffer, atr_len);
     if (r == transport_status_need_reset) {
         // TODO: may there be more iterations?
-        r = do_transport_reset(transport, atr_buffer, atr_len);
+        r = do_transport_reset(transport, warm, atr_buffer, atr_len);
     }
 
     return r;
 }
+
+transport_status_t transport_reset(transport_t* transport, uint8_t atr_buffer[], size_t* atr_len) {
+    return transport_reset_impl(transport, false, atr_buffer, atr_len);
+}
+
+transport_status_t transport_warm_reset(transport_t* transport, uint8_t atr_buffer[], size_t* atr_len) {
+    return transport_reset_impl(transport, true, atr_buffer, atr_len);
+}
+
+transport_status_t transport_probe_atr(transport_t* transport, uint8_t atr_buffer[], size_t* atr_len) {
+    atr_t atr;
+    transport_status_t r = reset_and_read_atr(transport, false, &atr);
+    POPULATE_ERROR(r, transport_status_ok, r);
+
+    atr_info_t info;
+    iso7816_3_status_t iso_r = parse_atr(&atr, &info);
+    RETURN_ON_IS07816_3_ERROR(iso_r);
+
+    memcpy(atr_buffer, atr.atr, atr.atr_len);
+    *atr_len = atr.atr_len;
+
+    return transport_status_ok;
+}
@@ -9,64 +9,59 @@
 #include <unistd.h>
 
 #include <rtuartscreader/transport/detail/error.h>
+#include <rtuartscreader/transport/detail/sendrecv_common.h>
+
+#define DS_TO_US_MULTIPLIER 100000
 
 // Read timeout is expected to be set based on WT value
 // derived from selected transport parameters during PPS.
-static transport_status_t do_transport_recv_byte_impl(const transport_t* transport, uint8_t* byte) {
-    ssize_t rsize = read(transport->handle, byte, 1);
+// As VMIN is 0, every read() returns as soon as any data is available or fails
+// after WT with no data, so WT is applied to the gap between characters while
+// all already received characters are taken by a single call. WT longer than VTIME
+// is waited in several turns, so wt_us is enforced with VTIME granularity.
+static transport_status_t do_transport_recv_bytes_impl(const transport_t* transport, uint8_t* buf, size_t len,
+                                                       uint32_t wt_us) {
+    size_t recv = 0;
+    uint64_t waited_us = 0; // WT close to UINT32_MAX is exceeded by a turn of up to 25.5 s
+
+    while (recv != len) {
+        ssize_t rsize = read(transport->handle, buf + recv, len - recv);
+
+        if (rsize == -1) {
+            return transport_status_communication_error;
+        }
 
-    if (rsize == -1) {
-        return transport_status_communication_error;
-    }
+        if (!rsize) {
+            // VTIME is limited to 25.5 s, longer WT is waited in several turns
+            waited_us += (uint64_t)transport->params.wt_ds * DS_TO_US_MULTIPLIER;
+            if (!transport->params.wt_ds || waited_us >= wt_us) {
+                return transport_status_timeout;
+            }
+
+            continue;
+        }
 
-    if (!rsize) {
-        return transport_status_timeout;
+        recv += rsize;
+        waited_us = 0;
     }
 
     return transport_status_ok;
 }
 
-// TODO: support extra guard time
-static transport_status_t do_transport_send_byte_impl(const transport_t* transport, uint8_t byte) {
-    uint8_t echo;
-
-    if (write(transport->handle, &byte, 1) != 1)
-        return transport_status_communication_error;
-
-    // handle synchronous echo byte
-    return do_transport_recv_byte_impl(transport, &echo);
-}
+static const transport_io_t g_transport_io = {
+    .read = do_transport_recv_bytes_impl
+};
 
 static transport_status_t transport_recv_bytes_impl(const transport_t* transport, uint8_t* buf, size_t len) {
-    transport_status_t r = transport_status_ok;
-    size_t recv;
-
-    for (recv = 0; recv < len; ++recv) {
-        r = do_transport_recv_byte_impl(transport, &buf[recv]);
-        if (r != transport_status_ok) {
-            LOG_RETURN_TRANSPORT_ERROR(r);
-        }
-    }
-
-    LOG_XXD_INFO(buf, len, "recv: ");
+    return transport_io_recv_bytes(&g_transport_io, transport, buf, len, transport->params.wt_us);
+}
 
-    return r;
+static transport_status_t transport_recv_block_bytes_impl(const transport_t* transport, uint8_t* buf, size_t len) {
+    return transport_io_recv_bytes(&g_transport_io, transport, buf, len, transport->params.cwt_us);
 }
 
 static transport_status_t transport_send_bytes_impl(const transport_t* transport, const uint8_t* bytes, size_t len) {
-    LOG_XXD_INFO(bytes, len, "send: ");
-
-    transport_status_t r = transport_status_ok;
-    size_t sent;
-
-    for (sent = 0; sent != len; ++sent) {
-        r = do_transport_send_byte_impl(transport, bytes[sent]);
-        if (r != transport_status_ok) {
-            LOG_RETURN_TRANSPORT_ERROR(r);
-        }
-    }
-
-    return r;
+    return transport_io_send_bytes(&g_transport_io, transport, bytes, len);
 }
 
 static transport_status_t transport_recv_byte_impl(const transport_t* transport, uint8_t* byte) {
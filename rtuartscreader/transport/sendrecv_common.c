@@ -0,0 +1,178 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#include <rtuartscreader/transport/detail/sendrecv_common.h>
+
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <rtuartscreader/transport/convention.h>
+#include <rtuartscreader/transport/detail/error.h>
+#include <rtuartscreader/utils/counter.h>
+#include <rtuartscreader/utils/monotonic.h>
+
+// Bytes are written to UART in chunks of this size, and their echo is drained
+// chunk by chunk, so that the echo buffer may be kept on stack.
+#define SEND_CHUNK_SIZE 64
+
+// The echo of a character is received in the middle of its first stop bit,
+// the character is over 1.5 ETU later
+#define ECHO_TO_CHARACTER_END_HALF_ETU 3
+
+// A sleep overshoots by the timer slack and the wakeup latency, so the last part
+// of the guard time is spun on the clock instead
+#define EXTRA_GT_SPIN_NS 100000
+
+#define NS_IN_S 1000000000
+#define NS_IN_US 1000
+
+static transport_status_t do_transport_recv_echo(const transport_io_t* io, const transport_t* transport,
+                                                 const uint8_t* bytes, size_t len) {
+    uint8_t echo[SEND_CHUNK_SIZE];
+
+    transport_status_t r = io->read(transport, echo, len, transport->params.wt_us);
+    if (r != transport_status_ok) {
+        return r;
+    }
+
+    if (memcmp(echo, bytes, len)) {
+        LOG_RETURN_TRANSPORT_ERROR_MSG(transport_status_communication_error, "Echo does not match sent data");
+    }
+
+    return transport_status_ok;
+}
+
+static transport_status_t do_transport_write(const transport_t* transport, const uint8_t* bytes, size_t len) {
+    size_t sent = 0;
+
+    while (sent != len) {
+        ssize_t wsize = write(transport->handle, bytes + sent, len - sent);
+
+        if (wsize <= 0) {
+            return transport_status_communication_error;
+        }
+
+        sent += wsize;
+    }
+
+    return transport_status_ok;
+}
+
+// The echo is compared with the characters as they are on the line
+static transport_status_t do_transport_send_chunk(const transport_io_t* io, const transport_t* transport,
+                                                  const uint8_t* bytes, size_t len) {
+    uint8_t converted[SEND_CHUNK_SIZE];
+
+    if (transport->params.convention == transport_convention_inverse) {
+        memcpy(converted, bytes, len);
+        transport_convert_inverse(converted, len);
+        bytes = converted;
+    }
+
+    transport_status_t r = io->write ? io->write(transport, bytes, len) : do_transport_write(transport, bytes, len);
+    if (r != transport_status_ok) {
+        return r;
+    }
+
+    // handle echo of the whole chunk at once
+    return do_transport_recv_echo(io, transport, bytes, len);
+}
+
+// Chunk is written at once, so UART puts characters back to back. It is not
+// possible to insert extra guard time between them, hence per-byte sending
+// is used if the card requires it.
+static transport_status_t do_transport_send_bytes_bulk(const transport_io_t* io, const transport_t* transport,
+                                                       const uint8_t* bytes, size_t len) {
+    transport_status_t r = transport_status_ok;
+
+    for (size_t sent = 0; sent != len;) {
+        size_t chunk = len - sent < SEND_CHUNK_SIZE ? len - sent : SEND_CHUNK_SIZE;
+
+        r = do_transport_send_chunk(io, transport, bytes + sent, chunk);
+        if (r != transport_status_ok) {
+            return r;
+        }
+
+        sent += chunk;
+    }
+
+    return r;
+}
+
+void transport_io_wait_extra_gt(const transport_t* transport) {
+    uint64_t deadline = monotonic_ns() +
+                        (uint64_t)ECHO_TO_CHARACTER_END_HALF_ETU * NS_IN_S / 2 / transport->params.transmit_speed.baudrate +
+                        (uint64_t)transport->params.extra_gt_us * NS_IN_US;
+
+    if (deadline - monotonic_ns() > EXTRA_GT_SPIN_NS) {
+        uint64_t wakeup = deadline - EXTRA_GT_SPIN_NS;
+        struct timespec ts = { .tv_sec = wakeup / NS_IN_S, .tv_nsec = (long)(wakeup % NS_IN_S) };
+
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+        }
+    }
+
+    while (monotonic_ns() < deadline) {
+    }
+}
+
+// Each character is sent once the echo of the previous one is received, so the
+// guard time is counted from the end of the character on the line
+static transport_status_t do_transport_send_bytes_per_byte(const transport_io_t* io, const transport_t* transport,
+                                                           const uint8_t* bytes, size_t len) {
+    transport_status_t r = transport_status_ok;
+
+    for (size_t sent = 0; sent != len; ++sent) {
+        if (sent) {
+            transport_io_wait_extra_gt(transport);
+        }
+
+        r = do_transport_send_chunk(io, transport, bytes + sent, 1);
+        if (r != transport_status_ok) {
+            return r;
+        }
+    }
+
+    return r;
+}
+
+transport_status_t transport_io_recv_bytes(const transport_io_t* io, const transport_t* transport, uint8_t* buf, size_t len,
+                                           uint32_t wt_us) {
+    transport_status_t r = io->read(transport, buf, len, wt_us);
+    if (r == transport_status_timeout && transport->timeouts) {
+        counter_add(transport->timeouts, 1);
+    }
+    if (r != transport_status_ok) {
+        LOG_RETURN_TRANSPORT_ERROR(r);
+    }
+
+    if (transport->params.convention == transport_convention_inverse) {
+        transport_convert_inverse(buf, len);
+    }
+
+    LOG_XXD_INFO_DEFERRED(buf, len, "recv: ");
+
+    return r;
+}
+
+transport_status_t transport_io_send_bytes(const transport_io_t* io, const transport_t* transport, const uint8_t* bytes, size_t len) {
+    LOG_XXD_INFO_DEFERRED(bytes, len, "send: ");
+
+    transport_status_t r;
+
+    if (transport->params.extra_gt_us && !io->write_applies_extra_gt) {
+        r = do_transport_send_bytes_per_byte(io, transport, bytes, len);
+    } else {
+        r = do_transport_send_bytes_bulk(io, transport, bytes, len);
+    }
+
+    if (r != transport_status_ok) {
+        LOG_RETURN_TRANSPORT_ERROR(r);
+    }
+
+    return r;
+}
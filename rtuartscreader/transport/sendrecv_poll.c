@@ -0,0 +1,118 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#define _GNU_SOURCE
+
+#include <rtuartscreader/transport/sendrecv_poll.h>
+
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <rtuartscreader/transport/detail/error.h>
+#include <rtuartscreader/transport/detail/sendrecv_common.h>
+#include <rtuartscreader/utils/monotonic.h>
+
+#define US_IN_S 1000000
+#define NS_IN_US 1000
+
+static struct timespec us_to_timespec(uint32_t us) {
+    struct timespec ts = { .tv_sec = us / US_IN_S, .tv_nsec = (long)(us % US_IN_S) * NS_IN_US };
+    return ts;
+}
+
+// A signal does not restart the whole timeout, the rest of it is waited after EINTR
+static transport_status_t wait_readable(const transport_t* transport, uint32_t timeout_us) {
+    struct pollfd fd = { .fd = transport->handle, .events = POLLIN };
+    uint64_t deadline_us = monotonic_us() + timeout_us;
+
+    int r;
+    do {
+        uint64_t now_us = monotonic_us();
+        struct timespec timeout = us_to_timespec(now_us < deadline_us ? (uint32_t)(deadline_us - now_us) : 0);
+
+        r = ppoll(&fd, 1, &timeout, NULL);
+    } while (r == -1 && errno == EINTR);
+
+    if (r == -1) {
+        LOG_OS_ERROR(r);
+        return transport_status_communication_error;
+    }
+
+    if (!r) {
+        return transport_status_timeout;
+    }
+
+    if (fd.revents & (POLLERR | POLLNVAL)) {
+        return transport_status_communication_error;
+    }
+
+    return transport_status_ok;
+}
+
+// Every character is awaited for wt_us at most. read() does not block after
+// ppoll() reported data, as VMIN is 0, and takes all received characters.
+static transport_status_t do_transport_poll_recv_bytes(const transport_t* transport, uint8_t* buf, size_t len,
+                                                       uint32_t wt_us) {
+    size_t recv = 0;
+
+    while (recv != len) {
+        transport_status_t r = wait_readable(transport, wt_us);
+        if (r != transport_status_ok) {
+            return r;
+        }
+
+        ssize_t rsize = read(transport->handle, buf + recv, len - recv);
+
+        if (rsize == -1) {
+            return transport_status_communication_error;
+        }
+
+        if (!rsize) {
+            return transport_status_timeout;
+        }
+
+        recv += rsize;
+    }
+
+    return transport_status_ok;
+}
+
+static const transport_io_t g_transport_poll_io = {
+    .read = do_transport_poll_recv_bytes
+};
+
+static transport_status_t transport_poll_recv_bytes(const transport_t* transport, uint8_t* buf, size_t len) {
+    return transport_io_recv_bytes(&g_transport_poll_io, transport, buf, len, transport->params.wt_us);
+}
+
+static transport_status_t transport_poll_recv_block_bytes(const transport_t* transport, uint8_t* buf, size_t len) {
+    return transport_io_recv_bytes(&g_transport_poll_io, transport, buf, len, transport->params.cwt_us);
+}
+
+static transport_status_t transport_poll_send_bytes(const transport_t* transport, const uint8_t* bytes, size_t len) {
+    return transport_io_send_bytes(&g_transport_poll_io, transport, bytes, len);
+}
+
+static transport_status_t transport_poll_recv_byte(const transport_t* transport, uint8_t* byte) {
+    return transport_poll_recv_bytes(transport, byte, 1);
+}
+
+static transport_status_t transport_poll_send_byte(const transport_t* transport, uint8_t byte) {
+    return transport_poll_send_bytes(transport, &byte, 1);
+}
+
+const transport_sendrecv_impl_t* transport_sendrecv_poll_impl() {
+    static const transport_sendrecv_impl_t impl = {
+        .transport_recv_byte = transport_poll_recv_byte,
+        .transport_send_byte = transport_poll_send_byte,
+        .transport_recv_bytes = transport_poll_recv_bytes,
+        .transport_recv_block_bytes = transport_poll_recv_block_bytes,
+        .transport_send_bytes = transport_poll_send_bytes
+    };
+
+    return &impl;
+}
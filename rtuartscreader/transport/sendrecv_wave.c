@@ -0,0 +1,119 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#include <rtuartscreader/transport/sendrecv_wave.h>
+
+#include <errno.h>
+#include <time.h>
+
+#include <rtuartscreader/hardware/hardware.h>
+#include <rtuartscreader/transport/detail/error.h>
+#include <rtuartscreader/transport/detail/sendrecv_common.h>
+#include <rtuartscreader/utils/monotonic.h>
+
+#define US_IN_S 1000000
+#define NS_IN_US 1000
+
+// Start bit, 8 data bits, parity bit and 2 ETU of guard time
+#define ETU_PER_CHARACTER 12
+
+static void sleep_us(uint64_t us) {
+    struct timespec delay = { .tv_sec = us / US_IN_S, .tv_nsec = (long)(us % US_IN_S) * NS_IN_US };
+
+    while (clock_nanosleep(CLOCK_MONOTONIC, 0, &delay, &delay) == EINTR) {
+    }
+}
+
+static hw_parity_t parity_of(const transport_t* transport) {
+    switch (transport->params.convention) {
+    case transport_convention_direct:
+        return hw_parity_even;
+    case transport_convention_inverse:
+        return hw_parity_odd;
+    default:
+        return hw_parity_ignored;
+    }
+}
+
+// The received characters are sampled by the hardware, they are taken once
+// per character time, and every character is awaited for wt_us at most.
+static transport_status_t do_transport_wave_recv_bytes(const transport_t* transport, uint8_t* buf, size_t len,
+                                                       uint32_t wt_us) {
+    uint64_t character_us = (uint64_t)ETU_PER_CHARACTER * US_IN_S / transport->params.transmit_speed.baudrate + 1;
+    uint64_t deadline = monotonic_us() + wt_us;
+    size_t recv = 0;
+
+    while (recv != len) {
+        size_t rsize;
+
+        hw_status_t r = hw_serial_read(&transport->hw, parity_of(transport), buf + recv, len - recv, &rsize);
+        if (r != hw_status_ok) {
+            return transport_status_communication_error;
+        }
+
+        uint64_t now = monotonic_us();
+
+        if (rsize) {
+            recv += rsize;
+            deadline = now + wt_us;
+            continue;
+        }
+
+        if (now >= deadline) {
+            return transport_status_timeout;
+        }
+
+        sleep_us(deadline - now < character_us ? deadline - now : character_us);
+    }
+
+    return transport_status_ok;
+}
+
+// The waveform puts extra guard time between the characters, so a chunk is sent at once
+static transport_status_t do_transport_wave_write(const transport_t* transport, const uint8_t* bytes, size_t len) {
+    hw_status_t r = hw_serial_write(&transport->hw, transport->params.transmit_speed.baudrate,
+                                    transport->params.extra_gt_us, parity_of(transport), bytes, len);
+    RETURN_ON_HW_ERROR(r);
+
+    return transport_status_ok;
+}
+
+static const transport_io_t g_transport_wave_io = {
+    .read = do_transport_wave_recv_bytes,
+    .write = do_transport_wave_write,
+    .write_applies_extra_gt = true
+};
+
+static transport_status_t transport_wave_recv_bytes(const transport_t* transport, uint8_t* buf, size_t len) {
+    return transport_io_recv_bytes(&g_transport_wave_io, transport, buf, len, transport->params.wt_us);
+}
+
+static transport_status_t transport_wave_recv_block_bytes(const transport_t* transport, uint8_t* buf, size_t len) {
+    return transport_io_recv_bytes(&g_transport_wave_io, transport, buf, len, transport->params.cwt_us);
+}
+
+static transport_status_t transport_wave_send_bytes(const transport_t* transport, const uint8_t* bytes, size_t len) {
+    return transport_io_send_bytes(&g_transport_wave_io, transport, bytes, len);
+}
+
+static transport_status_t transport_wave_recv_byte(const transport_t* transport, uint8_t* byte) {
+    return transport_wave_recv_bytes(transport, byte, 1);
+}
+
+static transport_status_t transport_wave_send_byte(const transport_t* transport, uint8_t byte) {
+    return transport_wave_send_bytes(transport, &byte, 1);
+}
+
+const transport_sendrecv_impl_t* transport_sendrecv_wave_impl() {
+    static const transport_sendrecv_impl_t impl = {
+        .transport_recv_byte = transport_wave_recv_byte,
+        .transport_send_byte = transport_wave_send_byte,
+        .transport_recv_bytes = transport_wave_recv_bytes,
+        .transport_recv_block_bytes = transport_wave_recv_block_bytes,
+        .transport_send_bytes = transport_wave_send_bytes
+    };
+
+    return &impl;
+}
@@ -0,0 +1,70 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#include <rtuartscreader/transport/detail/serial_speed.h>
+
+// termios2 conflicts with the termios of libc, so it lives in its own unit
+#include <asm/termbits.h>
+#include <sys/ioctl.h>
+
+#include <rtuartscreader/transport/detail/error.h>
+
+transport_status_t set_serial_speed(int handle, uint32_t baudrate) {
+    struct termios2 options;
+
+    int ret = ioctl(handle, TCGETS2, &options);
+    LOG_RETURN_ON_OS_ERROR(ret);
+
+    options.c_cflag &= ~CBAUD;
+    options.c_cflag |= BOTHER;
+    options.c_ispeed = baudrate;
+    options.c_ospeed = baudrate;
+
+    ret = ioctl(handle, TCSETS2, &options);
+    LOG_RETURN_ON_OS_ERROR(ret);
+
+    return transport_status_ok;
+}
+
+transport_status_t set_serial_settings(int handle, uint32_t baudrate, bool odd_parity, uint8_t wt_ds) {
+    struct termios2 options;
+
+    int ret = ioctl(handle, TCGETS2, &options);
+    LOG_RETURN_ON_OS_ERROR(ret);
+
+    // What cfmakeraw() does, libc has no counterpart for termios2
+    options.c_iflag &= ~(IGNBRK | BRKINT | PARMRK | ISTRIP | INLCR | IGNCR | ICRNL | IXON);
+    options.c_oflag &= ~OPOST;
+    options.c_lflag &= ~(ECHO | ECHONL | ICANON | ISIG | IEXTEN);
+    options.c_cflag &= ~(CSIZE | PARODD);
+    options.c_cflag |= CS8 | CSTOPB | PARENB;
+    if (odd_parity) {
+        options.c_cflag |= PARODD;
+    }
+
+    options.c_cc[VMIN] = 0;
+    options.c_cc[VTIME] = wt_ds;
+
+    options.c_cflag &= ~CBAUD;
+    options.c_cflag |= BOTHER;
+    options.c_ispeed = baudrate;
+    options.c_ospeed = baudrate;
+
+    ret = ioctl(handle, TCSETS2, &options);
+    LOG_RETURN_ON_OS_ERROR(ret);
+
+    return transport_status_ok;
+}
+
+transport_status_t get_serial_speed(int handle, uint32_t* baudrate) {
+    struct termios2 options;
+
+    int ret = ioctl(handle, TCGETS2, &options);
+    LOG_RETURN_ON_OS_ERROR(ret);
+
+    *baudrate = options.c_ospeed;
+
+    return transport_status_ok;
+}
@@ -16,6 +16,7 @@ const char* transport_status_to_string(transport_status_t status) {
     case transport_status_invalid_atr: return "transport_status_invalid_atr";
     case transport_status_mode_not_supported: return "transport_status_mode_not_supported";
     case transport_status_need_reset: return "transport_status_need_reset";
+    case transport_status_invalid_device_name: return "transport_status_invalid_device_name";
     }
 
     return "unknown";
@@ -9,16 +9,36 @@
 
 #define ETU_372_FREQUENCY_HZ 3570058
 #define DEFAULT_ETU 372
+#define DEFAULT_WT_ETU 9600.
 
 const transmit_params_t* transmit_params_default() {
     static const transmit_params_t transmit_params = {
         .transmit_speed = {
             .freq = ETU_372_FREQUENCY_HZ,
-            .baudrate = B9600 },
+            .baudrate = 9600 },
         .etu = DEFAULT_ETU,
         .extra_gt_us = 0,
-        .wt_ds = (uint8_t)(10 * 9600. * DEFAULT_ETU / ETU_372_FREQUENCY_HZ + 1)
+        .wt_ds = (uint8_t)(10 * DEFAULT_WT_ETU * DEFAULT_ETU / ETU_372_FREQUENCY_HZ + 1),
+        .wt_us = (uint32_t)(1e6 * DEFAULT_WT_ETU * DEFAULT_ETU / ETU_372_FREQUENCY_HZ + 1),
+        .cwt_us = (uint32_t)(1e6 * DEFAULT_WT_ETU * DEFAULT_ETU / ETU_372_FREQUENCY_HZ + 1),
+        .convention = transport_convention_unknown
     };
 
     return &transmit_params;
 }
+
+void transmit_params_for_atr(uint32_t freq, transmit_params_t* params) {
+    *params = *transmit_params_default();
+    if (!freq || freq == params->transmit_speed.freq) {
+        return;
+    }
+
+    double wt = DEFAULT_WT_ETU * DEFAULT_ETU / freq;
+    double wt_ds = 10 * wt + 1;
+
+    params->transmit_speed.freq = freq;
+    params->transmit_speed.baudrate = freq / DEFAULT_ETU;
+    params->wt_ds = wt_ds > UINT8_MAX ? UINT8_MAX : (uint8_t)wt_ds;
+    params->wt_us = (uint32_t)(1e6 * wt + 1);
+    params->cwt_us = params->wt_us;
+}
@@ -0,0 +1,106 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#define _GNU_SOURCE
+
+#include <rtuartscreader/utils/realtime.h>
+
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+
+#include <rtuartscreader/log/log.h>
+#include <rtuartscreader/utils/monotonic.h>
+
+#define LATENCY_PROBE_NS 50000
+#define NS_IN_US 1000
+
+static pthread_mutex_t gLockMemoryMutex = PTHREAD_MUTEX_INITIALIZER;
+static bool gMemoryIsLocked = false;
+
+bool realtime_lock_memory(void) {
+    pthread_mutex_lock(&gLockMemoryMutex);
+
+    if (!gMemoryIsLocked) {
+        if (mlockall(MCL_CURRENT | MCL_FUTURE)) {
+            LOG_ERROR("mlockall failed: %s", strerror(errno));
+        } else {
+            gMemoryIsLocked = true;
+        }
+    }
+
+    bool locked = gMemoryIsLocked;
+
+    pthread_mutex_unlock(&gLockMemoryMutex);
+
+    return locked;
+}
+
+static bool raise_priority(int priority, realtime_context_t* context) {
+    pthread_t self = pthread_self();
+
+    if (pthread_getschedparam(self, &context->policy, &context->param)) {
+        return false;
+    }
+
+    struct sched_param param = { .sched_priority = priority };
+    int r = pthread_setschedparam(self, SCHED_FIFO, &param);
+    if (r) {
+        LOG_ERROR("pthread_setschedparam failed: %s", strerror(r));
+        return false;
+    }
+
+    return true;
+}
+
+static bool pin_cpu(unsigned cpu, realtime_context_t* context) {
+    pthread_t self = pthread_self();
+
+    if (pthread_getaffinity_np(self, sizeof(context->affinity), &context->affinity)) {
+        return false;
+    }
+
+    cpu_set_t affinity;
+    CPU_ZERO(&affinity);
+    CPU_SET(cpu, &affinity);
+
+    int r = pthread_setaffinity_np(self, sizeof(affinity), &affinity);
+    if (r) {
+        LOG_ERROR("pthread_setaffinity_np failed: %s", strerror(r));
+        return false;
+    }
+
+    return true;
+}
+
+bool realtime_enter(const realtime_config_t* config, realtime_context_t* context) {
+    context->scheduled = config->priority && raise_priority(config->priority, context);
+    context->pinned = config->pin_cpu && pin_cpu(config->cpu, context);
+
+    return context->scheduled || context->pinned;
+}
+
+void realtime_leave(const realtime_context_t* context) {
+    pthread_t self = pthread_self();
+
+    if (context->pinned) {
+        pthread_setaffinity_np(self, sizeof(context->affinity), &context->affinity);
+    }
+    if (context->scheduled) {
+        pthread_setschedparam(self, context->policy, &context->param);
+    }
+}
+
+uint32_t realtime_measure_latency_us(void) {
+    struct timespec probe = { .tv_sec = 0, .tv_nsec = LATENCY_PROBE_NS };
+
+    uint64_t start_us = monotonic_us();
+    clock_nanosleep(CLOCK_MONOTONIC, 0, &probe, NULL);
+    uint64_t slept_us = monotonic_us() - start_us;
+
+    uint64_t probe_us = LATENCY_PROBE_NS / NS_IN_US;
+    return slept_us > probe_us ? (uint32_t)(slept_us - probe_us) : 0;
+}
@@ -6,6 +6,8 @@
 #include <rtuartscreader/iso7816_3/apdu_t0.h>
 
 #include <memory>
+#include <numeric>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -30,9 +32,115 @@ TEST_F(TestT0, Sample) {
 
     vector<uint8_t> apdu{ 0x80, 0x00, 0x00, 0x00 };
     vector<uint8_t> response(257);
-    uint16_t responseLength = response.size();
+    size_t responseLength = response.size();
 
     t0_transmit_apdu(nullptr, apdu.data(), apdu.size(), response.data(), &responseLength);
     response.resize(responseLength);
     EXPECT_EQ(cardOutput, response);
 }
+
+namespace {
+
+vector<uint8_t> makeData(size_t size, uint8_t first = 0) {
+    vector<uint8_t> data(size);
+    iota(data.begin(), data.end(), first);
+    return data;
+}
+
+vector<uint8_t> concat(initializer_list<vector<uint8_t>> parts) {
+    vector<uint8_t> result;
+    for (const auto& part : parts)
+        result.insert(result.end(), part.begin(), part.end());
+    return result;
+}
+
+} // namespace
+
+TEST_F(TestT0, ExtendedCase2) {
+    auto data = makeData(512);
+    auto card = make_shared<rtft::SimpleCard>(concat({ { 0xb0 }, { data.begin(), data.begin() + 256 }, { 0x61, 0x00 },
+                                                       { 0xc0 }, { data.begin() + 256, data.end() }, { 0x90, 0x00 } }));
+    rtft::setCard(card);
+
+    vector<uint8_t> apdu{ 0x00, 0xb0, 0x00, 0x00, 0x00, 0x02, 0x00 };
+    vector<uint8_t> response(514);
+    size_t responseLength = response.size();
+
+    EXPECT_EQ(iso7816_3_status_ok, t0_transmit_apdu(nullptr, apdu.data(), apdu.size(), response.data(), &responseLength));
+    response.resize(responseLength);
+    EXPECT_EQ(concat({ data, { 0x90, 0x00 } }), response);
+    EXPECT_EQ((vector<uint8_t>{ 0x00, 0xb0, 0x00, 0x00, 0x00, 0x00, 0xc0, 0x00, 0x00, 0x00 }), card->getInput());
+}
+
+TEST_F(TestT0, ExtendedCase2WrongLength) {
+    auto data = makeData(16);
+    auto card = make_shared<rtft::SimpleCard>(concat({ { 0x6c, 0x10 }, { 0xb0 }, data, { 0x90, 0x00 } }));
+    rtft::setCard(card);
+
+    vector<uint8_t> apdu{ 0x00, 0xb0, 0x00, 0x00, 0x00, 0x00, 0x00 };
+    vector<uint8_t> response(0x10002);
+    size_t responseLength = response.size();
+
+    EXPECT_EQ(iso7816_3_status_ok, t0_transmit_apdu(nullptr, apdu.data(), apdu.size(), response.data(), &responseLength));
+    response.resize(responseLength);
+    EXPECT_EQ(concat({ data, { 0x90, 0x00 } }), response);
+    EXPECT_EQ((vector<uint8_t>{ 0x00, 0xb0, 0x00, 0x00, 0x00, 0x00, 0xb0, 0x00, 0x00, 0x10 }), card->getInput());
+}
+
+TEST_F(TestT0, ExtendedCase4ShortCommand) {
+    auto data = makeData(3, 0x10);
+    auto card = make_shared<rtft::SimpleCard>(concat({ { 0xca }, { 0x61, 0x03 }, { 0xc0 }, data, { 0x90, 0x00 } }));
+    rtft::setCard(card);
+
+    vector<uint8_t> apdu{ 0x00, 0xca, 0x00, 0x00, 0x00, 0x00, 0x02, 0xaa, 0xbb, 0x00, 0x03 };
+    vector<uint8_t> response(5);
+    size_t responseLength = response.size();
+
+    EXPECT_EQ(iso7816_3_status_ok, t0_transmit_apdu(nullptr, apdu.data(), apdu.size(), response.data(), &responseLength));
+    response.resize(responseLength);
+    EXPECT_EQ(concat({ data, { 0x90, 0x00 } }), response);
+    EXPECT_EQ((vector<uint8_t>{ 0x00, 0xca, 0x00, 0x00, 0x02, 0xaa, 0xbb, 0x00, 0xc0, 0x00, 0x00, 0x03 }),
+              card->getInput());
+}
+
+TEST_F(TestT0, ExtendedCase3Envelope) {
+    auto data = makeData(300);
+    auto apdu = concat({ { 0x80, 0x2a, 0x00, 0x00, 0x00, 0x01, 0x2c }, data });
+    ASSERT_EQ(307u, apdu.size());
+
+    auto card = make_shared<rtft::SimpleCard>(concat({ { 0xc2 }, { 0x90, 0x00 }, { 0xc2 }, { 0x90, 0x00 } }));
+    rtft::setCard(card);
+
+    vector<uint8_t> response(2);
+    size_t responseLength = response.size();
+
+    EXPECT_EQ(iso7816_3_status_ok, t0_transmit_apdu(nullptr, apdu.data(), apdu.size(), response.data(), &responseLength));
+    response.resize(responseLength);
+    EXPECT_EQ((vector<uint8_t>{ 0x90, 0x00 }), response);
+    EXPECT_EQ(concat({ { 0x80, 0xc2, 0x00, 0x00, 0xff }, { apdu.begin(), apdu.begin() + 255 },
+                       { 0x80, 0xc2, 0x00, 0x00, 0x34 }, { apdu.begin() + 255, apdu.end() } }),
+              card->getInput());
+}
+
+TEST_F(TestT0, ExtendedEnvelopeRefused) {
+    auto apdu = concat({ { 0x80, 0x2a, 0x00, 0x00, 0x00, 0x01, 0x2c }, makeData(300) });
+
+    auto card = make_shared<rtft::SimpleCard>(concat({ { 0x6d, 0x00 } }));
+    rtft::setCard(card);
+
+    vector<uint8_t> response(2);
+    size_t responseLength = response.size();
+
+    EXPECT_EQ(iso7816_3_status_ok, t0_transmit_apdu(nullptr, apdu.data(), apdu.size(), response.data(), &responseLength));
+    response.resize(responseLength);
+    EXPECT_EQ((vector<uint8_t>{ 0x6d, 0x00 }), response);
+}
+
+TEST_F(TestT0, ExtendedInsufficientBuffer) {
+    vector<uint8_t> apdu{ 0x00, 0xb0, 0x00, 0x00, 0x00, 0x02, 0x00 };
+    vector<uint8_t> response(257);
+    size_t responseLength = response.size();
+
+    EXPECT_EQ(iso7816_3_status_insufficient_buffer,
+              t0_transmit_apdu(nullptr, apdu.data(), apdu.size(), response.data(), &responseLength));
+}
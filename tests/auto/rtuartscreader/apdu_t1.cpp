@@ -0,0 +1,227 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#include <rtuartscreader/iso7816_3/apdu_t1.h>
+
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <faketransport/faketransport.h>
+#include <faketransport/simplecard.h>
+
+using namespace std;
+
+namespace rtft = rt::faketransport;
+
+namespace {
+
+vector<uint8_t> block(uint8_t pcb, const vector<uint8_t>& inf = {}, bool useCrc = false) {
+    vector<uint8_t> result{ 0x00, pcb, static_cast<uint8_t>(inf.size()) };
+    result.insert(result.end(), inf.begin(), inf.end());
+
+    if (useCrc) {
+        uint16_t crc = 0xFFFF;
+        for (auto b : result) {
+            crc ^= b;
+            for (int bit = 0; bit < 8; ++bit)
+                crc = (crc & 1) ? (crc >> 1) ^ 0x8408 : crc >> 1;
+        }
+        result.push_back(crc >> 8);
+        result.push_back(crc & 0xFF);
+    } else {
+        uint8_t lrc = 0;
+        for (auto b : result)
+            lrc ^= b;
+        result.push_back(lrc);
+    }
+
+    return result;
+}
+
+vector<uint8_t> concat(initializer_list<vector<uint8_t>> blocks) {
+    vector<uint8_t> result;
+    for (const auto& b : blocks)
+        result.insert(result.end(), b.begin(), b.end());
+    return result;
+}
+
+} // namespace
+
+class TestT1 : public testing::Test {
+public:
+    virtual void SetUp() override {
+        t1_params_t params{ .ifsc = T1_MAX_IFS, .cwi = 13, .bwi = 4, .use_crc = false };
+        t1_context_init(&mContext, &params);
+        mContext.ifsd = T1_MAX_IFS;
+    }
+
+    virtual void TearDown() override {
+        rtft::resetCard();
+    }
+
+    shared_ptr<rtft::SimpleCard> setupCardOutput(vector<uint8_t> cardOutput) {
+        auto card = make_shared<rtft::SimpleCard>(move(cardOutput));
+        rtft::setCard(card);
+        return card;
+    }
+
+    iso7816_3_status_t transmit(const vector<uint8_t>& apdu, vector<uint8_t>& response) {
+        response.resize(258);
+        size_t responseLength = response.size();
+
+        auto r = t1_transmit_apdu(nullptr, &mContext, apdu.data(), apdu.size(), response.data(), &responseLength);
+        response.resize(r == iso7816_3_status_ok ? responseLength : 0);
+        return r;
+    }
+
+protected:
+    t1_context_t mContext;
+};
+
+TEST_F(TestT1, Sample) {
+    vector<uint8_t> apdu{ 0x80, 0x00, 0x00, 0x00 };
+    auto card = setupCardOutput(block(0x00, { 0x90, 0x00 }));
+
+    vector<uint8_t> response;
+    EXPECT_EQ(iso7816_3_status_ok, transmit(apdu, response));
+    EXPECT_EQ((vector<uint8_t>{ 0x90, 0x00 }), response);
+    EXPECT_EQ(block(0x00, apdu), card->getInput());
+
+    EXPECT_EQ(1, mContext.ns);
+    EXPECT_EQ(1, mContext.nr);
+}
+
+TEST_F(TestT1, SequenceNumbers) {
+    vector<uint8_t> apdu{ 0x80, 0x00, 0x00, 0x00 };
+    auto card = setupCardOutput(concat({ block(0x00, { 0x90, 0x00 }), block(0x40, { 0x6a, 0x82 }) }));
+
+    vector<uint8_t> response;
+    EXPECT_EQ(iso7816_3_status_ok, transmit(apdu, response));
+    EXPECT_EQ(iso7816_3_status_ok, transmit(apdu, response));
+    EXPECT_EQ((vector<uint8_t>{ 0x6a, 0x82 }), response);
+    EXPECT_EQ(concat({ block(0x00, apdu), block(0x40, apdu) }), card->getInput());
+}
+
+TEST_F(TestT1, CommandChaining) {
+    mContext.ifsc = 4;
+
+    vector<uint8_t> apdu{ 0x80, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09 };
+    auto card = setupCardOutput(concat({ block(0x90), block(0x80), block(0x00, { 0x90, 0x00 }) }));
+
+    vector<uint8_t> response;
+    EXPECT_EQ(iso7816_3_status_ok, transmit(apdu, response));
+    EXPECT_EQ((vector<uint8_t>{ 0x90, 0x00 }), response);
+    EXPECT_EQ(concat({ block(0x20, { 0x80, 0x01, 0x02, 0x03 }),
+                       block(0x60, { 0x04, 0x05, 0x06, 0x07 }),
+                       block(0x00, { 0x08, 0x09 }) }),
+              card->getInput());
+
+    EXPECT_EQ(1, mContext.ns);
+}
+
+TEST_F(TestT1, ResponseChaining) {
+    vector<uint8_t> apdu{ 0x80, 0x00, 0x00, 0x00, 0x00 };
+    auto card = setupCardOutput(concat({ block(0x20, { 0x01, 0x02 }), block(0x40, { 0x03, 0x90, 0x00 }) }));
+
+    vector<uint8_t> response;
+    EXPECT_EQ(iso7816_3_status_ok, transmit(apdu, response));
+    EXPECT_EQ((vector<uint8_t>{ 0x01, 0x02, 0x03, 0x90, 0x00 }), response);
+    EXPECT_EQ(concat({ block(0x00, apdu), block(0x90) }), card->getInput());
+
+    EXPECT_EQ(1, mContext.ns);
+    EXPECT_EQ(0, mContext.nr);
+}
+
+TEST_F(TestT1, WaitingTimeExtension) {
+    vector<uint8_t> apdu{ 0x80, 0x00, 0x00, 0x00 };
+    auto card = setupCardOutput(concat({ block(0xC3, { 0x05 }), block(0x00, { 0x90, 0x00 }) }));
+
+    vector<uint8_t> response;
+    EXPECT_EQ(iso7816_3_status_ok, transmit(apdu, response));
+    EXPECT_EQ((vector<uint8_t>{ 0x90, 0x00 }), response);
+    EXPECT_EQ(concat({ block(0x00, apdu), block(0xE3, { 0x05 }) }), card->getInput());
+}
+
+TEST_F(TestT1, IfscRequest) {
+    vector<uint8_t> apdu{ 0x80, 0x00, 0x00, 0x00 };
+    auto card = setupCardOutput(concat({ block(0xC1, { 0x20 }), block(0x00, { 0x90, 0x00 }) }));
+
+    vector<uint8_t> response;
+    EXPECT_EQ(iso7816_3_status_ok, transmit(apdu, response));
+    EXPECT_EQ(concat({ block(0x00, apdu), block(0xE1, { 0x20 }) }), card->getInput());
+    EXPECT_EQ(0x20, mContext.ifsc);
+}
+
+TEST_F(TestT1, EdcErrorRetransmission) {
+    vector<uint8_t> apdu{ 0x80, 0x00, 0x00, 0x00 };
+    auto corrupted = block(0x00, { 0x90, 0x00 });
+    corrupted.back() ^= 0xFF;
+    auto card = setupCardOutput(concat({ corrupted, block(0x00, { 0x90, 0x00 }) }));
+
+    vector<uint8_t> response;
+    EXPECT_EQ(iso7816_3_status_ok, transmit(apdu, response));
+    EXPECT_EQ((vector<uint8_t>{ 0x90, 0x00 }), response);
+    EXPECT_EQ(concat({ block(0x00, apdu), block(0x81) }), card->getInput());
+}
+
+TEST_F(TestT1, CardRequestsRetransmission) {
+    vector<uint8_t> apdu{ 0x80, 0x00, 0x00, 0x00 };
+    auto card = setupCardOutput(concat({ block(0x82), block(0x00, { 0x90, 0x00 }) }));
+
+    vector<uint8_t> response;
+    EXPECT_EQ(iso7816_3_status_ok, transmit(apdu, response));
+    EXPECT_EQ(concat({ block(0x00, apdu), block(0x00, apdu) }), card->getInput());
+}
+
+TEST_F(TestT1, Resynchronization) {
+    mContext.ns = 1;
+    mContext.nr = 1;
+
+    vector<uint8_t> apdu{ 0x80, 0x00, 0x00, 0x00 };
+    auto invalid = block(0x00, { 0x90, 0x00 }); // wrong sequence number
+    auto card = setupCardOutput(concat({ invalid, invalid, invalid, invalid, block(0xE0), block(0x00, { 0x90, 0x00 }) }));
+
+    vector<uint8_t> response;
+    EXPECT_EQ(iso7816_3_status_ok, transmit(apdu, response));
+    EXPECT_EQ((vector<uint8_t>{ 0x90, 0x00 }), response);
+    EXPECT_EQ(concat({ block(0x40, apdu), block(0x92), block(0x92), block(0x92), block(0xC0), block(0x00, apdu) }),
+              card->getInput());
+
+    EXPECT_EQ(1, mContext.ns);
+    EXPECT_EQ(1, mContext.nr);
+}
+
+TEST_F(TestT1, Crc) {
+    mContext.use_crc = true;
+
+    vector<uint8_t> apdu{ 0x80, 0x00, 0x00, 0x00 };
+    auto card = setupCardOutput(block(0x00, { 0x90, 0x00 }, true));
+
+    vector<uint8_t> response;
+    EXPECT_EQ(iso7816_3_status_ok, transmit(apdu, response));
+    EXPECT_EQ((vector<uint8_t>{ 0x90, 0x00 }), response);
+    EXPECT_EQ(block(0x00, apdu, true), card->getInput());
+}
+
+TEST_F(TestT1, InsufficientBuffer) {
+    vector<uint8_t> apdu{ 0x80, 0x00, 0x00, 0x00 };
+    setupCardOutput(block(0x00, { 0x01, 0x02, 0x90, 0x00 }));
+
+    vector<uint8_t> response(3);
+    size_t responseLength = response.size();
+    EXPECT_EQ(iso7816_3_status_insufficient_buffer,
+              t1_transmit_apdu(nullptr, &mContext, apdu.data(), apdu.size(), response.data(), &responseLength));
+}
+
+TEST_F(TestT1, NegotiateIfsd) {
+    mContext.ifsd = 32;
+    auto card = setupCardOutput(block(0xE1, { 0xFE }));
+
+    EXPECT_EQ(iso7816_3_status_ok, t1_negotiate_ifsd(nullptr, &mContext, 0xFE));
+    EXPECT_EQ(block(0xC1, { 0xFE }), card->getInput());
+    EXPECT_EQ(0xFE, mContext.ifsd);
+}
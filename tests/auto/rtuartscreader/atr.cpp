@@ -10,6 +10,7 @@
 
 #include <gtest/gtest.h>
 
+#include <rtuartscreader/transport/convention.h>
 #include <rtuartscreader/utils/common.h>
 
 #include <faketransport/simplecard.h>
@@ -102,6 +103,7 @@ TEST_F(TestAtr, ParseRutoken2151) {
 
     auto atr_info = parseAtr(getAtr());
 
+    EXPECT_FALSE(atr_info.inverse_convention);
     EXPECT_TRUE(atr_info.ta1.is_present);
     EXPECT_EQ((f_d_index_t{ .f_index = 9, .d_index = 6 }), atr_info.ta1.f_d);
 
@@ -228,11 +230,17 @@ TEST_F(TestAtr, ParseRutoken2100T1) {
     for_each(begin(atr_info.explicit_protocols) + 2, end(atr_info.explicit_protocols), [](const auto& protocol) {
         EXPECT_FALSE(protocol);
     });
+
+    EXPECT_EQ(0x40, atr_info.t1.ifsc);
+    EXPECT_EQ(T1_DEFAULT_CWI, atr_info.t1.cwi);
+    EXPECT_EQ(T1_DEFAULT_BWI, atr_info.t1.bwi);
+    EXPECT_FALSE(atr_info.t1.use_crc);
 }
 
 TEST_F(TestAtr, InvalidTs) {
+    // 0x03 is TS of the inverse convention as it is received
     auto ts = randByte();
-    if (ts == 0x3B) ++ts;
+    while (ts == ATR_TS_DIRECT || ts == 0x03) ++ts;
 
     vector<uint8_t> cardOutput;
     cardOutput.push_back(ts);
@@ -244,6 +252,22 @@ TEST_F(TestAtr, InvalidTs) {
     EXPECT_EQ(iso7816_3_status_unexpected_card_response, r);
 }
 
+TEST_F(TestAtr, InverseConvention) {
+    vector<uint8_t> expected{ kAtr2100T1 };
+    expected[0] = ATR_TS_INVERSE;
+
+    vector<uint8_t> cardOutput = expected;
+    transport_convert_inverse(cardOutput.data(), cardOutput.size());
+    setupCardOutput(cardOutput);
+
+    auto atr = getAtr();
+    EXPECT_EQ(expected, vector<uint8_t>(atr.atr, atr.atr + atr.atr_len));
+
+    auto atr_info = parseAtr(atr);
+    EXPECT_TRUE(atr_info.inverse_convention);
+    EXPECT_TRUE(atr_info.explicit_protocols[PROTOCOL_T1]);
+}
+
 TEST_F(TestAtr, InvalidTck) {
     vector<uint8_t> cardOutput{ kAtr2100T1 };
     ++cardOutput.back();
@@ -459,6 +483,17 @@ TEST_F(TestAtr, ParseTC2) {
     }
 }
 
+TEST_F(TestAtr, ParseT1Params) {
+    initializer_list<uint8_t> cardOutput{ 0x3b, 0x80, 0x80, 0x71, 0x40, 0x4d, 0x01, 0x7d };
+    setupCardOutput(cardOutput);
+
+    auto atr_info = parseAtr(getAtr());
+    EXPECT_EQ(0x40, atr_info.t1.ifsc);
+    EXPECT_EQ(0x0d, atr_info.t1.cwi);
+    EXPECT_EQ(0x04, atr_info.t1.bwi);
+    EXPECT_TRUE(atr_info.t1.use_crc);
+}
+
 TEST_F(TestAtr, ParseInterfaceBytesAbsent) {
     initializer_list<uint8_t> cardOutput{ 0x3b, 0x01, 0xff };
     setupCardOutput(cardOutput);
@@ -468,4 +503,9 @@ TEST_F(TestAtr, ParseInterfaceBytesAbsent) {
     EXPECT_FALSE(atr_info.ta2.is_present);
     EXPECT_FALSE(atr_info.tc1.is_present);
     EXPECT_FALSE(atr_info.tc2.is_present);
+
+    EXPECT_EQ(T1_DEFAULT_IFS, atr_info.t1.ifsc);
+    EXPECT_EQ(T1_DEFAULT_CWI, atr_info.t1.cwi);
+    EXPECT_EQ(T1_DEFAULT_BWI, atr_info.t1.bwi);
+    EXPECT_FALSE(atr_info.t1.use_crc);
 }
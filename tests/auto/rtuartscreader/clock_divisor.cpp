@@ -0,0 +1,58 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#include <rtuartscreader/hardware/detail/clock_divisor.h>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+// The oscillator and PLLD of BCM2835-BCM2837 and of BCM2711
+const uint32_t kSources[] = { 19200000, 500000000 };
+const uint32_t kSources2711[] = { 54000000, 750000000 };
+
+} // namespace
+
+TEST(TestClockDivisor, ExactDivisionOfPlld) {
+    EXPECT_EQ(5000000u, hw_gpclk_request(kSources, 2, 5000000));
+    EXPECT_EQ(5000000., hw_gpclk_generated(kSources, 2, 5000000));
+}
+
+// 3.84 MHz is 19.2 MHz / 5, while PLLD needs a fractional divisor for it
+TEST(TestClockDivisor, OscillatorIsTakenIfCloser) {
+    EXPECT_EQ(3840000u, hw_gpclk_request(kSources, 2, 3840000));
+    EXPECT_EQ(3840000., hw_gpclk_generated(kSources, 2, 3840000));
+}
+
+TEST(TestClockDivisor, SourcesOfBcm2711) {
+    EXPECT_EQ(4000000u, hw_gpclk_request(kSources2711, 2, 4000000));
+    EXPECT_EQ(4000000., hw_gpclk_generated(kSources2711, 2, 4000000));
+}
+
+// From 23.8 MHz the divisor is an integer rounded to the nearest
+TEST(TestClockDivisor, IntegerDivisorAboveMashRange) {
+    EXPECT_EQ(500000000u / 21, hw_gpclk_request(kSources, 2, 24000000));
+    EXPECT_LE(hw_gpclk_generated(kSources, 2, 500000000u / 21), 24000000.);
+}
+
+TEST(TestClockDivisor, GeneratedFrequencyDoesNotExceedLimit) {
+    for (auto sources : { kSources, kSources2711 }) {
+        for (uint32_t frequency = 1000000; frequency <= 20000000; frequency += 12347) {
+            uint32_t request = hw_gpclk_request(sources, 2, frequency);
+            double generated = hw_gpclk_generated(sources, 2, request);
+
+            ASSERT_LE(request, frequency);
+            ASSERT_LE(generated, frequency);
+            ASSERT_NEAR(request, generated, 1.);
+            ASSERT_GT(generated, frequency * (1. - 1. / 4096));
+        }
+    }
+}
+
+TEST(TestClockDivisor, FrequencyOutOfRange) {
+    EXPECT_EQ(0u, hw_gpclk_request(kSources, 2, 0));
+    EXPECT_EQ(0u, hw_gpclk_request(kSources, 2, 1000));
+    EXPECT_EQ(0., hw_gpclk_generated(kSources, 2, 1000));
+}
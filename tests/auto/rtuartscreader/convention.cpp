@@ -0,0 +1,62 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#include <rtuartscreader/transport/convention.h>
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace std;
+
+namespace {
+
+uint8_t convertByte(uint8_t byte) {
+    uint8_t converted = 0;
+    for (int i = 0; i < 8; ++i) {
+        if (byte & (1 << i)) converted |= 0x80 >> i;
+    }
+
+    return ~converted;
+}
+
+} // namespace
+
+TEST(TestConvention, Ts) {
+    uint8_t ts = 0x3F;
+    transport_convert_inverse(&ts, 1);
+    EXPECT_EQ(0x03, ts);
+}
+
+TEST(TestConvention, Involution) {
+    for (int i = 0; i < 256; ++i) {
+        uint8_t byte = static_cast<uint8_t>(i);
+        transport_convert_inverse(&byte, 1);
+        EXPECT_EQ(convertByte(static_cast<uint8_t>(i)), byte);
+
+        transport_convert_inverse(&byte, 1);
+        EXPECT_EQ(i, byte);
+    }
+}
+
+// Bulk conversion goes by words and the tail goes by bytes
+TEST(TestConvention, Buffer) {
+    vector<uint8_t> source(300);
+    for (size_t i = 0; i < source.size(); ++i) {
+        source[i] = static_cast<uint8_t>(i * 37 + 11);
+    }
+
+    for (size_t offset = 0; offset < 8; ++offset) {
+        for (size_t len = 0; len < source.size() - offset; len += 7) {
+            vector<uint8_t> buf = source;
+            transport_convert_inverse(buf.data() + offset, len);
+
+            for (size_t i = 0; i < buf.size(); ++i) {
+                bool converted = i >= offset && i < offset + len;
+                ASSERT_EQ(converted ? convertByte(source[i]) : source[i], buf[i]) << offset << " " << len << " " << i;
+            }
+        }
+    }
+}
@@ -0,0 +1,79 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#include <rtuartscreader/transport/presence.h>
+
+#include <chrono>
+#include <future>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include <fakehardware/fakehardware.h>
+
+using namespace std;
+using namespace std::chrono;
+
+// The fake backend waits for its card detect line the way the pigpio one does
+class TestDetectLine : public testing::Test {
+public:
+    virtual void SetUp() override {
+        mHw = {};
+        mHw.has_detect_pin = true;
+        ASSERT_EQ(hw_status_ok, hw_detect_initialize(&mHw));
+    }
+
+    virtual void TearDown() override {
+        // Drops the cancellation, the other tests wait on the same line without initializing it
+        hw_detect_initialize(&mHw);
+        rt::fakehardware::setCardDetected(true);
+    }
+
+    future<transport_status_t> waitAsync(bool present, uint32_t timeout_ms) {
+        return async(launch::async, [this, present, timeout_ms] {
+            return transport_wait_card_change(&mHw, present, timeout_ms);
+        });
+    }
+
+protected:
+    hw_config_t mHw;
+};
+
+TEST_F(TestDetectLine, ChangedLineIsNotWaited) {
+    EXPECT_EQ(transport_status_ok, transport_wait_card_change(&mHw, false, HW_WAIT_INFINITE));
+}
+
+TEST_F(TestDetectLine, TimesOutOnSteadyLine) {
+    auto start = steady_clock::now();
+
+    EXPECT_EQ(transport_status_timeout, transport_wait_card_change(&mHw, true, 20));
+    EXPECT_GE(steady_clock::now() - start, milliseconds(20));
+}
+
+TEST_F(TestDetectLine, InfiniteWaitEndsOnChange) {
+    auto wait = waitAsync(true, HW_WAIT_INFINITE);
+    EXPECT_EQ(future_status::timeout, wait.wait_for(milliseconds(50)));
+
+    rt::fakehardware::setCardDetected(false);
+    ASSERT_EQ(future_status::ready, wait.wait_for(seconds(5)));
+    EXPECT_EQ(transport_status_ok, wait.get());
+}
+
+TEST_F(TestDetectLine, CancelEndsInfiniteWait) {
+    auto wait = waitAsync(true, HW_WAIT_INFINITE);
+    EXPECT_EQ(future_status::timeout, wait.wait_for(milliseconds(50)));
+
+    EXPECT_EQ(transport_status_ok, transport_cancel_card_wait(&mHw));
+    ASSERT_EQ(future_status::ready, wait.wait_for(seconds(5)));
+    EXPECT_EQ(transport_status_ok, wait.get());
+}
+
+TEST_F(TestDetectLine, CancelIsKeptUntilInitialize) {
+    EXPECT_EQ(transport_status_ok, transport_cancel_card_wait(&mHw));
+    EXPECT_EQ(transport_status_ok, transport_wait_card_change(&mHw, true, HW_WAIT_INFINITE));
+
+    ASSERT_EQ(hw_status_ok, hw_detect_initialize(&mHw));
+    EXPECT_EQ(transport_status_timeout, transport_wait_card_change(&mHw, true, 0));
+}
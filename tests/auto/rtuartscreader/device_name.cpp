@@ -0,0 +1,114 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+extern "C" {
+#include <rtuartscreader/transport/device_name.h>
+}
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+using namespace std;
+
+class TestDeviceName : public testing::Test {
+public:
+    transport_status_t parse(const char* deviceName) {
+        return parse_device_name(deviceName, mPath, sizeof(mPath), &mConfig, &mRealtime);
+    }
+
+protected:
+    char mPath[64];
+    hw_config_t mConfig;
+    realtime_config_t mRealtime;
+};
+
+TEST_F(TestDeviceName, PathOnly) {
+    ASSERT_EQ(transport_status_ok, parse("/dev/ttyAMA0"));
+
+    EXPECT_EQ(string("/dev/ttyAMA0"), mPath);
+    EXPECT_EQ(HW_DEFAULT_RST_PIN, mConfig.rst_pin);
+    EXPECT_EQ(HW_DEFAULT_CLOCK_PIN, mConfig.clock_pin);
+    EXPECT_FALSE(mConfig.has_detect_pin);
+    EXPECT_FALSE(mConfig.has_io_pin);
+    EXPECT_FALSE(realtime_config_enabled(&mRealtime));
+}
+
+TEST_F(TestDeviceName, AllPins) {
+    ASSERT_EQ(transport_status_ok, parse("/dev/ttyAMA1:rst=5:clk=13:det=6"));
+
+    EXPECT_EQ(string("/dev/ttyAMA1"), mPath);
+    EXPECT_EQ(5u, mConfig.rst_pin);
+    EXPECT_EQ(13u, mConfig.clock_pin);
+    EXPECT_TRUE(mConfig.has_detect_pin);
+    EXPECT_EQ(6u, mConfig.detect_pin);
+    EXPECT_FALSE(mConfig.detect_active_low);
+}
+
+TEST_F(TestDeviceName, DetectActiveLow) {
+    ASSERT_EQ(transport_status_ok, parse("/dev/ttyAMA1:ndet=26"));
+
+    EXPECT_TRUE(mConfig.has_detect_pin);
+    EXPECT_EQ(26u, mConfig.detect_pin);
+    EXPECT_TRUE(mConfig.detect_active_low);
+}
+
+TEST_F(TestDeviceName, SomePins) {
+    ASSERT_EQ(transport_status_ok, parse("/dev/ttyAMA1:clk=19"));
+
+    EXPECT_EQ(string("/dev/ttyAMA1"), mPath);
+    EXPECT_EQ(HW_DEFAULT_RST_PIN, mConfig.rst_pin);
+    EXPECT_EQ(19u, mConfig.clock_pin);
+    EXPECT_EQ(hw_clock_pwm, mConfig.clock_source);
+}
+
+TEST_F(TestDeviceName, GpclkPin) {
+    ASSERT_EQ(transport_status_ok, parse("/dev/ttyAMA1:gpclk=4"));
+
+    EXPECT_EQ(4u, mConfig.clock_pin);
+    EXPECT_EQ(hw_clock_gpclk, mConfig.clock_source);
+}
+
+TEST_F(TestDeviceName, IoPin) {
+    ASSERT_EQ(transport_status_ok, parse("/dev/null:io=27"));
+
+    EXPECT_TRUE(mConfig.has_io_pin);
+    EXPECT_EQ(27u, mConfig.io_pin);
+}
+
+TEST_F(TestDeviceName, Realtime) {
+    ASSERT_EQ(transport_status_ok, parse("/dev/ttyAMA1:rt=50:cpu=3"));
+
+    EXPECT_EQ(50, mRealtime.priority);
+    EXPECT_TRUE(mRealtime.pin_cpu);
+    EXPECT_EQ(3u, mRealtime.cpu);
+}
+
+TEST_F(TestDeviceName, PathWithSeparators) {
+    ASSERT_EQ(transport_status_ok, parse("/dev/serial/by-path/platform-3f980000.usb-usb-0:1.2:1.0-port0:rst=5"));
+
+    EXPECT_EQ(string("/dev/serial/by-path/platform-3f980000.usb-usb-0:1.2:1.0-port0"), mPath);
+    EXPECT_EQ(5u, mConfig.rst_pin);
+}
+
+TEST_F(TestDeviceName, OnlyTrailingOptions) {
+    ASSERT_EQ(transport_status_ok, parse("/dev/tty:pwm=12:clk=19"));
+
+    EXPECT_EQ(string("/dev/tty:pwm=12"), mPath);
+    EXPECT_EQ(19u, mConfig.clock_pin);
+}
+
+TEST_F(TestDeviceName, Invalid) {
+    EXPECT_EQ(transport_status_invalid_device_name, parse(""));
+    EXPECT_EQ(transport_status_invalid_device_name, parse(":rst=5"));
+    EXPECT_EQ(transport_status_invalid_device_name, parse("/dev/ttyAMA1:rst="));
+    EXPECT_EQ(transport_status_invalid_device_name, parse("/dev/ttyAMA1:rst=-5"));
+    EXPECT_EQ(transport_status_invalid_device_name, parse("/dev/ttyAMA1:rst=5x"));
+    EXPECT_EQ(transport_status_invalid_device_name, parse("/dev/ttyAMA1:det="));
+    EXPECT_EQ(transport_status_invalid_device_name, parse("/dev/ttyAMA1:io=x"));
+    EXPECT_EQ(transport_status_invalid_device_name, parse("/dev/ttyAMA1:rt=0"));
+    EXPECT_EQ(transport_status_invalid_device_name, parse("/dev/ttyAMA1:rt=100"));
+    EXPECT_EQ(transport_status_invalid_device_name, parse(("/dev/" + string(sizeof(mPath), 'a')).c_str()));
+}
@@ -5,33 +5,168 @@
 
 #include <fakehardware/fakehardware.h>
 
+#include <atomic>
+#include <mutex>
+
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <rtuartscreader/hardware/detail/detect_line.h>
 #include <rtuartscreader/hardware/hardware.h>
 
-hw_status_t hw_initialize_impl() {
+extern "C" {
+#include <rtuartscreader/transport/detail/serial_speed.h>
+}
+
+hw_status_t hw_initialize_impl(const hw_config_t* config) {
     return hw_status_ok;
 }
 
-hw_status_t hw_start_clock_impl(uint32_t frequency) {
+uint32_t gClockBase = 0;
+
+uint32_t hw_clock_frequency_impl(const hw_config_t* config, uint32_t frequency) {
+    if (!gClockBase) {
+        return frequency;
+    }
+
+    return gClockBase / ((gClockBase - 1) / frequency + 1);
+}
+
+hw_status_t hw_start_clock_impl(const hw_config_t* config, uint32_t frequency) {
     return hw_status_ok;
 }
 
-hw_status_t hw_stop_clock_impl() {
+unsigned gClockStopCount = 0;
+
+hw_status_t hw_stop_clock_impl(const hw_config_t* config) {
+    ++gClockStopCount;
     return hw_status_ok;
 }
 
-hw_status_t hw_rst_initialize_impl() {
+hw_status_t hw_rst_initialize_impl(const hw_config_t* config) {
     return hw_status_ok;
 }
 
-hw_status_t hw_rst_down_impl() {
+hw_status_t hw_rst_down_impl(const hw_config_t* config) {
     return hw_status_ok;
 }
 
-hw_status_t hw_rst_down_up_impl(uint32_t delay_us) {
+std::function<void()> gResetHandler;
+
+hw_status_t hw_rst_down_up_impl(const hw_config_t* config, uint32_t delay_us) {
+    if (gResetHandler) gResetHandler();
     return hw_status_ok;
 }
 
-hw_status_t hw_rst_deinitialize_impl() {
+hw_status_t hw_rst_deinitialize_impl(const hw_config_t* config) {
+    return hw_status_ok;
+}
+
+std::atomic<bool> gCardDetected(true);
+
+hw_detect_line_t* detectLine() {
+    static hw_detect_line_t line;
+    static std::once_flag once;
+
+    std::call_once(once, [] { hw_detect_line_initialize(&line); });
+
+    return &line;
+}
+
+hw_status_t hw_detect_initialize_impl(const hw_config_t* config) {
+    hw_detect_line_reset(detectLine());
+    return hw_status_ok;
+}
+
+hw_status_t hw_detect_read_impl(const hw_config_t* config, bool* present) {
+    *present = gCardDetected;
+    return hw_status_ok;
+}
+
+hw_status_t hw_detect_wait_impl(const hw_config_t* config, bool present, uint32_t timeout_ms) {
+    return hw_detect_line_wait(detectLine(), config, hw_detect_read_impl, present, timeout_ms);
+}
+
+hw_status_t hw_detect_cancel_impl(const hw_config_t* config) {
+    hw_detect_line_cancel(detectLine());
+    return hw_status_ok;
+}
+
+hw_status_t hw_detect_deinitialize_impl(const hw_config_t* config) {
+    return hw_detect_cancel_impl(config);
+}
+
+int gSerialLine = -1;
+unsigned gSerialWriteCount = 0;
+uint32_t gSerialExtraGuardTime = 0;
+
+// As the line sampled by pigpio
+const uint32_t kSerialMaxBaudrate = 250000;
+
+uint32_t hw_serial_max_baudrate_impl(const hw_config_t* config) {
+    return kSerialMaxBaudrate;
+}
+
+hw_status_t hw_serial_open_impl(const hw_config_t* config, uint32_t baudrate) {
+    if (gSerialLine == -1) {
+        return hw_status_failed;
+    }
+
+    if (isatty(gSerialLine)) {
+        termios options;
+        if (tcgetattr(gSerialLine, &options)) return hw_status_failed;
+        cfmakeraw(&options);
+        if (tcsetattr(gSerialLine, TCSANOW, &options)) return hw_status_failed;
+
+        if (set_serial_speed(gSerialLine, baudrate) != transport_status_ok) return hw_status_failed;
+    }
+
+    return hw_status_ok;
+}
+
+hw_status_t hw_serial_write_impl(const hw_config_t* config, uint32_t baudrate, uint32_t extra_gt_us,
+                                 hw_parity_t parity, const uint8_t* bytes, size_t len) {
+    ++gSerialWriteCount;
+    gSerialExtraGuardTime = extra_gt_us;
+
+    for (size_t sent = 0; sent != len;) {
+        auto r = write(gSerialLine, bytes + sent, len - sent);
+        if (r <= 0) return hw_status_failed;
+        sent += r;
+    }
+
+    return hw_status_ok;
+}
+
+// The line is never closed in the hardware, so the end of file is just no data
+hw_status_t hw_serial_read_impl(const hw_config_t* config, hw_parity_t parity, uint8_t* buf, size_t len,
+                                size_t* read) {
+    *read = 0;
+
+    pollfd fd = { gSerialLine, POLLIN, 0 };
+    if (poll(&fd, 1, 0) == -1) return hw_status_failed;
+    if (!(fd.revents & POLLIN)) return hw_status_ok;
+
+    auto r = ::read(gSerialLine, buf, len);
+    if (r < 0) return hw_status_failed;
+
+    *read = r;
+    return hw_status_ok;
+}
+
+hw_status_t hw_serial_flush_impl(const hw_config_t* config) {
+    uint8_t buf[64];
+    size_t read;
+
+    do {
+        if (hw_serial_read_impl(config, hw_parity_ignored, buf, sizeof(buf), &read) != hw_status_ok) return hw_status_failed;
+    } while (read);
+
+    return hw_status_ok;
+}
+
+hw_status_t hw_serial_close_impl(const hw_config_t* config) {
     return hw_status_ok;
 }
 
@@ -40,12 +175,24 @@ void hw_deinitialize_impl() {
 
 hw_impl_t gHardwareImpl = {
     .hw_initialize = hw_initialize_impl,
+    .hw_clock_frequency = hw_clock_frequency_impl,
     .hw_start_clock = hw_start_clock_impl,
     .hw_stop_clock = hw_stop_clock_impl,
     .hw_rst_initialize = hw_rst_initialize_impl,
     .hw_rst_down = hw_rst_down_impl,
     .hw_rst_down_up = hw_rst_down_up_impl,
     .hw_rst_deinitialize = hw_rst_deinitialize_impl,
+    .hw_detect_initialize = hw_detect_initialize_impl,
+    .hw_detect_read = hw_detect_read_impl,
+    .hw_detect_wait = hw_detect_wait_impl,
+    .hw_detect_cancel = hw_detect_cancel_impl,
+    .hw_detect_deinitialize = hw_detect_deinitialize_impl,
+    .hw_serial_max_baudrate = hw_serial_max_baudrate_impl,
+    .hw_serial_open = hw_serial_open_impl,
+    .hw_serial_write = hw_serial_write_impl,
+    .hw_serial_read = hw_serial_read_impl,
+    .hw_serial_flush = hw_serial_flush_impl,
+    .hw_serial_close = hw_serial_close_impl,
     .hw_deinitialize = hw_deinitialize_impl
 };
 
@@ -59,5 +206,40 @@ void deinitialize() {
     hw_impl_reset();
 }
 
+void setCardDetected(bool detected) {
+    gCardDetected = detected;
+    hw_detect_line_notify(detectLine());
+}
+
+unsigned clockStopCount() {
+    return gClockStopCount;
+}
+
+void resetClockStopCount() {
+    gClockStopCount = 0;
+}
+
+void setClockBase(uint32_t base) {
+    gClockBase = base;
+}
+
+void setResetHandler(std::function<void()> handler) {
+    gResetHandler = std::move(handler);
+}
+
+void setSerialLine(int handle) {
+    gSerialLine = handle;
+    gSerialWriteCount = 0;
+    gSerialExtraGuardTime = 0;
+}
+
+unsigned serialWriteCount() {
+    return gSerialWriteCount;
+}
+
+uint32_t serialExtraGuardTime() {
+    return gSerialExtraGuardTime;
+}
+
 } // namespace fakehardware
 } // namespace rt
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include <faketransport/initialize.h>
 
 #include <memory>
+#include <stdexcept>
 
 #include <rtuartscreader/transport/initialize.h>
 
@@ -28,10 +29,16 @@ transport_status_t transport_deinitialize_impl(const transport_t* transport) {
     return gFakeInitialize->transport_deinitialize(transport);
 }
 
+uint32_t transport_max_baudrate_impl(const transport_t* transport) {
+    if (!gFakeInitialize) throw runtime_error("You need to set faketransport::Initialize object");
+    return gFakeInitialize->transport_max_baudrate(transport);
+}
+
 transport_initialize_impl_t gTransportInitializeImpl = {
     .transport_initialize = transport_initialize_impl,
     .transport_reinitialize = transport_reinitialize_impl,
-    .transport_deinitialize = transport_deinitialize_impl
+    .transport_deinitialize = transport_deinitialize_impl,
+    .transport_max_baudrate = transport_max_baudrate_impl
 };
 
 namespace rt {
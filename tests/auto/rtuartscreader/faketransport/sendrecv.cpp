@@ -5,6 +5,8 @@
 
 #include "sendrecv.h"
 
+#include <stdexcept>
+
 #include <faketransport/faketransport.h>
 
 using namespace std;
@@ -23,6 +25,10 @@ transport_status_t transport_recv_bytes_impl(const transport_t* transport, uint8
     return gFakeSendRecv->recv_bytes(transport, buf, len);
 }
 
+transport_status_t transport_recv_block_bytes_impl(const transport_t* transport, uint8_t* buf, size_t len) {
+    return gFakeSendRecv->recv_bytes(transport, buf, len);
+}
+
 transport_status_t transport_send_bytes_impl(const transport_t* transport, const uint8_t* buf, size_t len) {
     return gFakeSendRecv->send_bytes(transport, buf, len);
 }
@@ -31,6 +37,7 @@ transport_sendrecv_impl_t gSendRecvImpl = {
     .transport_recv_byte = transport_recv_byte_impl,
     .transport_send_byte = transport_send_byte_impl,
     .transport_recv_bytes = transport_recv_bytes_impl,
+    .transport_recv_block_bytes = transport_recv_block_bytes_impl,
     .transport_send_bytes = transport_send_bytes_impl
 };
 
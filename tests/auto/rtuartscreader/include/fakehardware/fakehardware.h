@@ -5,11 +5,36 @@
 
 #pragma once
 
+#include <cstdint>
+#include <functional>
+
 namespace rt {
 namespace fakehardware {
 
 void initialize();
 void deinitialize();
 
+// Level of the card detect line, the card is detected by default
+void setCardDetected(bool detected);
+
+// Number of hw_stop_clock calls since the last reset
+unsigned clockStopCount();
+void resetClockStopCount();
+
+// The clock divides the base by an integer, any frequency is achieved if it is 0
+void setClockBase(uint32_t base);
+
+// Called when RST goes high, so that the card starts its answer to reset
+void setResetHandler(std::function<void()> handler);
+
+// The I/O line of the wave engine: the sent characters are written to the descriptor,
+// the received ones are read from it without waiting. The baud rate is set up on
+// a terminal, so that the emulator on its other side follows it.
+void setSerialLine(int handle);
+
+// Number of hw_serial_write calls since the line is set and the extra guard time of the last one
+unsigned serialWriteCount();
+uint32_t serialExtraGuardTime();
+
 } // namespace fakehardware
 } // namespace rt
\ No newline at end of file
@@ -17,6 +17,10 @@ public:
     virtual transport_status_t transport_initialize(transport_t* transport, const char* name) = 0;
     virtual transport_status_t transport_reinitialize(transport_t* transport, const transmit_params_t* params) = 0;
     virtual transport_status_t transport_deinitialize(const transport_t* transport) = 0;
+    // The tty engine limit by default
+    virtual uint32_t transport_max_baudrate(const transport_t* transport) {
+        return TRANSPORT_TTY_MAX_BAUDRATE;
+    }
     virtual ~Initialize() = default;
 };
 
@@ -0,0 +1,91 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#include <rtuartscreader/transport/initialize_wave.h>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <stdexcept>
+
+#include <gtest/gtest.h>
+
+#include <rtuartscreader/transport/detail/transmit_params.h>
+
+#include <fakehardware/fakehardware.h>
+
+using namespace std;
+
+namespace rtfh = rt::fakehardware;
+
+// The initialization of the wave engine is run directly from its table
+// against the fake hardware with a socket pair as the I/O line
+class TestInitializeWave : public testing::Test {
+public:
+    virtual void SetUp() override {
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, mLine)) throw runtime_error("socketpair failed");
+
+        rtfh::setSerialLine(mLine[0]);
+        mTransport = {};
+    }
+
+    virtual void TearDown() override {
+        rtfh::setSerialLine(-1);
+        close(mLine[0]);
+        close(mLine[1]);
+    }
+
+protected:
+    const transport_initialize_impl_t* mImpl = transport_initialize_wave_impl();
+    transport_t mTransport;
+    int mLine[2];
+};
+
+TEST_F(TestInitializeWave, RequiresIoPin) {
+    EXPECT_EQ(transport_status_invalid_device_name, mImpl->transport_initialize(&mTransport, "/dev/ttyAMA0"));
+}
+
+TEST_F(TestInitializeWave, SerialPortIsNotOpened) {
+    ASSERT_EQ(transport_status_ok, mImpl->transport_initialize(&mTransport, "/dev/nonexistent:io=27"));
+
+    EXPECT_EQ(-1, mTransport.handle);
+    EXPECT_EQ(27u, mTransport.hw.io_pin);
+
+    EXPECT_EQ(transport_status_ok, mImpl->transport_deinitialize(&mTransport));
+}
+
+TEST_F(TestInitializeWave, LineIsReopenedForAnotherBaudrateOnly) {
+    ASSERT_EQ(transport_status_ok, mImpl->transport_initialize(&mTransport, "/dev/null:io=27"));
+
+    // The noise is dropped if the line is kept
+    const uint8_t noise[] = { 0x00, 0x80 };
+    ASSERT_EQ(static_cast<ssize_t>(sizeof(noise)), write(mLine[1], noise, sizeof(noise)));
+
+    transmit_params_t params = *transmit_params_default();
+    params.wt_us *= 2;
+    EXPECT_EQ(transport_status_ok, mImpl->transport_reinitialize(&mTransport, &params));
+    EXPECT_EQ(0u, mTransport.reconfig_stats.serial_setups);
+    EXPECT_EQ(1u, mTransport.reconfig_stats.serial_setups_skipped);
+
+    uint8_t byte;
+    size_t read;
+    EXPECT_EQ(hw_status_ok, hw_serial_read(&mTransport.hw, hw_parity_ignored, &byte, 1, &read));
+    EXPECT_EQ(0u, read);
+
+    params.transmit_speed.baudrate *= 2;
+    EXPECT_EQ(transport_status_ok, mImpl->transport_reinitialize(&mTransport, &params));
+    EXPECT_EQ(1u, mTransport.reconfig_stats.serial_setups);
+
+    EXPECT_EQ(transport_status_ok, mImpl->transport_deinitialize(&mTransport));
+}
+
+TEST_F(TestInitializeWave, MaxBaudrateIsThatOfLine) {
+    ASSERT_EQ(transport_status_ok, mImpl->transport_initialize(&mTransport, "/dev/null:io=27"));
+
+    EXPECT_EQ(hw_serial_max_baudrate(&mTransport.hw), mImpl->transport_max_baudrate(&mTransport));
+    EXPECT_GT(TRANSPORT_TTY_MAX_BAUDRATE, mImpl->transport_max_baudrate(&mTransport));
+
+    EXPECT_EQ(transport_status_ok, mImpl->transport_deinitialize(&mTransport));
+}
@@ -0,0 +1,113 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#include <log/log.h>
+
+#include <cstdarg>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace std;
+
+namespace {
+
+vector<string> gMessages;
+
+void captureLog(const int priority, const char* fmt, ...) {
+    char message[1024];
+
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(message, sizeof(message), fmt, args);
+    va_end(args);
+
+    gMessages.push_back(message);
+}
+
+int convertToPriority(log_level_t logLevel) {
+    return logLevel;
+}
+
+bool endsWith(const string& str, const string& suffix) {
+    return str.size() >= suffix.size() && str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+} // namespace
+
+class TestLog : public testing::Test {
+public:
+    virtual void SetUp() override {
+        if (LOG_MAX_LEVEL < LOG_LEVEL_INFO) GTEST_SKIP() << "INFO messages are compiled out";
+
+        gMessages.clear();
+        log_init(LOG_LEVEL_INFO, captureLog, convertToPriority);
+    }
+
+    virtual void TearDown() override {
+        log_flush_deferred();
+        log_init(LOG_LEVEL_NONE, captureLog, convertToPriority);
+    }
+};
+
+TEST_F(TestLog, DeferredDumpIsEmittedOnFlush) {
+    const uint8_t data[] = { 0x01, 0xab, 0xff };
+    LOG_XXD_INFO_DEFERRED(data, sizeof(data), "send: ");
+    EXPECT_TRUE(gMessages.empty());
+
+    log_flush_deferred();
+    ASSERT_EQ(1u, gMessages.size());
+    EXPECT_TRUE(endsWith(gMessages[0], "send: 01 AB FF ")) << gMessages[0];
+}
+
+TEST_F(TestLog, MessageEmitsDeferredFirst) {
+    const uint8_t data[] = { 0x01 };
+    LOG_XXD_INFO_DEFERRED(data, sizeof(data), "recv: ");
+    LOG_INFO("done: %d", 1);
+
+    ASSERT_EQ(2u, gMessages.size());
+    EXPECT_TRUE(endsWith(gMessages[0], "recv: 01 ")) << gMessages[0];
+    EXPECT_TRUE(endsWith(gMessages[1], "done: 1")) << gMessages[1];
+}
+
+TEST_F(TestLog, DisabledLevelIsNotDeferred) {
+    log_set_log_level(LOG_LEVEL_ERROR);
+
+    const uint8_t data[] = { 0x01 };
+    LOG_XXD_INFO_DEFERRED(data, sizeof(data), "send: ");
+    log_flush_deferred();
+
+    EXPECT_TRUE(gMessages.empty());
+}
+
+TEST_F(TestLog, LongDumpIsEmittedInChunks) {
+    vector<uint8_t> data(4096);
+    LOG_XXD_INFO_DEFERRED(data.data(), data.size(), "send: ");
+
+    EXPECT_EQ(16u, gMessages.size()); // in chunks of 256 bytes
+}
+
+TEST_F(TestLog, DumpIsSplitIntoChunks) {
+    vector<uint8_t> data(257, 0x5a);
+    data.back() = 0xc3;
+    LOG_XXD_INFO(data.data(), data.size(), "recv %d: ", 2);
+
+    string chunk;
+    for (size_t i = 0; i < 256; ++i)
+        chunk += "5A ";
+
+    ASSERT_EQ(2u, gMessages.size());
+    EXPECT_TRUE(endsWith(gMessages[0], "recv 2: " + chunk)) << gMessages[0];
+    EXPECT_TRUE(endsWith(gMessages[1], "recv 2: C3 ")) << gMessages[1];
+}
+
+TEST_F(TestLog, EmptyDump) {
+    LOG_XXD_INFO(nullptr, 0, "recv: %s", "");
+
+    ASSERT_EQ(1u, gMessages.size());
+    EXPECT_TRUE(endsWith(gMessages[0], "recv: ")) << gMessages[0];
+}
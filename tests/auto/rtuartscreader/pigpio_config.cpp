@@ -0,0 +1,38 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#include <rtuartscreader/hardware/detail/pigpio_config.h>
+#include <rtuartscreader/hardware/hardware.h>
+
+#include <gtest/gtest.h>
+
+// Without the alert thread the card detect line is noticed on the wait timeout only
+// and the wave engine receives nothing
+TEST(TestPigpioConfig, AlertThreadIsEnabledOnRequest) {
+    EXPECT_FALSE(HW_PIGPIO_INTERFACES(true) & PI_DISABLE_ALERT);
+}
+
+TEST(TestPigpioConfig, AlertThreadIsDisabledByDefault) {
+    EXPECT_TRUE(HW_PIGPIO_INTERFACES(false) & PI_DISABLE_ALERT);
+}
+
+TEST(TestPigpioConfig, RemoteInterfacesAreDisabled) {
+    for (bool alerts : { false, true }) {
+        EXPECT_TRUE(HW_PIGPIO_INTERFACES(alerts) & PI_DISABLE_FIFO_IF);
+        EXPECT_TRUE(HW_PIGPIO_INTERFACES(alerts) & PI_DISABLE_SOCK_IF);
+    }
+}
+
+TEST(TestPigpioConfig, AlertsAreNeededByDetectAndIoLines) {
+    hw_config_t config = {};
+    EXPECT_FALSE(HW_PIGPIO_NEEDS_ALERTS(&config));
+
+    config.has_detect_pin = true;
+    EXPECT_TRUE(HW_PIGPIO_NEEDS_ALERTS(&config));
+
+    config.has_detect_pin = false;
+    config.has_io_pin = true;
+    EXPECT_TRUE(HW_PIGPIO_NEEDS_ALERTS(&config));
+}
@@ -0,0 +1,450 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+extern "C" {
+#include <rtuartscreader/reader.h>
+#include <rtuartscreader/reader_detail.h>
+#include <rtuartscreader/reader_script.h>
+}
+
+#include <cstdlib>
+#include <memory>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <fakehardware/fakehardware.h>
+#include <faketransport/faketransport.h>
+#include <faketransport/initialize.h>
+#include <faketransport/simplecard.h>
+
+#include "constants.h"
+
+using namespace std;
+
+namespace rtft = rt::faketransport;
+
+class TestReaderAutoGetResponse : public testing::Test {
+public:
+    virtual void SetUp() override {
+        mReader = {};
+        mReader.power = POWERED_ON;
+        mReader.transport.protocol = PROTOCOL_T0;
+        reader_set_auto_get_response(&mReader, true);
+    }
+
+    virtual void TearDown() override {
+        rtft::resetCard();
+    }
+
+    shared_ptr<rtft::SimpleCard> setupCardOutput(vector<uint8_t> cardOutput) {
+        auto card = make_shared<rtft::SimpleCard>(move(cardOutput));
+        rtft::setCard(card);
+        return card;
+    }
+
+    vector<uint8_t> transmit(const vector<uint8_t>& apdu, size_t responseSize = 1024) {
+        vector<uint8_t> response(responseSize);
+        DWORD responseLength = response.size();
+
+        EXPECT_EQ(reader_status_ok, reader_transmit(&mReader, apdu.data(), apdu.size(), response.data(), &responseLength));
+        response.resize(responseLength);
+        return response;
+    }
+
+protected:
+    Reader mReader;
+};
+
+namespace {
+
+vector<uint8_t> makeData(size_t size) {
+    vector<uint8_t> data(size);
+    iota(data.begin(), data.end(), 0);
+    return data;
+}
+
+vector<uint8_t> concat(initializer_list<vector<uint8_t>> parts) {
+    vector<uint8_t> result;
+    for (const auto& part : parts)
+        result.insert(result.end(), part.begin(), part.end());
+    return result;
+}
+
+} // namespace
+
+TEST_F(TestReaderAutoGetResponse, GetResponseChain) {
+    auto data = makeData(300);
+    auto card = setupCardOutput(concat({ { 0x20 }, { 0x61, 0x00 },
+                                         { 0xc0 }, { data.begin(), data.begin() + 256 }, { 0x61, 0x2c },
+                                         { 0xc0 }, { data.begin() + 256, data.end() }, { 0x90, 0x00 } }));
+
+    EXPECT_EQ(concat({ data, { 0x90, 0x00 } }), transmit({ 0x81, 0x20, 0x00, 0x00, 0x01, 0xaa }));
+    EXPECT_EQ((vector<uint8_t>{ 0x81, 0x20, 0x00, 0x00, 0x01, 0xaa,
+                                0x00, 0xc0, 0x00, 0x00, 0x00,
+                                0x00, 0xc0, 0x00, 0x00, 0x2c }),
+              card->getInput());
+}
+
+TEST_F(TestReaderAutoGetResponse, WrongLength) {
+    auto data = makeData(8);
+    auto card = setupCardOutput(concat({ { 0x6c, 0x08 }, { 0xca }, data, { 0x90, 0x00 } }));
+
+    EXPECT_EQ(concat({ data, { 0x90, 0x00 } }), transmit({ 0x00, 0xca, 0x01, 0x02, 0x00 }));
+    EXPECT_EQ((vector<uint8_t>{ 0x00, 0xca, 0x01, 0x02, 0x00, 0x00, 0xca, 0x01, 0x02, 0x08 }), card->getInput());
+}
+
+// Only a 5-byte case 2 command carries the Le the card complains about
+TEST_F(TestReaderAutoGetResponse, WrongLengthOfCase4IsReturned) {
+    auto card = setupCardOutput({ 0xca, 0x6c, 0x08 });
+
+    EXPECT_EQ((vector<uint8_t>{ 0x6c, 0x08 }), transmit({ 0x00, 0xca, 0x01, 0x02, 0x01, 0xaa, 0x00 }));
+    EXPECT_EQ(1u, mReader.stats.apdus);
+}
+
+// Each command sent to the card is counted, the response once it is assembled
+TEST_F(TestReaderAutoGetResponse, StatsCountCommandsSentByDriver) {
+    auto data = makeData(12);
+    setupCardOutput(concat({ { 0x6c, 0x08 }, { 0xca }, { data.begin(), data.begin() + 8 }, { 0x61, 0x04 },
+                             { 0xc0 }, { data.begin() + 8, data.end() }, { 0x90, 0x00 } }));
+
+    EXPECT_EQ(concat({ data, { 0x90, 0x00 } }), transmit({ 0x00, 0xca, 0x01, 0x02, 0x00 }));
+    EXPECT_EQ(3u, mReader.stats.apdus);
+    EXPECT_EQ(15u, mReader.stats.bytes_sent);
+    EXPECT_EQ(2u + 10u + 6u, mReader.stats.bytes_received);
+    EXPECT_EQ(1u, accumulate(begin(mReader.stats.transmit_us), end(mReader.stats.transmit_us), 0u));
+}
+
+TEST_F(TestReaderAutoGetResponse, LimitedByBuffer) {
+    auto data = makeData(16);
+    setupCardOutput(concat({ { 0x61, 0x20 }, { 0xc0 }, data, { 0x61, 0x10 } }));
+
+    EXPECT_EQ(concat({ data, { 0x61, 0x10 } }), transmit({ 0x00, 0xb0, 0x00, 0x00 }, 18));
+}
+
+TEST_F(TestReaderAutoGetResponse, Disabled) {
+    reader_set_auto_get_response(&mReader, false);
+    setupCardOutput({ 0x61, 0x20 });
+
+    EXPECT_EQ((vector<uint8_t>{ 0x61, 0x20 }), transmit({ 0x00, 0xb0, 0x00, 0x00 }));
+}
+
+class TestReaderCardDetect : public testing::Test {
+public:
+    virtual void SetUp() override {
+        mReader = {};
+        mReader.power = POWERED_ON;
+        mReader.presence = PRESENT_TRUE;
+        mReader.transport.hw.has_detect_pin = true;
+    }
+
+    virtual void TearDown() override {
+        rt::fakehardware::setCardDetected(true);
+    }
+
+protected:
+    Reader mReader;
+};
+
+TEST_F(TestReaderCardDetect, Present) {
+    EXPECT_EQ(reader_status_ok, reader_is_present(&mReader));
+    EXPECT_EQ(POWERED_ON, mReader.power);
+}
+
+TEST_F(TestReaderCardDetect, Removed) {
+    rt::fakehardware::setCardDetected(false);
+
+    EXPECT_EQ(reader_status_reader_not_found, reader_is_present(&mReader));
+    EXPECT_EQ(POWERED_OFF, mReader.power);
+    EXPECT_EQ(PRESENT_FALSE, mReader.presence);
+}
+
+TEST_F(TestReaderCardDetect, WaitForChange) {
+    rt::fakehardware::setCardDetected(false);
+    reader_is_present(&mReader);
+
+    reader_presence_watch_t watch;
+    ASSERT_EQ(reader_status_ok, reader_watch_presence(&mReader, &watch));
+    EXPECT_FALSE(watch.present);
+    EXPECT_EQ(reader_status_timeout, reader_wait_presence_change(&watch, 0));
+
+    rt::fakehardware::setCardDetected(true);
+    EXPECT_EQ(reader_status_ok, reader_wait_presence_change(&watch, 0));
+}
+
+TEST_F(TestReaderCardDetect, NoDetectLine) {
+    mReader.transport.hw.has_detect_pin = false;
+
+    reader_presence_watch_t watch;
+    EXPECT_EQ(reader_status_not_supported, reader_watch_presence(&mReader, &watch));
+    EXPECT_EQ(reader_status_not_supported, reader_cancel_presence_wait(&mReader));
+}
+
+class ReinitializeOnly : public rtft::Initialize {
+public:
+    transport_status_t transport_initialize(transport_t* transport, const char* name) override {
+        return transport_status_ok;
+    }
+
+    transport_status_t transport_reinitialize(transport_t* transport, const transmit_params_t* params) override {
+        transport->params = *params;
+        return transport_status_ok;
+    }
+
+    transport_status_t transport_deinitialize(const transport_t* transport) override {
+        return transport_status_ok;
+    }
+};
+
+class TestReaderPresenceProbe : public testing::Test {
+public:
+    virtual void SetUp() override {
+        mReader = {};
+        mReader.transport.atr_cache = &mReader.atrCache;
+        mReader.transport.atr_info = &mReader.atrInfo;
+        rtft::setInitialize(make_unique<ReinitializeOnly>());
+    }
+
+    virtual void TearDown() override {
+        rtft::resetCard();
+        rtft::resetInitialize();
+    }
+
+protected:
+    Reader mReader;
+};
+
+TEST_F(TestReaderPresenceProbe, AtrOnly) {
+    auto card = make_shared<rtft::SimpleCard>(kAtr2151);
+    rtft::setCard(card);
+    ASSERT_EQ(reader_status_ok, reader_set_presence_probe(&mReader, reader_presence_probe_atr, 0));
+
+    EXPECT_EQ(reader_status_ok, reader_is_present(&mReader));
+    EXPECT_EQ(PRESENT_TRUE, mReader.presence);
+    EXPECT_EQ(POWERED_OFF, mReader.power);
+    EXPECT_EQ(vector<uint8_t>(kAtr2151), vector<uint8_t>(mReader.atr, mReader.atr + mReader.atrLength));
+    EXPECT_TRUE(card->getInput().empty()); // no PPS
+}
+
+TEST_F(TestReaderPresenceProbe, CachedResult) {
+    auto card = make_shared<rtft::SimpleCard>(kAtr2151);
+    rtft::setCard(card);
+    ASSERT_EQ(reader_status_ok, reader_set_presence_probe(&mReader, reader_presence_probe_atr, 60000));
+
+    EXPECT_EQ(reader_status_ok, reader_is_present(&mReader));
+    // The card has nothing more to send, so it must not be probed again
+    EXPECT_EQ(reader_status_ok, reader_is_present(&mReader));
+    EXPECT_FALSE(card->hasMoreOutput());
+}
+
+TEST_F(TestReaderPresenceProbe, TtlFromEnvironment) {
+    const char* kTtlVariable = "LIBRTUARTSCREADER_presenceTtl";
+
+    for (auto ttl : { make_pair("1500", 1500u), make_pair("4294967295", 4294967295u), make_pair("-1", 0u),
+                      make_pair("4294967296", 0u), make_pair("15s", 0u), make_pair(" 15", 0u), make_pair("", 0u) }) {
+        ASSERT_EQ(0, setenv(kTtlVariable, ttl.first, 1));
+        ASSERT_EQ(reader_status_ok, reader_open(&mReader, "/dev/null"));
+        EXPECT_EQ(ttl.second, mReader.presenceTtlMs) << ttl.first;
+        ASSERT_EQ(reader_status_ok, reader_close(&mReader));
+    }
+
+    unsetenv(kTtlVariable);
+}
+
+TEST_F(TestReaderPresenceProbe, UnknownProbe) {
+    EXPECT_EQ(reader_status_internal_error,
+              reader_set_presence_probe(&mReader, static_cast<reader_presence_probe_t>(100), 0));
+}
+
+class TestReaderProtocol : public TestReaderPresenceProbe {};
+
+TEST_F(TestReaderProtocol, NegotiatedDuringReset) {
+    DWORD protocol;
+    EXPECT_EQ(reader_status_reader_unpowered, reader_get_protocol(&mReader, &protocol));
+
+    // T=0 only card, which does not accept F & D of TA1
+    rtft::setCard(make_shared<rtft::SimpleCard>(concat({ kAtr2151, { 0xff, 0x00, 0xff } })));
+
+    const UCHAR* atr;
+    DWORD atrLength;
+    ASSERT_EQ(reader_status_ok, reader_power_on(&mReader, &atr, &atrLength));
+
+    ASSERT_EQ(reader_status_ok, reader_get_protocol(&mReader, &protocol));
+    EXPECT_EQ(static_cast<DWORD>(SCARD_PROTOCOL_T0), protocol);
+}
+
+namespace {
+
+uint32_t sum(const uint32_t (&histogram)[READER_STATS_BUCKETS]) {
+    return accumulate(begin(histogram), end(histogram), 0u);
+}
+
+} // namespace
+
+// The reader is reset through the fake transport the same way as by the presence probe
+class TestReaderStats : public TestReaderPresenceProbe {};
+
+TEST_F(TestReaderStats, Collected) {
+    // T=0 only card, which does not accept F & D of TA1
+    auto card = make_shared<rtft::SimpleCard>(
+        concat({ kAtr2151, { 0xff, 0x00, 0xff }, { 0xb0 }, { 0x01, 0x02 }, { 0x90, 0x00 } }));
+    rtft::setCard(card);
+
+    const UCHAR* atr;
+    DWORD atrLength;
+    ASSERT_EQ(reader_status_ok, reader_power_on(&mReader, &atr, &atrLength));
+
+    vector<uint8_t> apdu{ 0x00, 0xb0, 0x00, 0x00, 0x02 };
+    vector<uint8_t> response(16);
+    DWORD responseLength = response.size();
+    ASSERT_EQ(reader_status_ok, reader_transmit(&mReader, apdu.data(), apdu.size(), response.data(), &responseLength));
+
+    reader_stats_t stats;
+    ASSERT_EQ(reader_status_ok, reader_get_stats(&mReader, &stats));
+    EXPECT_EQ(READER_STATS_VERSION, stats.version);
+    EXPECT_EQ(1u, stats.apdus);
+    EXPECT_EQ(5u, stats.bytes_sent);
+    EXPECT_EQ(4u, stats.bytes_received);
+    EXPECT_EQ(1u, stats.resets);
+    EXPECT_EQ(0u, stats.timeouts);
+    EXPECT_EQ(1u, sum(stats.transmit_us));
+    EXPECT_EQ(1u, sum(stats.reset_us));
+    EXPECT_EQ(1u, sum(stats.pps_us));
+}
+
+class TestReaderScript : public TestReaderAutoGetResponse {
+public:
+    virtual void SetUp() override {
+        TestReaderAutoGetResponse::SetUp();
+        reader_set_auto_get_response(&mReader, false);
+        mScript = { reader_script_continue_on_mismatch };
+    }
+
+    void addStep(const vector<uint8_t>& apdu, uint16_t sw, uint16_t swMask) {
+        for (uint16_t value : { static_cast<uint16_t>(apdu.size()), sw, swMask }) {
+            const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+            mScript.insert(mScript.end(), bytes, bytes + sizeof(value));
+        }
+        mScript.insert(mScript.end(), apdu.begin(), apdu.end());
+    }
+
+    reader_status_t run(vector<uint8_t>& output, size_t outputSize = 1024) {
+        output.resize(outputSize);
+        DWORD outputLength = output.size();
+        reader_status_t r = reader_run_script(&mReader, mScript.data(), mScript.size(), output.data(), &outputLength);
+        output.resize(outputLength);
+        return r;
+    }
+
+    static vector<uint8_t> u16(uint16_t value) {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+        return { bytes, bytes + sizeof(value) };
+    }
+
+    static vector<uint8_t> result(reader_script_step_status_t status, const vector<uint8_t>& response) {
+        return concat({ { static_cast<uint8_t>(status) }, u16(response.size()), response });
+    }
+
+protected:
+    vector<uint8_t> mScript;
+};
+
+TEST_F(TestReaderScript, AllStepsRun) {
+    auto card = setupCardOutput({ 0x90, 0x00, 0xb0, 0x01, 0x02, 0x90, 0x00 });
+    addStep({ 0x00, 0xa4, 0x00, 0x00 }, 0x9000, 0xffff);
+    addStep({ 0x00, 0xb0, 0x00, 0x00, 0x02 }, 0x9000, 0xff00);
+
+    vector<uint8_t> output;
+    ASSERT_EQ(reader_status_ok, run(output));
+    EXPECT_EQ(concat({ u16(2), result(reader_script_step_ok, { 0x90, 0x00 }),
+                       result(reader_script_step_ok, { 0x01, 0x02, 0x90, 0x00 }) }),
+              output);
+    EXPECT_EQ(2u, mReader.stats.apdus);
+}
+
+TEST_F(TestReaderScript, MismatchContinues) {
+    setupCardOutput({ 0x6a, 0x82, 0x90, 0x00 });
+    addStep({ 0x00, 0xa4, 0x00, 0x00 }, 0x9000, 0xffff);
+    addStep({ 0x00, 0xa4, 0x00, 0x00 }, 0x0000, 0x0000);
+
+    vector<uint8_t> output;
+    ASSERT_EQ(reader_status_ok, run(output));
+    EXPECT_EQ(concat({ u16(2), result(reader_script_step_sw_mismatch, { 0x6a, 0x82 }),
+                       result(reader_script_step_ok, { 0x90, 0x00 }) }),
+              output);
+}
+
+TEST_F(TestReaderScript, MismatchAborts) {
+    auto card = setupCardOutput({ 0x6a, 0x82 });
+    mScript[0] = reader_script_abort_on_mismatch;
+    addStep({ 0x00, 0xa4, 0x00, 0x00 }, 0x9000, 0xffff);
+    addStep({ 0x00, 0xa4, 0x00, 0x00 }, 0x9000, 0xffff);
+
+    vector<uint8_t> output;
+    ASSERT_EQ(reader_status_ok, run(output));
+    EXPECT_EQ(concat({ u16(1), result(reader_script_step_sw_mismatch, { 0x6a, 0x82 }) }), output);
+    EXPECT_EQ(5u, card->getInput().size()); // only the first command, sent with P3 = 0
+}
+
+TEST_F(TestReaderScript, MalformedScriptIsNotRun) {
+    auto card = setupCardOutput({ 0x90, 0x00 });
+    addStep({ 0x00, 0xa4, 0x00, 0x00 }, 0x9000, 0xffff);
+    mScript.pop_back();
+
+    vector<uint8_t> output;
+    EXPECT_EQ(reader_status_internal_error, run(output));
+    EXPECT_TRUE(card->getInput().empty());
+}
+
+TEST_F(TestReaderScript, TooManySteps) {
+    auto card = setupCardOutput({ 0x90, 0x00 });
+    for (size_t i = 0; i <= READER_SCRIPT_MAX_STEPS; ++i) {
+        addStep({}, 0x0000, 0x0000);
+    }
+
+    vector<uint8_t> output;
+    EXPECT_EQ(reader_status_internal_error, run(output));
+    EXPECT_TRUE(card->getInput().empty());
+}
+
+TEST_F(TestReaderScript, OutputIsTruncated) {
+    auto card = setupCardOutput({ 0x90, 0x00, 0xb0, 0x01, 0x02, 0x90, 0x00 });
+    addStep({ 0x00, 0xa4, 0x00, 0x00 }, 0x9000, 0xffff);
+    addStep({ 0x00, 0xb0, 0x00, 0x00, 0x02 }, 0x9000, 0xffff);
+    addStep({ 0x00, 0xa4, 0x00, 0x00 }, 0x9000, 0xffff);
+
+    vector<uint8_t> output;
+    ASSERT_EQ(reader_status_ok, run(output, 14));
+    EXPECT_EQ(concat({ u16(2), result(reader_script_step_ok, { 0x90, 0x00 }),
+                       result(reader_script_step_output_truncated, {}) }),
+              output);
+    EXPECT_EQ(5u, card->getInput().size()); // Le of the second command does not fit, it is not sent
+}
+
+TEST_F(TestReaderScript, OutputDoesNotFit) {
+    setupCardOutput({ 0x90, 0x00 });
+    addStep({ 0x00, 0xa4, 0x00, 0x00 }, 0x9000, 0xffff);
+
+    vector<uint8_t> output;
+    EXPECT_EQ(reader_status_memory_error, run(output, 4));
+}
+
+TEST_F(TestReaderStats, SchedulingLatencyInRealtimeMode) {
+    rtft::setCard(make_shared<rtft::SimpleCard>(concat({ kAtr2151, { 0xff, 0x00, 0xff } })));
+    mReader.transport.realtime.pin_cpu = true;
+    mReader.transport.realtime.cpu = sched_getcpu();
+
+    const UCHAR* atr;
+    DWORD atrLength;
+    ASSERT_EQ(reader_status_ok, reader_power_on(&mReader, &atr, &atrLength));
+    rtft::setCard(make_shared<rtft::SimpleCard>(concat({ kAtr2151, { 0xff, 0x00, 0xff } })));
+    ASSERT_EQ(reader_status_ok, reader_reset(&mReader, &atr, &atrLength));
+
+    reader_stats_t stats;
+    ASSERT_EQ(reader_status_ok, reader_get_stats(&mReader, &stats));
+    EXPECT_EQ(1u, sum(stats.sched_latency_us)); // not probed again within the period
+}
@@ -0,0 +1,154 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+extern "C" {
+#include <rtuartscreader/reader_detail.h>
+#include <rtuartscreader/reader_list.h>
+}
+
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace std;
+
+class TestReaderList : public testing::Test {
+public:
+    virtual void TearDown() override {
+        for (DWORD lun = 0; lun < gReaderListSize + 1; ++lun) {
+            if (Reader* reader = reader_list_acquire_reader(lun)) reader_list_free_reader(reader);
+        }
+    }
+};
+
+TEST_F(TestReaderList, AllocAcquireFree) {
+    Reader* reader = reader_list_alloc_reader(1);
+    ASSERT_NE(nullptr, reader);
+    reader_list_release_reader(reader);
+
+    EXPECT_EQ(reader, reader_list_acquire_reader(1));
+    EXPECT_EQ(nullptr, reader_list_acquire_reader(2));
+
+    reader_list_free_reader(reader);
+    EXPECT_EQ(nullptr, reader_list_acquire_reader(1));
+}
+
+TEST_F(TestReaderList, LunIsAllocatedOnce) {
+    Reader* reader = reader_list_alloc_reader(1);
+    ASSERT_NE(nullptr, reader);
+    reader_list_release_reader(reader);
+
+    EXPECT_EQ(nullptr, reader_list_alloc_reader(1));
+}
+
+TEST_F(TestReaderList, Overflow) {
+    for (DWORD lun = 0; lun < gReaderListSize; ++lun) {
+        Reader* reader = reader_list_alloc_reader(lun);
+        ASSERT_NE(nullptr, reader);
+        reader_list_release_reader(reader);
+    }
+
+    EXPECT_EQ(nullptr, reader_list_alloc_reader(gReaderListSize));
+}
+
+TEST_F(TestReaderList, ConcurrentAccess) {
+    const DWORD luns = 4;
+    const int threadsPerLun = 4;
+    const int iterations = 10000;
+
+    for (DWORD lun = 0; lun < luns; ++lun) {
+        Reader* reader = reader_list_alloc_reader(lun);
+        ASSERT_NE(nullptr, reader);
+        reader->atrLength = 0;
+        reader_list_release_reader(reader);
+    }
+
+    vector<thread> threads;
+    for (DWORD lun = 0; lun < luns; ++lun) {
+        for (int i = 0; i < threadsPerLun; ++i) {
+            threads.emplace_back([lun] {
+                for (int j = 0; j < iterations; ++j) {
+                    Reader* reader = reader_list_acquire_reader(lun);
+                    if (!reader) return;
+                    // non-atomic increment, only the reader lock protects it
+                    reader->atrLength = reader->atrLength + 1;
+                    reader_list_release_reader(reader);
+                }
+            });
+        }
+    }
+
+    for (auto& t : threads)
+        t.join();
+
+    for (DWORD lun = 0; lun < luns; ++lun) {
+        Reader* reader = reader_list_acquire_reader(lun);
+        ASSERT_NE(nullptr, reader);
+        EXPECT_EQ(static_cast<DWORD>(threadsPerLun * iterations), reader->atrLength);
+        reader_list_release_reader(reader);
+    }
+}
+
+// A shared RST or clock line would reset or clock the card of another reader
+TEST_F(TestReaderList, GpiosAreReservedOnce) {
+    hw_config_t first = {};
+    first.rst_pin = 17;
+    first.clock_pin = 18;
+
+    Reader* reader = reader_list_alloc_reader(1);
+    ASSERT_NE(nullptr, reader);
+    EXPECT_TRUE(reader_list_reserve_gpios(reader, &first));
+    reader_list_release_reader(reader);
+
+    hw_config_t second = {};
+    second.rst_pin = 5;
+    second.clock_pin = 13;
+
+    reader = reader_list_alloc_reader(2);
+    ASSERT_NE(nullptr, reader);
+    EXPECT_TRUE(reader_list_reserve_gpios(reader, &second));
+    reader_list_free_reader(reader);
+
+    for (auto pins : { make_pair(17u, 13u), make_pair(5u, 18u), make_pair(18u, 13u), make_pair(5u, 17u) }) {
+        second.rst_pin = pins.first;
+        second.clock_pin = pins.second;
+
+        reader = reader_list_alloc_reader(2);
+        ASSERT_NE(nullptr, reader);
+        EXPECT_FALSE(reader_list_reserve_gpios(reader, &second)) << pins.first << " " << pins.second;
+        reader_list_free_reader(reader);
+    }
+}
+
+TEST_F(TestReaderList, GpiosAreFreedWithReader) {
+    hw_config_t config = {};
+    config.rst_pin = 17;
+    config.clock_pin = 18;
+
+    Reader* reader = reader_list_alloc_reader(1);
+    ASSERT_NE(nullptr, reader);
+    EXPECT_TRUE(reader_list_reserve_gpios(reader, &config));
+    reader_list_free_reader(reader);
+
+    reader = reader_list_alloc_reader(2);
+    ASSERT_NE(nullptr, reader);
+    EXPECT_TRUE(reader_list_reserve_gpios(reader, &config));
+    reader_list_release_reader(reader);
+}
+
+TEST_F(TestReaderList, StatsDoNotWaitForReader) {
+    Reader* reader = reader_list_alloc_reader(1);
+    ASSERT_NE(nullptr, reader);
+    reader->stats.apdus = 3;
+
+    reader_stats_t stats;
+    EXPECT_TRUE(reader_list_get_stats(1, &stats)); // the reader is still held by this thread
+    EXPECT_EQ(3u, stats.apdus);
+    EXPECT_FALSE(reader_list_get_stats(2, &stats));
+
+    reader_list_release_reader(reader);
+}
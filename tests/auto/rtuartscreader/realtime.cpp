@@ -0,0 +1,42 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+extern "C" {
+#include <rtuartscreader/utils/realtime.h>
+}
+
+#include <gtest/gtest.h>
+
+TEST(TestRealtime, PinnedCpuIsRestored) {
+    cpu_set_t before;
+    ASSERT_EQ(0, pthread_getaffinity_np(pthread_self(), sizeof(before), &before));
+
+    unsigned cpu = 0;
+    while (!CPU_ISSET(cpu, &before))
+        ++cpu;
+
+    realtime_config_t config = {};
+    config.pin_cpu = true;
+    config.cpu = cpu;
+
+    realtime_context_t context;
+    ASSERT_TRUE(realtime_enter(&config, &context));
+    EXPECT_FALSE(context.scheduled);
+    EXPECT_EQ(static_cast<int>(cpu), sched_getcpu());
+
+    realtime_leave(&context);
+
+    cpu_set_t after;
+    ASSERT_EQ(0, pthread_getaffinity_np(pthread_self(), sizeof(after), &after));
+    EXPECT_TRUE(CPU_EQUAL(&before, &after));
+}
+
+TEST(TestRealtime, NothingIsAppliedIfDisabled) {
+    realtime_config_t config = {};
+
+    realtime_context_t context;
+    EXPECT_FALSE(realtime_enter(&config, &context));
+    realtime_leave(&context);
+}
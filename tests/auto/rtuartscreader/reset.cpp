@@ -6,6 +6,7 @@
 #include <rtuartscreader/transport/reset.h>
 
 #include <algorithm>
+#include <cmath>
 #include <initializer_list>
 #include <iomanip>
 #include <iostream>
@@ -14,8 +15,12 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <rtuartscreader/iso7816_3/atr.h>
+#include <rtuartscreader/transport/atr_cache.h>
+#include <rtuartscreader/transport/convention.h>
 #include <rtuartscreader/transport/detail/transmit_params.h>
 
+#include <fakehardware/fakehardware.h>
 #include <faketransport/initialize.h>
 #include <faketransport/simplecard.h>
 
@@ -154,7 +159,10 @@ MATCHER(IsDefaultTransmitParams, "") {
 class TestResetRealAtr : public TestWithParam<const initializer_list<uint8_t>*> {
 public:
     void SetUp() override {
+        mTransport = {};
         mTransport.params = *transmit_params_default();
+        mTransport.atr_cache = &mAtrCache;
+        mTransport.atr_info = &mAtrInfo;
 
         auto transportInitialize = make_unique<MockInitialize>();
 
@@ -175,6 +183,8 @@ public:
 
 protected:
     transport_t mTransport;
+    atr_cache_t mAtrCache = {};
+    atr_info_t mAtrInfo;
 };
 
 TEST_P(TestResetRealAtr, Positive) {
@@ -207,3 +217,275 @@ TEST_P(TestResetRealAtr, Positive) {
 INSTANTIATE_TEST_SUITE_P(Rutoken2151, TestResetRealAtr, Values(&kAtr2151));
 INSTANTIATE_TEST_SUITE_P(Rutoken2100T0, TestResetRealAtr, Values(&kAtr2100T0));
 INSTANTIATE_TEST_SUITE_P(Rutoken2100T1, TestResetRealAtr, Values(&kAtr2100T1));
+
+class TestResetAtrCache : public Test {
+public:
+    void SetUp() override {
+        mTransport = {};
+        mTransport.params = *transmit_params_default();
+        mTransport.atr_cache = &mAtrCache;
+        mTransport.atr_info = &mAtrInfo;
+
+        auto transportInitialize = make_unique<NiceMock<MockInitialize>>();
+        ON_CALL(*transportInitialize, do_transport_reinitialize(_, _)).WillByDefault(Return(transport_status_ok));
+        mInitialize = transportInitialize.get();
+        rtft::setInitialize(move(transportInitialize));
+    }
+    void TearDown() override {
+        rtft::resetCard();
+        rtft::resetInitialize();
+    }
+
+    transport_status_t reset() {
+        vector<uint8_t> atr(255);
+        size_t atrLength = atr.size();
+        return transport_reset(&mTransport, atr.data(), &atrLength);
+    }
+
+protected:
+    transport_t mTransport;
+    atr_cache_t mAtrCache = {};
+    atr_info_t mAtrInfo;
+    MockInitialize* mInitialize;
+};
+
+TEST_F(TestResetAtrCache, Hit) {
+    rtft::setCard(make_shared<ResetCard>(kAtr2100T1));
+    ASSERT_EQ(transport_status_ok, reset());
+    auto params = mTransport.params;
+
+    auto card = make_shared<ResetCard>(kAtr2100T1);
+    rtft::setCard(card);
+    ASSERT_EQ(transport_status_ok, reset());
+
+    EXPECT_EQ(card->ppsRequest(), card->ppsResponse()); // PPS is still exchanged
+    EXPECT_EQ(0, memcmp(&params, &mTransport.params, sizeof(params)));
+    EXPECT_EQ(PROTOCOL_T1, mTransport.protocol);
+    EXPECT_EQ(1u, mAtrCache.hits);
+    EXPECT_EQ(1u, mAtrCache.misses);
+}
+
+TEST_F(TestResetAtrCache, RedundantPpsIsSkipped) {
+    // T=0 only card, which does not accept F & D of TA1
+    vector<uint8_t> ppsResponse{ 0xff, 0x00, 0xff };
+    vector<uint8_t> output{ kAtr2151 };
+    output.insert(output.end(), ppsResponse.begin(), ppsResponse.end());
+
+    auto card = make_shared<rtft::SimpleCard>(output);
+    rtft::setCard(card);
+    ASSERT_EQ(transport_status_ok, reset());
+    EXPECT_FALSE(card->getInput().empty());
+    EXPECT_EQ(transmit_params_default()->etu, mTransport.params.etu);
+    auto params = mTransport.params;
+
+    card = make_shared<rtft::SimpleCard>(vector<uint8_t>{ kAtr2151 });
+    rtft::setCard(card);
+    ASSERT_EQ(transport_status_ok, reset());
+    EXPECT_TRUE(card->getInput().empty());
+    EXPECT_EQ(0, memcmp(&params, &mTransport.params, sizeof(params)));
+    EXPECT_EQ(1u, mAtrCache.hits);
+}
+
+TEST_F(TestResetAtrCache, OldestEntryIsReplaced) {
+    atr_cache_entry_t entry = {};
+    entry.atr_len = 2;
+
+    for (uint8_t i = 0; i < ATR_CACHE_SIZE + 1; ++i) {
+        entry.atr[1] = i;
+        atr_cache_store(&mAtrCache, &entry);
+    }
+
+    uint8_t first[] = { 0x00, 0x00 };
+    uint8_t last[] = { 0x00, ATR_CACHE_SIZE };
+    EXPECT_EQ(nullptr, atr_cache_find(&mAtrCache, first, sizeof(first)));
+    EXPECT_NE(nullptr, atr_cache_find(&mAtrCache, last, sizeof(last)));
+}
+
+class TestResetConvention : public TestResetAtrCache {};
+
+TEST_F(TestResetConvention, Direct) {
+    rtft::setCard(make_shared<ResetCard>(kAtr2100T1));
+    ASSERT_EQ(transport_status_ok, reset());
+
+    EXPECT_EQ(transport_convention_direct, mTransport.params.convention);
+    EXPECT_FALSE(mTransport.atr_info->inverse_convention);
+}
+
+// The fake transport passes the characters as is, so only ATR comes encoded
+// and PPS is exchanged in decoded characters
+TEST_F(TestResetConvention, Inverse) {
+    vector<uint8_t> kAtr{ kAtr2100T1 };
+    kAtr[0] = ATR_TS_INVERSE;
+    vector<uint8_t> line = kAtr;
+    transport_convert_inverse(line.data(), line.size());
+
+    auto card = make_shared<ResetCard>(line);
+    rtft::setCard(card);
+
+    EXPECT_CALL(*mInitialize, do_transport_reinitialize(_, _)).Times(AnyNumber());
+    // Before PPS and the final one
+    EXPECT_CALL(*mInitialize,
+                do_transport_reinitialize(_, Pointee(Field(&transmit_params_t::convention, transport_convention_inverse))))
+        .Times(2);
+
+    vector<uint8_t> resultAtr(255);
+    size_t atrLength = resultAtr.size();
+    ASSERT_EQ(transport_status_ok, transport_reset(&mTransport, resultAtr.data(), &atrLength));
+    resultAtr.resize(atrLength);
+
+    EXPECT_EQ(kAtr, resultAtr);
+    EXPECT_EQ(card->ppsRequest(), card->ppsResponse());
+    EXPECT_EQ(transport_convention_inverse, mTransport.params.convention);
+    EXPECT_TRUE(mTransport.atr_info->inverse_convention);
+}
+
+class TestResetClock : public Test {
+public:
+    void SetUp() override {
+        mTransport = {};
+        mTransport.params = *transmit_params_default();
+        mTransport.atr_cache = &mAtrCache;
+        mTransport.atr_info = &mAtrInfo;
+
+        auto transportInitialize = make_unique<NiceMock<MockInitialize>>();
+        ON_CALL(*transportInitialize, do_transport_reinitialize(_, _)).WillByDefault(Return(transport_status_ok));
+        rtft::setInitialize(move(transportInitialize));
+        rtft::setCard(make_shared<ResetCard>(kAtr2100T1));
+        rt::fakehardware::resetClockStopCount();
+    }
+    void TearDown() override {
+        rtft::resetCard();
+        rtft::resetInitialize();
+    }
+
+protected:
+    transport_t mTransport;
+    atr_cache_t mAtrCache = {};
+    atr_info_t mAtrInfo;
+    vector<uint8_t> mAtr = vector<uint8_t>(255);
+    size_t mAtrLength = mAtr.size();
+};
+
+TEST_F(TestResetClock, ColdResetStopsClock) {
+    ASSERT_EQ(transport_status_ok, transport_reset(&mTransport, mAtr.data(), &mAtrLength));
+    EXPECT_EQ(1u, rt::fakehardware::clockStopCount());
+    EXPECT_EQ(PROTOCOL_T1, mTransport.protocol);
+}
+
+TEST_F(TestResetClock, WarmResetKeepsClockRunning) {
+    ASSERT_EQ(transport_status_ok, transport_warm_reset(&mTransport, mAtr.data(), &mAtrLength));
+    EXPECT_EQ(0u, rt::fakehardware::clockStopCount());
+    EXPECT_EQ(PROTOCOL_T1, mTransport.protocol);
+}
+
+// The card answers the warm reset at F = 372 and D = 1 of the running clock
+TEST_F(TestResetClock, WarmResetKeepsClockFrequency) {
+    vector<transmit_params_t> params;
+    auto transportInitialize = make_unique<NiceMock<MockInitialize>>();
+    ON_CALL(*transportInitialize, do_transport_reinitialize(_, _))
+        .WillByDefault(DoAll(Invoke([&params](transport_t*, const transmit_params_t* p) { params.push_back(*p); }),
+                             Return(transport_status_ok)));
+    rtft::setInitialize(move(transportInitialize));
+    mTransport.clock_freq = 5000000;
+
+    ASSERT_EQ(transport_status_ok, transport_warm_reset(&mTransport, mAtr.data(), &mAtrLength));
+    ASSERT_FALSE(params.empty());
+    EXPECT_EQ(5000000u, params.front().transmit_speed.freq);
+    EXPECT_EQ(5000000u / 372, params.front().transmit_speed.baudrate);
+    EXPECT_EQ(params.front().wt_us, params.front().cwt_us);
+    EXPECT_LT(params.front().wt_us, transmit_params_default()->wt_us);
+    EXPECT_EQ(0u, rt::fakehardware::clockStopCount());
+}
+
+TEST_F(TestResetClock, ColdResetRestoresDefaultFrequency) {
+    vector<transmit_params_t> params;
+    auto transportInitialize = make_unique<NiceMock<MockInitialize>>();
+    ON_CALL(*transportInitialize, do_transport_reinitialize(_, _))
+        .WillByDefault(DoAll(Invoke([&params](transport_t*, const transmit_params_t* p) { params.push_back(*p); }),
+                             Return(transport_status_ok)));
+    rtft::setInitialize(move(transportInitialize));
+    mTransport.clock_freq = 5000000;
+
+    ASSERT_EQ(transport_status_ok, transport_reset(&mTransport, mAtr.data(), &mAtrLength));
+    ASSERT_FALSE(params.empty());
+    EXPECT_EQ(transmit_params_default()->transmit_speed.freq, params.front().transmit_speed.freq);
+    EXPECT_EQ(transmit_params_default()->transmit_speed.baudrate, params.front().transmit_speed.baudrate);
+}
+
+// BWT bounds the delay before a T=1 block, CWT the gaps within it
+TEST_F(TestResetClock, T1CharacterWaitingTime) {
+    ASSERT_EQ(transport_status_ok, transport_reset(&mTransport, mAtr.data(), &mAtrLength));
+    ASSERT_EQ(PROTOCOL_T1, mTransport.protocol);
+
+    double cwtUs = (11. + (1u << mAtrInfo.t1.cwi)) * 1e6 / mTransport.params.transmit_speed.baudrate;
+    EXPECT_NEAR(cwtUs, mTransport.params.cwt_us, cwtUs / 100 + 1);
+    EXPECT_LT(mTransport.params.cwt_us, mTransport.params.wt_us);
+    EXPECT_EQ(static_cast<uint8_t>(ceil(mTransport.params.cwt_us / 1e5)), mTransport.params.wt_ds);
+}
+
+TEST_F(TestResetClock, T0CharacterWaitingTimeIsWt) {
+    rtft::setCard(make_shared<ResetCard>(kAtr2100T0));
+
+    ASSERT_EQ(transport_status_ok, transport_reset(&mTransport, mAtr.data(), &mAtrLength));
+    ASSERT_EQ(PROTOCOL_T0, mTransport.protocol);
+    EXPECT_EQ(mTransport.params.wt_us, mTransport.params.cwt_us);
+}
+
+TEST_F(TestResetClock, BaudrateIsNotLimitedToTermiosConstants) {
+    // TA1 = 0x96: Fi = 512, f max = 5 MHz, Di = 32, so Fi = 372 and Di = 32 are the fastest
+    auto card = make_shared<ResetCard>(vector<uint8_t>{ 0x3b, 0x10, 0x96 });
+    rtft::setCard(card);
+
+    ASSERT_EQ(transport_status_ok, transport_reset(&mTransport, mAtr.data(), &mAtrLength));
+    EXPECT_EQ(card->ppsRequest(), card->ppsResponse());
+    EXPECT_EQ(430107u, mTransport.params.transmit_speed.baudrate);
+    EXPECT_EQ(5000000u, mTransport.params.transmit_speed.freq);
+}
+
+// As the wave engine, which samples the I/O line by software
+class SlowLineInitialize : public NiceMock<MockInitialize> {
+public:
+    uint32_t transport_max_baudrate(const transport_t* transport) override {
+        return 250000;
+    }
+};
+
+TEST_F(TestResetClock, BaudrateIsLimitedByTransportEngine) {
+    auto transportInitialize = make_unique<SlowLineInitialize>();
+    ON_CALL(*transportInitialize, do_transport_reinitialize(_, _)).WillByDefault(Return(transport_status_ok));
+    rtft::setInitialize(move(transportInitialize));
+
+    auto card = make_shared<ResetCard>(vector<uint8_t>{ 0x3b, 0x10, 0x96 });
+    rtft::setCard(card);
+
+    ASSERT_EQ(transport_status_ok, transport_reset(&mTransport, mAtr.data(), &mAtrLength));
+    EXPECT_EQ(card->ppsRequest(), card->ppsResponse());
+    EXPECT_EQ(250000u, mTransport.params.transmit_speed.baudrate);
+}
+
+// f max itself is allowed
+TEST_F(TestResetClock, ClockReachesMaximumFrequency) {
+    rt::fakehardware::setClockBase(500000000);
+    auto card = make_shared<ResetCard>(vector<uint8_t>{ 0x3b, 0x10, 0x96 });
+    rtft::setCard(card);
+
+    auto r = transport_reset(&mTransport, mAtr.data(), &mAtrLength);
+    rt::fakehardware::setClockBase(0);
+
+    ASSERT_EQ(transport_status_ok, r);
+    EXPECT_EQ(500000000u / 100, mTransport.params.transmit_speed.freq);
+    EXPECT_EQ(430107u, mTransport.params.transmit_speed.baudrate);
+}
+
+TEST_F(TestResetClock, BaudrateFollowsAchievedFrequency) {
+    rt::fakehardware::setClockBase(512000000);
+    auto card = make_shared<ResetCard>(vector<uint8_t>{ 0x3b, 0x10, 0x96 });
+    rtft::setCard(card);
+
+    auto r = transport_reset(&mTransport, mAtr.data(), &mAtrLength);
+    rt::fakehardware::setClockBase(0);
+
+    ASSERT_EQ(transport_status_ok, r);
+    EXPECT_EQ(512000000u / 103, mTransport.params.transmit_speed.freq);
+    EXPECT_EQ(427601u, mTransport.params.transmit_speed.baudrate);
+}
@@ -0,0 +1,345 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#include <rtuartscreader/transport/sendrecv.h>
+
+#include <pthread.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <rtuartscreader/transport/convention.h>
+#include <rtuartscreader/transport/detail/transmit_params.h>
+#include <rtuartscreader/transport/sendrecv_poll.h>
+#include <rtuartscreader/transport/sendrecv_wave.h>
+
+#include <fakehardware/fakehardware.h>
+#include <faketransport/faketransport.h>
+
+using namespace std;
+
+namespace rtfh = rt::fakehardware;
+namespace rtft = rt::faketransport;
+
+namespace {
+
+// The fake I/O line of the wave engine does not report the end of file
+const uint32_t kWaveWtUs = 20000;
+
+} // namespace
+
+// Real transport functions are tested against a socket pair. The test plays
+// the role of UART line: it prepares the echo and checks what has been sent.
+// Parameter is the sendrecv implementation, nullptr means the default one.
+// The wave engine reaches the socket through the fake hardware.
+class TestSendRecv : public testing::TestWithParam<const transport_sendrecv_impl_t*> {
+public:
+    virtual void SetUp() override {
+        if (GetParam()) {
+            transport_sendrecv_impl_set(GetParam());
+        } else {
+            transport_sendrecv_impl_reset();
+        }
+
+        int sv[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv)) throw runtime_error("socketpair failed");
+
+        mTransport = {};
+        mTransport.handle = sv[0];
+        mTransport.params = *transmit_params_default();
+        mLine = sv[1];
+
+        rtfh::setSerialLine(sv[0]);
+        if (GetParam() == transport_sendrecv_wave_impl()) {
+            mTransport.params.wt_us = kWaveWtUs;
+        }
+    }
+
+    virtual void TearDown() override {
+        rtfh::setSerialLine(-1);
+        close(mTransport.handle);
+        close(mLine);
+
+        rtft::initializeSendRecv();
+    }
+
+    void lineOutput(const vector<uint8_t>& data) {
+        if (write(mLine, data.data(), data.size()) != static_cast<ssize_t>(data.size()))
+            throw runtime_error("write failed");
+    }
+
+    void lineClose() {
+        shutdown(mLine, SHUT_WR);
+    }
+
+    vector<uint8_t> lineInput(size_t size) {
+        vector<uint8_t> data(size);
+        size_t offset = 0;
+        while (offset != size) {
+            auto r = read(mLine, data.data() + offset, size - offset);
+            if (r <= 0) throw runtime_error("read failed");
+            offset += r;
+        }
+        return data;
+    }
+
+protected:
+    transport_t mTransport;
+    int mLine;
+};
+
+namespace {
+
+vector<uint8_t> makeData(size_t size) {
+    vector<uint8_t> data(size);
+    iota(data.begin(), data.end(), 0);
+    return data;
+}
+
+} // namespace
+
+TEST_P(TestSendRecv, SendBytesBulk) {
+    auto data = makeData(300);
+    lineOutput(data);
+
+    EXPECT_EQ(transport_status_ok, transport_send_bytes(&mTransport, data.data(), data.size()));
+    EXPECT_EQ(data, lineInput(data.size()));
+}
+
+TEST_P(TestSendRecv, SendBytesPerByteWithExtraGuardTime) {
+    mTransport.params.extra_gt_us = 1;
+
+    auto data = makeData(10);
+    lineOutput(data);
+
+    EXPECT_EQ(transport_status_ok, transport_send_bytes(&mTransport, data.data(), data.size()));
+    EXPECT_EQ(data, lineInput(data.size()));
+}
+
+TEST_P(TestSendRecv, SendBytesEchoMismatch) {
+    auto data = makeData(10);
+    auto echo = data;
+    echo[5] ^= 0xff;
+    lineOutput(echo);
+
+    EXPECT_EQ(transport_status_communication_error, transport_send_bytes(&mTransport, data.data(), data.size()));
+}
+
+TEST_P(TestSendRecv, SendBytesNoEcho) {
+    auto data = makeData(10);
+    lineOutput({ data.begin(), data.begin() + 5 });
+    lineClose();
+
+    EXPECT_EQ(transport_status_timeout, transport_send_bytes(&mTransport, data.data(), data.size()));
+}
+
+TEST_P(TestSendRecv, SendBytesInverseConvention) {
+    mTransport.params.convention = transport_convention_inverse;
+
+    auto data = makeData(100);
+    auto line = data;
+    transport_convert_inverse(line.data(), line.size());
+    lineOutput(line);
+
+    EXPECT_EQ(transport_status_ok, transport_send_bytes(&mTransport, data.data(), data.size()));
+    EXPECT_EQ(line, lineInput(line.size()));
+}
+
+TEST_P(TestSendRecv, RecvBytes) {
+    auto data = makeData(258);
+    lineOutput(data);
+
+    vector<uint8_t> result(data.size());
+    EXPECT_EQ(transport_status_ok, transport_recv_bytes(&mTransport, result.data(), result.size()));
+    EXPECT_EQ(data, result);
+}
+
+TEST_P(TestSendRecv, RecvBytesInParts) {
+    auto data = makeData(16);
+    vector<uint8_t> result(data.size());
+
+    lineOutput({ data.begin(), data.begin() + 4 });
+    EXPECT_EQ(transport_status_ok, transport_recv_byte(&mTransport, result.data()));
+
+    lineOutput({ data.begin() + 4, data.end() });
+    EXPECT_EQ(transport_status_ok, transport_recv_bytes(&mTransport, result.data() + 1, result.size() - 1));
+    EXPECT_EQ(data, result);
+}
+
+TEST_P(TestSendRecv, RecvBytesInverseConvention) {
+    mTransport.params.convention = transport_convention_inverse;
+
+    auto data = makeData(100);
+    auto line = data;
+    transport_convert_inverse(line.data(), line.size());
+    lineOutput(line);
+
+    vector<uint8_t> result(data.size());
+    EXPECT_EQ(transport_status_ok, transport_recv_bytes(&mTransport, result.data(), result.size()));
+    EXPECT_EQ(data, result);
+}
+
+TEST_P(TestSendRecv, RecvBytesTimeout) {
+    auto data = makeData(16);
+    lineOutput({ data.begin(), data.begin() + 8 });
+    lineClose();
+
+    uint32_t timeouts = 0;
+    mTransport.timeouts = &timeouts;
+
+    vector<uint8_t> result(data.size());
+    EXPECT_EQ(transport_status_timeout, transport_recv_bytes(&mTransport, result.data(), result.size()));
+    EXPECT_EQ(1u, timeouts);
+}
+
+INSTANTIATE_TEST_SUITE_P(Tty, TestSendRecv, testing::Values(nullptr));
+INSTANTIATE_TEST_SUITE_P(Poll, TestSendRecv, testing::Values(transport_sendrecv_poll_impl()));
+INSTANTIATE_TEST_SUITE_P(Wave, TestSendRecv, testing::Values(transport_sendrecv_wave_impl()));
+
+class TestSendRecvPoll : public TestSendRecv {};
+
+TEST_P(TestSendRecvPoll, RecvBytesWorkWaitingTime) {
+    mTransport.params.wt_us = 20000;
+
+    auto data = makeData(16);
+    lineOutput({ data.begin(), data.begin() + 8 });
+
+    uint32_t timeouts = 0;
+    mTransport.timeouts = &timeouts;
+
+    vector<uint8_t> result(data.size());
+    EXPECT_EQ(transport_status_timeout, transport_recv_bytes(&mTransport, result.data(), result.size()));
+    EXPECT_EQ(1u, timeouts);
+}
+
+TEST_P(TestSendRecvPoll, SignalsDoNotRestartWaitingTime) {
+    mTransport.params.wt_us = 200000;
+
+    struct sigaction action = {};
+    struct sigaction oldAction;
+    action.sa_handler = [](int) {};
+    ASSERT_EQ(0, sigaction(SIGUSR1, &action, &oldAction));
+
+    // Interrupts the wait more often than WT, for a limited time so a restarting wait ends too
+    atomic<bool> done(false);
+    pthread_t waiter = pthread_self();
+    thread interrupter([&] {
+        for (int i = 0; i < 50 && !done; ++i) {
+            this_thread::sleep_for(chrono::milliseconds(20));
+            pthread_kill(waiter, SIGUSR1);
+        }
+    });
+
+    auto start = chrono::steady_clock::now();
+    uint8_t byte;
+    transport_status_t r = transport_recv_bytes(&mTransport, &byte, 1);
+    auto elapsed = chrono::steady_clock::now() - start;
+
+    done = true;
+    interrupter.join();
+    sigaction(SIGUSR1, &oldAction, nullptr);
+
+    EXPECT_EQ(transport_status_timeout, r);
+    EXPECT_GE(elapsed, chrono::microseconds(mTransport.params.wt_us));
+    EXPECT_LT(elapsed, chrono::microseconds(2 * mTransport.params.wt_us));
+}
+
+INSTANTIATE_TEST_SUITE_P(Poll, TestSendRecvPoll, testing::Values(transport_sendrecv_poll_impl()));
+
+// The engines waiting on the clock rather than on VTIME, which a socket ignores
+class TestSendRecvWaitingTime : public TestSendRecv {};
+
+// The characters of a T=1 block are awaited for CWT, not WT
+TEST_P(TestSendRecvWaitingTime, RecvBlockBytesCharacterWaitingTime) {
+    mTransport.params.wt_us = 10000000;
+    mTransport.params.cwt_us = 20000;
+
+    auto data = makeData(16);
+    lineOutput({ data.begin(), data.begin() + 8 });
+
+    vector<uint8_t> result(data.size());
+    auto begin = chrono::steady_clock::now();
+    EXPECT_EQ(transport_status_timeout, transport_recv_block_bytes(&mTransport, result.data(), result.size()));
+    auto elapsed = chrono::steady_clock::now() - begin;
+
+    EXPECT_LE(chrono::microseconds(mTransport.params.cwt_us), elapsed);
+    EXPECT_GT(chrono::microseconds(mTransport.params.wt_us), elapsed);
+}
+
+INSTANTIATE_TEST_SUITE_P(Poll, TestSendRecvWaitingTime, testing::Values(transport_sendrecv_poll_impl()));
+INSTANTIATE_TEST_SUITE_P(Wave, TestSendRecvWaitingTime, testing::Values(transport_sendrecv_wave_impl()));
+
+// The engines writing to the serial port wait extra guard time themselves
+class TestSendRecvGuardTime : public TestSendRecv {};
+
+TEST_P(TestSendRecvGuardTime, SendBytesExtraGuardTime) {
+    mTransport.params.extra_gt_us = 2000;
+
+    auto data = makeData(10);
+    lineOutput(data);
+
+    auto begin = chrono::steady_clock::now();
+    EXPECT_EQ(transport_status_ok, transport_send_bytes(&mTransport, data.data(), data.size()));
+    auto elapsed = chrono::steady_clock::now() - begin;
+
+    EXPECT_EQ(data, lineInput(data.size()));
+    EXPECT_LE(chrono::microseconds((data.size() - 1) * mTransport.params.extra_gt_us), elapsed);
+}
+
+// The echo comes in the middle of the first stop bit, the character is over 1.5 ETU later
+TEST_P(TestSendRecvGuardTime, SendBytesGuardTimeAfterCharacterEnd) {
+    mTransport.params.extra_gt_us = 1;
+
+    auto data = makeData(10);
+    lineOutput(data);
+
+    auto begin = chrono::steady_clock::now();
+    EXPECT_EQ(transport_status_ok, transport_send_bytes(&mTransport, data.data(), data.size()));
+    auto elapsed = chrono::steady_clock::now() - begin;
+
+    auto characterEnd = chrono::microseconds(1500000 / mTransport.params.transmit_speed.baudrate);
+    EXPECT_EQ(data, lineInput(data.size()));
+    EXPECT_LE((data.size() - 1) * characterEnd, elapsed);
+}
+
+INSTANTIATE_TEST_SUITE_P(Tty, TestSendRecvGuardTime, testing::Values(nullptr));
+INSTANTIATE_TEST_SUITE_P(Poll, TestSendRecvGuardTime, testing::Values(transport_sendrecv_poll_impl()));
+
+class TestSendRecvWave : public TestSendRecv {};
+
+TEST_P(TestSendRecvWave, SendBytesExtraGuardTimeInWaveform) {
+    mTransport.params.extra_gt_us = 2000;
+
+    auto data = makeData(10);
+    lineOutput(data);
+
+    EXPECT_EQ(transport_status_ok, transport_send_bytes(&mTransport, data.data(), data.size()));
+    EXPECT_EQ(data, lineInput(data.size()));
+    EXPECT_EQ(1u, rtfh::serialWriteCount());
+    EXPECT_EQ(mTransport.params.extra_gt_us, rtfh::serialExtraGuardTime());
+}
+
+TEST_P(TestSendRecvWave, RecvBytesWorkWaitingTime) {
+    auto data = makeData(16);
+    lineOutput({ data.begin(), data.begin() + 8 });
+
+    vector<uint8_t> result(data.size());
+    auto begin = chrono::steady_clock::now();
+    EXPECT_EQ(transport_status_timeout, transport_recv_bytes(&mTransport, result.data(), result.size()));
+    auto elapsed = chrono::steady_clock::now() - begin;
+
+    EXPECT_LE(chrono::microseconds(mTransport.params.wt_us), elapsed);
+}
+
+INSTANTIATE_TEST_SUITE_P(Wave, TestSendRecvWave, testing::Values(transport_sendrecv_wave_impl()));
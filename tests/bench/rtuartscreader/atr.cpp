@@ -0,0 +1,52 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#include <rtuartscreader/iso7816_3/atr.h>
+
+#include <memory>
+#include <vector>
+
+#include <faketransport/card.h>
+
+#include "cards.h"
+#include "constants.h"
+#include "harness.h"
+
+using namespace std;
+
+namespace rtft = rt::faketransport;
+
+RT_BENCHMARK(ReadAtr) {
+    rtft::setCard(make_shared<rt::bench::ScriptCard>(vector<uint8_t>{ kAtr2100T1 }));
+
+    transport_t transport = {};
+    atr_t atr;
+    state.run([&] {
+        if (read_atr(&transport, &atr) != iso7816_3_status_ok) {
+            state.fail("read_atr failed");
+        }
+    });
+
+    rtft::resetCard();
+}
+
+RT_BENCHMARK(ParseAtr) {
+    rtft::setCard(make_shared<rt::bench::ScriptCard>(vector<uint8_t>{ kAtr2100T1 }));
+
+    transport_t transport = {};
+    atr_t atr;
+    if (read_atr(&transport, &atr) != iso7816_3_status_ok) {
+        state.fail("read_atr failed");
+    }
+
+    rtft::resetCard();
+
+    atr_info_t info;
+    state.run([&] {
+        if (parse_atr(&atr, &info) != iso7816_3_status_ok) {
+            state.fail("parse_atr failed");
+        }
+    });
+}
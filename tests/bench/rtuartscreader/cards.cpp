@@ -0,0 +1,71 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#include "cards.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "harness.h"
+
+using namespace std;
+
+namespace rt {
+namespace bench {
+
+void ScriptCard::input(const uint8_t*, size_t) {
+    countTransportCall();
+}
+
+void ScriptCard::output(uint8_t* buffer, size_t length) {
+    countTransportCall();
+
+    while (length) {
+        size_t chunk = min(length, mOutput.size() - mOffset);
+        copy(mOutput.begin() + mOffset, mOutput.begin() + mOffset + chunk, buffer);
+
+        buffer += chunk;
+        length -= chunk;
+        mOffset = (mOffset + chunk) % mOutput.size();
+    }
+}
+
+EchoCard::EchoCard(vector<uint8_t> atr)
+    : mAtr(move(atr))
+    , mAtrOffset(mAtr.size()) {
+    // The echo buffer is allocated once, so that it does not count as the allocation of the operation
+    mEcho.reserve(256);
+}
+
+void EchoCard::restart() {
+    mAtrOffset = 0;
+    mEcho.clear();
+    mEchoOffset = 0;
+}
+
+void EchoCard::input(const uint8_t* buffer, size_t length) {
+    countTransportCall();
+
+    mEcho.insert(mEcho.end(), buffer, buffer + length);
+}
+
+void EchoCard::output(uint8_t* buffer, size_t length) {
+    countTransportCall();
+
+    size_t fromAtr = min(length, mAtr.size() - mAtrOffset);
+    copy(mAtr.begin() + mAtrOffset, mAtr.begin() + mAtrOffset + fromAtr, buffer);
+    mAtrOffset += fromAtr;
+
+    size_t fromEcho = length - fromAtr;
+    if (mEchoOffset + fromEcho > mEcho.size()) {
+        throw runtime_error("Not enough data to output");
+    }
+
+    copy(mEcho.begin() + mEchoOffset, mEcho.begin() + mEchoOffset + fromEcho, buffer + fromAtr);
+    mEchoOffset += fromEcho;
+}
+
+} // namespace bench
+} // namespace rt
@@ -0,0 +1,48 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <faketransport/card.h>
+
+namespace rt {
+namespace bench {
+
+// Replays its output in a loop and drops the input, so it serves any number of operations
+class ScriptCard : public rt::faketransport::Card {
+public:
+    ScriptCard(std::vector<uint8_t> output)
+        : mOutput(move(output)) {}
+
+    void input(const uint8_t* buffer, size_t length) override;
+    void output(uint8_t* buffer, size_t length) override;
+
+private:
+    std::vector<uint8_t> mOutput;
+    size_t mOffset = 0;
+};
+
+// Sends its ATR after restart() and echoes the input afterwards, as a card does with PPS
+class EchoCard : public rt::faketransport::Card {
+public:
+    EchoCard(std::vector<uint8_t> atr);
+
+    void restart();
+
+    void input(const uint8_t* buffer, size_t length) override;
+    void output(uint8_t* buffer, size_t length) override;
+
+private:
+    std::vector<uint8_t> mAtr;
+    size_t mAtrOffset;
+    std::vector<uint8_t> mEcho;
+    size_t mEchoOffset = 0;
+};
+
+} // namespace bench
+} // namespace rt
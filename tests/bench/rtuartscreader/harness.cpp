@@ -0,0 +1,127 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#include "harness.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// The allocations are counted with the linker wrappers of the allocation functions,
+// so those of the C code of the driver are counted as well as those of operator new
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* pointer, size_t size);
+}
+
+namespace {
+
+const auto kMinDuration = chrono::milliseconds(200);
+const uint64_t kMinIterations = 10;
+
+// The card emulator allocates from its own thread
+atomic<uint64_t> gAllocations{ 0 };
+uint64_t gTransportCalls = 0;
+
+vector<pair<string, rt::bench::Benchmark>>& benchmarks() {
+    static vector<pair<string, rt::bench::Benchmark>> result;
+    return result;
+}
+
+} // namespace
+
+extern "C" {
+void* __wrap_malloc(size_t size) {
+    ++gAllocations;
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+    ++gAllocations;
+    return __real_calloc(count, size);
+}
+
+void* __wrap_realloc(void* pointer, size_t size) {
+    ++gAllocations;
+    return __real_realloc(pointer, size);
+}
+}
+
+namespace rt {
+namespace bench {
+
+void State::run(const function<void()>& operation) {
+    // Warm up the caches and the lazily initialized state
+    operation();
+
+    uint64_t iterations = 0;
+    uint64_t allocations = gAllocations;
+    uint64_t transportCalls = gTransportCalls;
+    auto start = chrono::steady_clock::now();
+    auto elapsed = chrono::steady_clock::duration::zero();
+
+    while (iterations < kMinIterations || elapsed < kMinDuration) {
+        operation();
+        ++iterations;
+        elapsed = chrono::steady_clock::now() - start;
+    }
+
+    mNsPerOperation = static_cast<double>(chrono::duration_cast<chrono::nanoseconds>(elapsed).count()) / iterations;
+    mAllocationsPerOperation = static_cast<double>(gAllocations - allocations) / iterations;
+    mTransportCallsPerOperation = static_cast<double>(gTransportCalls - transportCalls) / iterations;
+}
+
+void State::fail(const string& message) {
+    if (mError.empty()) {
+        mError = message;
+    }
+}
+
+Registrar::Registrar(const char* name, Benchmark benchmark) {
+    benchmarks().emplace_back(name, move(benchmark));
+}
+
+void countTransportCall() {
+    ++gTransportCalls;
+}
+
+int runBenchmarks(const string& filter) {
+    int r = EXIT_SUCCESS;
+
+    printf("%-36s %14s %12s %12s\n", "Benchmark", "ns/op", "allocs/op", "io/op");
+
+    for (const auto& benchmark : benchmarks()) {
+        if (benchmark.first.find(filter) == string::npos) continue;
+
+        State state;
+        benchmark.second(state);
+
+        if (!state.error().empty()) {
+            printf("%-36s FAILED: %s\n", benchmark.first.c_str(), state.error().c_str());
+            r = EXIT_FAILURE;
+            continue;
+        }
+
+        // The real transport is not counted, its benchmarks have no io/op
+        if (state.transportCallsPerOperation()) {
+            printf("%-36s %14.1f %12.2f %12.2f\n", benchmark.first.c_str(), state.nsPerOperation(),
+                   state.allocationsPerOperation(), state.transportCallsPerOperation());
+        } else {
+            printf("%-36s %14.1f %12.2f %12s\n", benchmark.first.c_str(), state.nsPerOperation(),
+                   state.allocationsPerOperation(), "-");
+        }
+    }
+
+    return r;
+}
+
+} // namespace bench
+} // namespace rt
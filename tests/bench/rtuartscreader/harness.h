@@ -0,0 +1,52 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace rt {
+namespace bench {
+
+class State {
+public:
+    // Calls the operation repeatedly and measures it, the setup before run() is not measured
+    void run(const std::function<void()>& operation);
+
+    void fail(const std::string& message);
+
+    double nsPerOperation() const { return mNsPerOperation; }
+    double allocationsPerOperation() const { return mAllocationsPerOperation; }
+    double transportCallsPerOperation() const { return mTransportCallsPerOperation; }
+    const std::string& error() const { return mError; }
+
+private:
+    double mNsPerOperation = 0;
+    double mAllocationsPerOperation = 0;
+    double mTransportCallsPerOperation = 0;
+    std::string mError;
+};
+
+using Benchmark = std::function<void(State&)>;
+
+struct Registrar {
+    Registrar(const char* name, Benchmark benchmark);
+};
+
+// Counted by the fake cards: each call stands for a read or a write of the real transport
+void countTransportCall();
+
+int runBenchmarks(const std::string& filter);
+
+} // namespace bench
+} // namespace rt
+
+#define RT_BENCHMARK(name)                                                  \
+    static void name(rt::bench::State& state);                              \
+    static const rt::bench::Registrar name##Registrar{ #name, name };       \
+    static void name(rt::bench::State& state)
@@ -0,0 +1,26 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#include <string>
+
+#include <fakehardware/fakehardware.h>
+#include <faketransport/faketransport.h>
+
+#include "harness.h"
+
+using namespace std;
+
+// The only argument is a substring of the names of the benchmarks to run
+int main(int argc, char** argv) {
+    rt::fakehardware::initialize();
+    rt::faketransport::initializeTransport();
+
+    auto r = rt::bench::runBenchmarks(argc > 1 ? argv[1] : "");
+
+    rt::faketransport::deinitializeTransport();
+    rt::fakehardware::deinitialize();
+
+    return r;
+}
@@ -0,0 +1,35 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#include <rtuartscreader/iso7816_3/pps.h>
+
+#include <memory>
+
+#include <rtuartscreader/iso7816_3/atr_info.h>
+
+#include <faketransport/card.h>
+
+#include "cards.h"
+#include "harness.h"
+
+using namespace std;
+
+namespace rtft = rt::faketransport;
+
+RT_BENCHMARK(PpsExchange) {
+    auto card = make_shared<rt::bench::EchoCard>(vector<uint8_t>{});
+    rtft::setCard(card);
+
+    transport_t transport = {};
+    f_d_index_t f_d_index = { .f_index = 1, .d_index = 3 };
+    state.run([&] {
+        card->restart();
+        if (do_pps_exchange(&transport, &f_d_index, PROTOCOL_T1) != iso7816_3_status_ok) {
+            state.fail("do_pps_exchange failed");
+        }
+    });
+
+    rtft::resetCard();
+}
@@ -0,0 +1,80 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#include <rtuartscreader/transport/reset.h>
+
+#include <memory>
+#include <vector>
+
+#include <rtuartscreader/iso7816_3/atr_info.h>
+#include <rtuartscreader/transport/atr_cache.h>
+#include <rtuartscreader/transport/detail/transmit_params.h>
+
+#include <faketransport/card.h>
+#include <faketransport/initialize.h>
+
+#include "cards.h"
+#include "constants.h"
+#include "harness.h"
+
+using namespace std;
+
+namespace rtft = rt::faketransport;
+
+namespace {
+
+class Initialize : public rtft::Initialize {
+public:
+    transport_status_t transport_initialize(transport_t*, const char*) override {
+        return transport_status_ok;
+    }
+
+    transport_status_t transport_reinitialize(transport_t* transport, const transmit_params_t* params) override {
+        transport->params = *params;
+        return transport_status_ok;
+    }
+
+    transport_status_t transport_deinitialize(const transport_t*) override {
+        return transport_status_ok;
+    }
+};
+
+// The ATR cache is warm after the first reset, so it is the steady state of resets of the same card
+void reset(rt::bench::State& state, bool warm) {
+    rtft::setInitialize(make_unique<Initialize>());
+    auto card = make_shared<rt::bench::EchoCard>(vector<uint8_t>{ kAtr2100T1 });
+    rtft::setCard(card);
+
+    atr_cache_t atrCache = {};
+    atr_info_t atrInfo;
+    transport_t transport = {};
+    transport.params = *transmit_params_default();
+    transport.atr_cache = &atrCache;
+    transport.atr_info = &atrInfo;
+    vector<uint8_t> atr(ATR_MAX_SIZE);
+    state.run([&] {
+        card->restart();
+
+        size_t atrLength = atr.size();
+        auto r = warm ? transport_warm_reset(&transport, atr.data(), &atrLength)
+                      : transport_reset(&transport, atr.data(), &atrLength);
+        if (r != transport_status_ok) {
+            state.fail("reset failed");
+        }
+    });
+
+    rtft::resetCard();
+    rtft::resetInitialize();
+}
+
+} // namespace
+
+RT_BENCHMARK(TransportReset) {
+    reset(state, false);
+}
+
+RT_BENCHMARK(TransportWarmReset) {
+    reset(state, true);
+}
@@ -0,0 +1,81 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#include <rtuartscreader/iso7816_3/apdu_t0.h>
+
+#include <memory>
+#include <vector>
+
+#include <faketransport/card.h>
+
+#include "cards.h"
+#include "harness.h"
+
+using namespace std;
+
+namespace rtft = rt::faketransport;
+
+namespace {
+
+const uint8_t kIns = 0xb0;
+
+void transmit(rt::bench::State& state, const vector<uint8_t>& apdu, const vector<uint8_t>& cardOutput) {
+    rtft::setCard(make_shared<rt::bench::ScriptCard>(cardOutput));
+
+    vector<uint8_t> response(258);
+    state.run([&] {
+        size_t responseLength = response.size();
+        if (t0_transmit_apdu(nullptr, apdu.data(), apdu.size(), response.data(), &responseLength) != iso7816_3_status_ok) {
+            state.fail("t0_transmit_apdu failed");
+        }
+    });
+
+    rtft::resetCard();
+}
+
+// Case 3: the data is sent after the procedure byte
+void transmitCase3(rt::bench::State& state, uint8_t lc) {
+    vector<uint8_t> apdu{ 0x00, kIns, 0x00, 0x00, lc };
+    apdu.resize(apdu.size() + lc, 0x5a);
+
+    transmit(state, apdu, { kIns, 0x90, 0x00 });
+}
+
+// Case 2: the data is received after the procedure byte, Le = 0 stands for 256
+void transmitCase2(rt::bench::State& state, size_t le) {
+    vector<uint8_t> apdu{ 0x00, kIns, 0x00, 0x00, static_cast<uint8_t>(le) };
+
+    vector<uint8_t> cardOutput{ kIns };
+    cardOutput.resize(cardOutput.size() + le, 0xa5);
+    cardOutput.insert(cardOutput.end(), { 0x90, 0x00 });
+
+    transmit(state, apdu, cardOutput);
+}
+
+} // namespace
+
+RT_BENCHMARK(T0Case1) {
+    transmit(state, { 0x00, kIns, 0x00, 0x00 }, { 0x90, 0x00 });
+}
+
+RT_BENCHMARK(T0Case3Lc16) {
+    transmitCase3(state, 16);
+}
+
+RT_BENCHMARK(T0Case3Lc128) {
+    transmitCase3(state, 128);
+}
+
+RT_BENCHMARK(T0Case3Lc255) {
+    transmitCase3(state, 255);
+}
+
+RT_BENCHMARK(T0Case2Le16) {
+    transmitCase2(state, 16);
+}
+
+RT_BENCHMARK(T0Case2Le256) {
+    transmitCase2(state, 256);
+}
@@ -0,0 +1,177 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <rtuartscreader/iso7816_3/apdu_t0.h>
+#include <rtuartscreader/iso7816_3/atr_info.h>
+#include <rtuartscreader/transport/atr_cache.h>
+#include <rtuartscreader/transport/initialize.h>
+#include <rtuartscreader/transport/initialize_wave.h>
+#include <rtuartscreader/transport/reset.h>
+#include <rtuartscreader/transport/sendrecv_wave.h>
+
+#include <fakehardware/fakehardware.h>
+#include <faketransport/faketransport.h>
+
+#include "constants.h"
+#include "harness.h"
+#include "uartcard.h"
+
+using namespace std;
+
+namespace rtft = rt::faketransport;
+
+namespace {
+
+enum class Engine {
+    Tty,
+    Wave
+};
+
+// The real transport talks to the card emulator through a pseudo terminal,
+// the hardware is still fake and resets the emulator. The wave engine reaches
+// the terminal through the fake I/O line, so its own waveforms are not timed.
+class UartSession {
+public:
+    UartSession(rt::bench::State& state, uint32_t processingUs = 0, Engine engine = Engine::Tty,
+                vector<uint8_t> atr = kAtr2100T0)
+        : mState(state)
+        , mCard(move(atr), processingUs) {
+        rtft::deinitializeTransport();
+        rt::fakehardware::setResetHandler([this] { mCard.reset(); });
+
+        string deviceName = mCard.path();
+        if (engine == Engine::Wave) {
+            mLine = open(deviceName.c_str(), O_RDWR | O_NOCTTY);
+            rt::fakehardware::setSerialLine(mLine);
+            transport_initialize_impl_set(transport_initialize_wave_impl());
+            transport_sendrecv_impl_set(transport_sendrecv_wave_impl());
+            deviceName += ":io=27";
+        }
+
+        mTransport.atr_cache = &mAtrCache;
+        mTransport.atr_info = &mAtrInfo;
+        mIsOpen = transport_initialize(&mTransport, deviceName.c_str()) == transport_status_ok;
+        if (!mIsOpen) {
+            mState.fail("transport_initialize failed");
+        }
+    }
+
+    ~UartSession() {
+        if (mIsOpen) {
+            transport_deinitialize(&mTransport);
+        }
+
+        if (mLine != -1) {
+            rt::fakehardware::setSerialLine(-1);
+            close(mLine);
+        }
+
+        rt::fakehardware::setResetHandler(nullptr);
+        rtft::initializeTransport();
+    }
+
+    bool reset() {
+        if (!mIsOpen) return false;
+
+        size_t atrLength = sizeof(mAtr);
+        if (transport_reset(&mTransport, mAtr, &atrLength) != transport_status_ok) {
+            mState.fail("transport_reset failed");
+            return false;
+        }
+
+        return true;
+    }
+
+    void transmit(const vector<uint8_t>& apdu) {
+        mResponse.resize(258);
+        mState.run([&] {
+            size_t responseLength = mResponse.size();
+            auto r = t0_transmit_apdu(&mTransport, apdu.data(), apdu.size(), mResponse.data(), &responseLength);
+            if (r != iso7816_3_status_ok || responseLength < 2 || mResponse[responseLength - 2] != 0x90) {
+                mState.fail("t0_transmit_apdu failed");
+            }
+        });
+    }
+
+private:
+    rt::bench::State& mState;
+    rt::bench::UartCard mCard;
+    int mLine = -1;
+    atr_cache_t mAtrCache = {};
+    atr_info_t mAtrInfo;
+    transport_t mTransport = {};
+    bool mIsOpen = false;
+    uint8_t mAtr[ATR_MAX_SIZE];
+    vector<uint8_t> mResponse;
+};
+
+// kAtr2100T0 with TC1 instead of TD1: 2 ETU of extra guard time
+const vector<uint8_t> kAtrExtraGuardTime{ 0x3b, 0x5c, 0x96, 0x02, 0x52, 0x75, 0x74, 0x6f,
+                                          0x6b, 0x65, 0x6e, 0x45, 0x43, 0x50, 0x73, 0x63 };
+
+vector<uint8_t> case3Apdu(uint8_t lc) {
+    vector<uint8_t> apdu{ 0x00, 0xd6, 0x00, 0x00, lc };
+    apdu.resize(apdu.size() + lc, 0x5a);
+    return apdu;
+}
+
+} // namespace
+
+// ATR and PPS at 9600 baud, the ATR cache is warm after the first reset
+RT_BENCHMARK(UartReset) {
+    UartSession session(state);
+    state.run([&] { session.reset(); });
+}
+
+RT_BENCHMARK(UartT0Case3Lc16) {
+    UartSession session(state);
+    if (session.reset()) session.transmit(case3Apdu(16));
+}
+
+RT_BENCHMARK(UartT0Case3Lc255) {
+    UartSession session(state);
+    if (session.reset()) session.transmit(case3Apdu(255));
+}
+
+RT_BENCHMARK(UartT0Case2Le256) {
+    UartSession session(state);
+    if (session.reset()) session.transmit({ 0x00, 0xb0, 0x00, 0x00, 0x00 });
+}
+
+// The card takes 20 ms to process the command and sends NULL procedure bytes meanwhile
+RT_BENCHMARK(UartT0Case3Lc16Processing20ms) {
+    UartSession session(state, 20000);
+    if (session.reset()) session.transmit(case3Apdu(16));
+}
+
+// The command is sent character by character, each one after the echo of the previous
+// one and the extra guard time
+RT_BENCHMARK(UartT0Case3Lc255ExtraGuardTime) {
+    UartSession session(state, 0, Engine::Tty, kAtrExtraGuardTime);
+    if (session.reset()) session.transmit(case3Apdu(255));
+}
+
+// The wave engine polls the received characters instead of waiting in read()
+RT_BENCHMARK(UartWaveReset) {
+    UartSession session(state, 0, Engine::Wave);
+    state.run([&] { session.reset(); });
+}
+
+RT_BENCHMARK(UartWaveT0Case3Lc255) {
+    UartSession session(state, 0, Engine::Wave);
+    if (session.reset()) session.transmit(case3Apdu(255));
+}
+
+RT_BENCHMARK(UartWaveT0Case2Le256) {
+    UartSession session(state, 0, Engine::Wave);
+    if (session.reset()) session.transmit({ 0x00, 0xb0, 0x00, 0x00, 0x00 });
+}
@@ -0,0 +1,292 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#include "uartcard.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <pty.h>
+#include <unistd.h>
+
+extern "C" {
+#include <rtuartscreader/iso7816_3/utils.h>
+#include <rtuartscreader/transport/detail/serial_speed.h>
+}
+
+using namespace std;
+using namespace std::chrono;
+
+namespace {
+
+// Start bit, 8 data bits, parity bit and 2 ETU of guard time
+const uint32_t kEtuPerCharacter = 12;
+const uint32_t kWtEtuPerWi = 960;
+// N of TC1 which makes the guard time minimal
+const uint8_t kMinimalGuardTime = 255;
+
+const auto kNullInterval = milliseconds(5);
+
+const uint8_t kNull = 0x60;
+const uint8_t kPpss = 0xff;
+const uint8_t kPps1Present = 0x10;
+const uint8_t kInsReadBinary = 0xb0;
+const uint8_t kInsUpdateBinary = 0xd6;
+
+const uint8_t kSwOk[] = { 0x90, 0x00 };
+const uint8_t kSwInsNotSupported[] = { 0x6d, 0x00 };
+
+const size_t kHeaderSize = 5;
+
+const char kWakeReset = 'r';
+const char kWakeQuit = 'q';
+
+// Walks the interface bytes for those which the card applies itself
+void parseAtr(const vector<uint8_t>& atr, uint32_t& extraGuardEtu, uint32_t& wi) {
+    size_t i = 1;
+    for (size_t level = 1; i < atr.size(); ++level) {
+        uint8_t y = atr[i++] >> 4;
+
+        i += (y & 1) + ((y >> 1) & 1); // TA, TB
+        if ((y & 4) && i < atr.size()) {
+            if (level == 1 && atr[i] != kMinimalGuardTime) {
+                extraGuardEtu = atr[i];
+            } else if (level == 2) {
+                wi = atr[i];
+            }
+            ++i;
+        }
+        if (!(y & 8)) {
+            return;
+        }
+    }
+}
+
+} // namespace
+
+namespace rt {
+namespace bench {
+
+UartCard::UartCard(vector<uint8_t> atr, uint32_t processingUs)
+    : mAtr(move(atr))
+    , mProcessing(processingUs) {
+    char path[64];
+    if (openpty(&mMaster, &mSlave, path, nullptr, nullptr) == -1) {
+        throw runtime_error("openpty failed");
+    }
+    mPath = path;
+    parseAtr(mAtr, mExtraGuardEtu, mWi);
+    // The longest command is PPS with all its optional bytes
+    mCommand.reserve(6);
+
+    if (pipe(mWake) == -1) {
+        close(mMaster);
+        close(mSlave);
+        throw runtime_error("pipe failed");
+    }
+
+    mThread = thread(&UartCard::run, this);
+}
+
+UartCard::~UartCard() {
+    char command = kWakeQuit;
+    if (write(mWake[1], &command, 1) == 1) {
+        mThread.join();
+    } else {
+        mThread.detach();
+    }
+
+    close(mWake[0]);
+    close(mWake[1]);
+    close(mSlave);
+    close(mMaster);
+}
+
+void UartCard::reset() {
+    char command = kWakeReset;
+    if (write(mWake[1], &command, 1) != 1) {
+        throw runtime_error("Can not reset the card");
+    }
+}
+
+// The driver times out if the card stops on an error
+void UartCard::run() {
+    try {
+        serve();
+    } catch (const exception&) {
+    }
+}
+
+void UartCard::serve() {
+    pollfd fds[] = { { mWake[0], POLLIN, 0 }, { mMaster, POLLIN, 0 } };
+
+    while (poll(fds, 2, -1) != -1) {
+        if (fds[0].revents & POLLIN) {
+            char command;
+            if (read(mWake[0], &command, 1) != 1 || command == kWakeQuit) {
+                return;
+            }
+
+            mState = State::Ready;
+            mD = 1;
+            mLineFreeAt = mGuardEndsAt = mLastCharacterAt = steady_clock::now();
+            transmit(mAtr.data(), mAtr.size());
+        }
+
+        if (fds[1].revents & POLLIN) {
+            uint8_t buffer[256];
+            ssize_t length = read(mMaster, buffer, sizeof(buffer));
+            if (length <= 0) {
+                return;
+            }
+
+            // The interface has sent the characters back to back since now
+            mLineFreeAt = max(mLineFreeAt, steady_clock::now());
+
+            for (ssize_t i = 0; i < length; ++i) {
+                echo(buffer[i]);
+                receive(buffer[i]);
+            }
+        }
+    }
+}
+
+void UartCard::receive(uint8_t byte) {
+    switch (mState) {
+    case State::Idle:
+        return;
+    case State::Ready:
+        mCommand.assign(1, byte);
+        if (byte == kPpss) {
+            mState = State::Pps;
+            mExpected = 2; // PPS0 and PCK
+        } else {
+            mState = State::Header;
+            mExpected = kHeaderSize - 1;
+        }
+        return;
+    case State::Pps:
+        mCommand.push_back(byte);
+        if (mCommand.size() == 2) {
+            // PPS1, PPS2 and PPS3 presence
+            mExpected += ((byte >> 4) & 1) + ((byte >> 5) & 1) + ((byte >> 6) & 1);
+        }
+        if (mCommand.size() == mExpected + 1) {
+            mState = State::Ready;
+            transmit(mCommand.data(), mCommand.size());
+
+            uint32_t d = (mCommand[1] & kPps1Present) ? d_by_index(mCommand[2] & 0x0f) : 0;
+            if (d) {
+                mD = d;
+            }
+        }
+        return;
+    case State::Header:
+        mCommand.push_back(byte);
+        if (mCommand.size() == kHeaderSize) {
+            processCommand();
+        }
+        return;
+    case State::DataIn:
+        if (--mExpected == 0) {
+            mState = State::Ready;
+            transmit(kSwOk, sizeof(kSwOk));
+        }
+        return;
+    }
+}
+
+void UartCard::processCommand() {
+    auto nullInterval = min<nanoseconds>(kNullInterval, waitingTime() / 2);
+    for (auto elapsed = nanoseconds::zero(); elapsed < mProcessing; elapsed += nullInterval) {
+        this_thread::sleep_for(min<nanoseconds>(nullInterval, mProcessing - elapsed));
+        mLineFreeAt = max(mLineFreeAt, steady_clock::now());
+        transmit(kNull);
+    }
+
+    uint8_t ins = mCommand[1];
+    size_t p3 = mCommand[4];
+
+    if (ins == kInsUpdateBinary && p3) {
+        mState = State::DataIn;
+        mExpected = p3;
+        transmit(ins);
+        return;
+    }
+
+    mState = State::Ready;
+
+    if (ins == kInsReadBinary) {
+        transmit(ins);
+        for (size_t i = 0; i < (p3 ? p3 : 256); ++i) {
+            transmit(0xa5);
+        }
+        transmit(kSwOk, sizeof(kSwOk));
+    } else if (ins == kInsUpdateBinary) {
+        transmit(kSwOk, sizeof(kSwOk));
+    } else {
+        transmit(kSwInsNotSupported, sizeof(kSwInsNotSupported));
+    }
+}
+
+// The termios requests to the master side of a pseudo terminal are served by its slave side
+nanoseconds UartCard::etuTime() const {
+    uint32_t baudrate;
+    if (get_serial_speed(mMaster, &baudrate) != transport_status_ok || !baudrate) {
+        throw runtime_error("Can not get the speed of the terminal");
+    }
+
+    return nanoseconds(duration_cast<nanoseconds>(seconds(1)).count() / baudrate);
+}
+
+nanoseconds UartCard::waitingTime() const {
+    return etuTime() * (kWtEtuPerWi * mWi * mD);
+}
+
+// Characters follow each other on the line, each one is available to the receiver
+// once it is over. The schedule does not drift if a sleep oversleeps: the late
+// characters are written at once.
+void UartCard::writeCharacter(uint8_t byte) {
+    mLastCharacterAt = mLineFreeAt;
+    mLineFreeAt += etuTime() * kEtuPerCharacter;
+    if (mLineFreeAt > steady_clock::now()) {
+        this_thread::sleep_until(mLineFreeAt);
+    }
+
+    if (write(mMaster, &byte, 1) != 1) {
+        throw runtime_error("Can not write to the terminal");
+    }
+}
+
+// WT is counted from the start of the previous character sent by either side
+void UartCard::transmit(uint8_t byte) {
+    if (mLineFreeAt - mLastCharacterAt > waitingTime()) {
+        throw runtime_error("Waiting time is exceeded");
+    }
+
+    writeCharacter(byte);
+}
+
+// The receiver of the interface sees what is sent to the I/O line. The character
+// starts once the line is free, which is no earlier than the interface has sent it.
+void UartCard::echo(uint8_t byte) {
+    if (mLineFreeAt < mGuardEndsAt) {
+        throw runtime_error("Guard time is violated");
+    }
+    mGuardEndsAt = mLineFreeAt + etuTime() * (kEtuPerCharacter + mExtraGuardEtu);
+
+    writeCharacter(byte);
+}
+
+void UartCard::transmit(const uint8_t* bytes, size_t length) {
+    for (size_t i = 0; i < length; ++i) {
+        transmit(bytes[i]);
+    }
+}
+
+} // namespace bench
+} // namespace rt
@@ -0,0 +1,81 @@
+// Copyright (C) 2020, Aktiv-Soft JSC. All rights reserved.
+// This file is part of rtuart project licensed under the terms of the 2-clause
+// BSD license. See the LICENSE file found in the top-level directory of this
+// distribution.
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace rt {
+namespace bench {
+
+// T=0 card behind a pseudo terminal, so that the real transport talks to it as to
+// UART. Every character takes 12 ETU at the baud rate the driver has set up,
+// the card echoes the characters it receives, as the I/O line does, answers reset
+// with its ATR, accepts any PPS and serves two commands:
+// INS B0 sends P3 bytes (256 if P3 is 0), INS D6 receives P3 bytes.
+// The characters of the interface must be apart by the extra guard time of TC1,
+// those of the card by no more than WT of TC2 and the negotiated D. The card stops
+// if either is violated, so the driver times out.
+class UartCard {
+public:
+    // NULL procedure bytes are sent while the card processes a command for processingUs
+    UartCard(std::vector<uint8_t> atr, uint32_t processingUs = 0);
+    ~UartCard();
+
+    UartCard(const UartCard&) = delete;
+    UartCard& operator=(const UartCard&) = delete;
+
+    // Path of the terminal to be used as DEVICENAME
+    const std::string& path() const { return mPath; }
+
+    // RST goes high
+    void reset();
+
+private:
+    enum class State {
+        Idle,
+        Ready,
+        Pps,
+        Header,
+        DataIn
+    };
+
+    void run();
+    void serve();
+    void receive(uint8_t byte);
+    void processCommand();
+    void writeCharacter(uint8_t byte);
+    void transmit(uint8_t byte);
+    void transmit(const uint8_t* bytes, size_t length);
+    void echo(uint8_t byte);
+    std::chrono::nanoseconds etuTime() const;
+    std::chrono::nanoseconds waitingTime() const;
+
+    std::vector<uint8_t> mAtr;
+    std::chrono::microseconds mProcessing;
+    uint32_t mExtraGuardEtu = 0; // N of TC1
+    uint32_t mWi = 10;           // of TC2
+    uint32_t mD = 1;
+
+    int mMaster = -1;
+    int mSlave = -1;
+    int mWake[2] = { -1, -1 };
+    std::string mPath;
+    std::thread mThread;
+
+    State mState = State::Idle;
+    std::vector<uint8_t> mCommand;
+    size_t mExpected = 0;
+    std::chrono::steady_clock::time_point mLineFreeAt;
+    std::chrono::steady_clock::time_point mGuardEndsAt;      // the next character of the interface may start
+    std::chrono::steady_clock::time_point mLastCharacterAt; // start of the last character on the line
+};
+
+} // namespace bench
+} // namespace rt